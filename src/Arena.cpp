@@ -0,0 +1,113 @@
+/**
+ * @file
+ * @brief Source file for Arena class
+ */
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include "Arena.h"
+
+/** Minimal size of the block that is allocated when the current one is full. **/
+static constexpr size_t MIN_BLOCK_SIZE = 64 * 1024;
+
+/**
+ * Creates the arena with one block of the given size.
+ * @param[in] capacity size of the first block in bytes
+ */
+Arena::Arena(size_t capacity) {
+    if (capacity > 0) addBlock(capacity);
+}
+
+/**
+ * Allocates a new block and makes it current.
+ * @param[in] size size of the block in bytes
+ */
+void Arena::addBlock(size_t size) {
+    // Memory is not value-initialized: arrays are always written before they are read
+    blocks.push_back({ std::unique_ptr<char[]>(new char[size]), size });
+    blockIndex = blocks.size() - 1;
+    blockOffset = 0;
+    ++blocksAllocated;
+}
+
+/**
+ * Allocates the given number of bytes with the given alignment.
+ * @param[in] size      number of bytes to allocate
+ * @param[in] alignment alignment of the allocated bytes (power of 2)
+ * @return pointer to the allocated bytes.
+ */
+void* Arena::allocateBytes(size_t size, size_t alignment) {
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    // Only the last block is current: blocks are merged on reset and new blocks are added to the end
+    if (!blocks.empty()) {
+        Block& block = blocks[blockIndex];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+        size_t offset = ((base + blockOffset + alignment - 1) & ~(alignment - 1)) - base;
+        if (offset <= block.size && size <= block.size - offset) {
+            usedSize += offset + size - blockOffset;
+            blockOffset = offset + size;
+            return block.data.get() + offset;
+        }
+    }
+
+    size_t lastSize = blocks.empty() ? 0 : blocks.back().size;
+    addBlock(std::max({ size + alignment, 2 * lastSize, MIN_BLOCK_SIZE }));
+    return allocateBytes(size, alignment);
+}
+
+/**
+ * Makes sure that the given number of bytes can be allocated without allocating more blocks
+ * (e.g. from the estimated number of lines, before the text is processed).
+ * @param[in] size number of bytes that are going to be allocated
+ */
+void Arena::reserve(size_t size) {
+    if (!blocks.empty() && blocks[blockIndex].size - blockOffset >= size) return;
+
+    // Blocks that are too small are dropped while nothing is allocated from them
+    if (usedSize == 0) blocks.clear();
+    addBlock(size);
+}
+
+/**
+ * Releases all allocations at once. Memory is kept for reuse: if more than one block was used,
+ * they are merged into one block of their total size.
+ */
+void Arena::reset() {
+    if (blocks.size() > 1) {
+        size_t capacity = getCapacity();
+        blocks.clear();
+        addBlock(capacity);
+    }
+    blockIndex = 0;
+    blockOffset = 0;
+    usedSize = 0;
+}
+
+/**
+ * Total size of the blocks.
+ * @return capacity in bytes.
+ */
+size_t Arena::getCapacity() const {
+    size_t capacity = 0;
+    for (const Block& block : blocks) {
+        capacity += block.size;
+    }
+    return capacity;
+}
+
+/**
+ * Number of bytes allocated since the last reset(), including alignment padding.
+ * @return used size in bytes.
+ */
+size_t Arena::getUsedSize() const {
+    return usedSize;
+}
+
+/**
+ * Number of blocks that were allocated from the system during the lifetime of the arena.
+ * @return number of block allocations.
+ */
+size_t Arena::getBlocksAllocated() const {
+    return blocksAllocated;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file
+ * @brief Header file for Arena class
+ */
+#ifndef POEM_SORTER_ARENA_H
+#define POEM_SORTER_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Bump allocator for per-text scratch buffers (hash tables, keys, temporary indices).
+ * Allocations only move a pointer inside the current block, nothing is freed one by one: all memory is released
+ * at once by reset(), which keeps the blocks for reuse. If a run didn't fit in one block, reset() merges the blocks
+ * into one, so the next run of the same size needs no allocations at all. A single arena can be reused
+ * for many texts (e.g. by a worker in batch mode or by the server).
+ *
+ * @note Only trivially destructible objects can be allocated, their destructors are never called.
+ */
+class Arena {
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t blockIndex = 0;
+    size_t blockOffset = 0;
+    size_t usedSize = 0;
+    size_t blocksAllocated = 0;
+
+    /**
+     * Allocates a new block and makes it current.
+     * @param[in] size size of the block in bytes
+     */
+    void addBlock(size_t size);
+
+    /**
+     * Allocates the given number of bytes with the given alignment.
+     * @param[in] size      number of bytes to allocate
+     * @param[in] alignment alignment of the allocated bytes (power of 2)
+     * @return pointer to the allocated bytes.
+     */
+    void* allocateBytes(size_t size, size_t alignment);
+
+public:
+    Arena() = default;
+
+    /**
+     * Creates the arena with one block of the given size.
+     * @param[in] capacity size of the first block in bytes
+     */
+    explicit Arena(size_t capacity);
+
+    Arena(Arena& arena) = delete;
+    Arena &operator=(const Arena&) = delete;
+
+    /**
+     * Allocates an uninitialized array of the given number of objects.
+     * @param[in] count number of objects
+     * @return pointer to the first object of the array, valid until the next reset().
+     */
+    template <typename T>
+    T* allocate(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "Destructors of arena objects are never called");
+        return static_cast<T*>(allocateBytes(count * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * Makes sure that the given number of bytes can be allocated without allocating more blocks
+     * (e.g. from the estimated number of lines, before the text is processed).
+     * @param[in] size number of bytes that are going to be allocated
+     */
+    void reserve(size_t size);
+
+    /**
+     * Releases all allocations at once. Memory is kept for reuse: if more than one block was used,
+     * they are merged into one block of their total size.
+     */
+    void reset();
+
+    /**
+     * Total size of the blocks.
+     * @return capacity in bytes.
+     */
+    size_t getCapacity() const;
+
+    /**
+     * Number of bytes allocated since the last reset(), including alignment padding.
+     * @return used size in bytes.
+     */
+    size_t getUsedSize() const;
+
+    /**
+     * Number of blocks that were allocated from the system during the lifetime of the arena.
+     * @return number of block allocations.
+     */
+    size_t getBlocksAllocated() const;
+};
+
+#endif //POEM_SORTER_ARENA_H
@@ -0,0 +1,242 @@
+/**
+ * @file
+ * @brief Source file for FileWatcher class
+ */
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <filesystem>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "FileWatcher.h"
+#include "line_output.h"
+#include "RhymeIndex.h"
+#include "sorted_index.h"
+
+namespace fs = std::filesystem;
+
+/** Events of the watched directories. **/
+static constexpr uint32_t WATCH_EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+/**
+ * Creates inotify instance.
+ */
+FileWatcher::FileWatcher() {
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+/**
+ * Closes inotify instance and removes all watches.
+ */
+FileWatcher::~FileWatcher() {
+    if (inotifyFd >= 0) close(inotifyFd);
+}
+
+/**
+ * Adds the watch on the directory.
+ * @param[in] path path to the directory
+ * @return watch descriptor or -1 on failure.
+ */
+int FileWatcher::addWatch(const std::string& path) {
+    if (inotifyFd < 0) return -1;
+
+    int wd = inotify_add_watch(inotifyFd, path.c_str(), WATCH_EVENTS);
+    if (wd >= 0) directories[wd].path = path;
+    return wd;
+}
+
+/**
+ * Starts watching the file.
+ * @param[in] path path to the file
+ * @return true, if the file is watched, false otherwise.
+ */
+bool FileWatcher::watchFile(const char* path) {
+    assert(path != nullptr);
+
+    fs::path filePath(path);
+    fs::path directoryPath = filePath.parent_path();
+    if (directoryPath.empty()) directoryPath = ".";
+
+    int wd = addWatch(directoryPath.string());
+    if (wd < 0) return false;
+    directories[wd].fileNames.insert(filePath.filename().string());
+    return true;
+}
+
+/**
+ * Starts watching all files in the directory and its subdirectories (including ones that are created later).
+ * @param[in] path path to the directory
+ * @return true, if the directory is watched, false otherwise.
+ */
+bool FileWatcher::watchDirectory(const char* path) {
+    assert(path != nullptr);
+
+    int wd = addWatch(path);
+    if (wd < 0) return false;
+    directories[wd].recursive = true;
+
+    std::error_code error;
+    fs::recursive_directory_iterator it(path, fs::directory_options::skip_permission_denied, error);
+    for (; !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+        if (!it->is_directory(error)) continue;
+        int subdirectoryWd = addWatch(it->path().string());
+        if (subdirectoryWd < 0) return false;
+        directories[subdirectoryWd].recursive = true;
+    }
+    return !error;
+}
+
+/**
+ * Reads all pending events and appends paths of changed files. New subdirectories of recursively watched
+ * directories are watched too, and files that are already in them are reported as changed.
+ * @param[in, out] changedPaths paths of the changed files
+ * @return true, if the events were read, false on failure.
+ */
+bool FileWatcher::readEvents(std::vector<std::string>& changedPaths) {
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t readSize = read(inotifyFd, buffer, sizeof(buffer));
+        if (readSize < 0) return errno == EAGAIN;
+        if (readSize == 0) return true;
+
+        char* ptr = buffer;
+        while (ptr < buffer + readSize) {
+            const inotify_event* event = reinterpret_cast<inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+            if (event->mask & IN_IGNORED) {
+                directories.erase(event->wd);
+                continue;
+            }
+
+            auto it = directories.find(event->wd);
+            if (it == directories.end() || event->len == 0) continue;
+            // Copies are needed, because adding a watch can rehash the map
+            std::string directoryPath = it->second.path;
+            bool recursive = it->second.recursive;
+            std::string name = event->name;
+
+            std::string path = (fs::path(directoryPath) / name).string();
+            if (event->mask & IN_ISDIR) {
+                if (recursive && watchDirectory(path.c_str())) {
+                    // Listing stops on error (e.g. the directory is already removed), its later events are read anyway
+                    std::error_code error;
+                    auto options = fs::directory_options::skip_permission_denied;
+                    for (fs::recursive_directory_iterator entry(path, options, error);
+                         !error && entry != fs::recursive_directory_iterator(); entry.increment(error)) {
+                        if (entry->is_regular_file(error)) changedPaths.push_back(entry->path().string());
+                    }
+                }
+                continue;
+            }
+
+            // Created files are reported when they are closed after writing
+            if (event->mask & IN_CREATE) continue;
+            if (recursive || it->second.fileNames.count(name) != 0) {
+                changedPaths.push_back(path);
+            }
+        }
+    }
+}
+
+/**
+ * Waits for changes of the watched files. After the first change, waits until no changes come
+ * for the debounce interval, so a file that is saved in several writes is reported once.
+ * Each changed file is reported once, in order of the first change.
+ * @param[out] changedPaths paths of the changed files (empty on timeout)
+ * @param[in]  debounceMs   debounce interval in milliseconds
+ * @param[in]  timeoutMs    maximum time to wait for the first change in milliseconds, -1 to wait infinitely
+ * @return true, if waiting finished normally or by timeout, false on failure or if waiting was interrupted by a signal.
+ */
+bool FileWatcher::waitForChanges(std::vector<std::string>& changedPaths, int debounceMs, int timeoutMs) {
+    changedPaths.clear();
+    if (inotifyFd < 0) return false;
+
+    pollfd pollFd = { inotifyFd, POLLIN, 0 };
+    int timeout = timeoutMs;
+    while (true) {
+        int ready = poll(&pollFd, 1, timeout);
+        if (ready < 0) return false;
+        // Timeout: either nothing changed or debounce interval passed without changes
+        if (ready == 0) break;
+
+        size_t previousSize = changedPaths.size();
+        if (!readEvents(changedPaths)) return false;
+        // Events of not watched files (e.g. other files in the directory of the watched file) don't start debouncing
+        if (changedPaths.size() != previousSize) timeout = debounceMs;
+    }
+
+    std::vector<std::string> uniquePaths;
+    std::unordered_set<std::string> seenPaths;
+    for (std::string& path : changedPaths) {
+        if (seenPaths.insert(path).second) uniquePaths.push_back(std::move(path));
+    }
+    changedPaths.swap(uniquePaths);
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Canonical absolute path, the path may not exist.
+ * @param[in] path path to canonize
+ * @return canonical path.
+ */
+static fs::path getCanonicalPath(const char* path) {
+    std::error_code error;
+    // Relative path is returned as is if its first component doesn't exist, so it's made absolute first
+    fs::path canonicalPath = fs::weakly_canonical(fs::absolute(path, error), error);
+    // Trailing separator of a non-existing directory is kept as an empty last component
+    return canonicalPath.has_filename() ? canonicalPath : canonicalPath.parent_path();
+}
+
+/**
+ * Checks whether the path lies in the directory (or is the directory itself). Both paths must be canonical.
+ * @param[in] path      path to check
+ * @param[in] directory path to the directory
+ * @return true, if the path is in the directory, false otherwise.
+ */
+static bool isInDirectory(const fs::path& path, const fs::path& directory) {
+    auto mismatch = std::mismatch(directory.begin(), directory.end(), path.begin(), path.end());
+    return mismatch.first == directory.end();
+}
+
+/**
+ * Checks whether the file is an input of watch mode, and not a file written by the sorter itself: sort states,
+ * rhyme indices, anything in the cache directory (cached results and their temporary files) and results in
+ * the output directory. If the output directory is the watched one or contains it (e.g. the default "."),
+ * inputs lie in the output directory too, so there only result file names are excluded.
+ * @param[in] path            path to the file
+ * @param[in] watchPath       path to the watched file or directory
+ * @param[in] outputDirectory path to the output directory
+ * @param[in] cacheDirectory  path to the directory of the sort results cache or nullptr, if cache is disabled
+ * @return true, if the file should be sorted, false otherwise.
+ */
+bool isWatchInput(const char* path, const char* watchPath, const char* outputDirectory, const char* cacheDirectory) {
+    assert(path != nullptr);
+    assert(watchPath != nullptr);
+    assert(outputDirectory != nullptr);
+
+    std::string fileName = fs::path(path).filename().string();
+    // Temporary files of sort states and rhyme indices have additional suffix
+    if (fileName.find(SORT_STATE_EXTENSION) != std::string::npos) return false;
+    if (fileName.find(RHYME_INDEX_EXTENSION) != std::string::npos) return false;
+
+    fs::path canonicalPath = getCanonicalPath(path);
+    // Cached results are stored under new names, so sorting them again would never stop
+    if (cacheDirectory != nullptr && isInDirectory(canonicalPath, getCanonicalPath(cacheDirectory))) return false;
+
+    fs::path canonicalOutput = getCanonicalPath(outputDirectory);
+    if (!isInDirectory(canonicalPath, canonicalOutput)) return true;
+    if (!isInDirectory(getCanonicalPath(watchPath), canonicalOutput)) return false;
+
+    static const char* resultFileNames[] = {
+            DIRECT_SORTED_FILE_NAME, REVERSE_SORTED_FILE_NAME, COMPOSITE_SORTED_FILE_NAME,
+            ORIGINAL_FILE_NAME, RHYME_GROUPS_FILE_NAME, SORTED_INDEX_FILE_NAME
+    };
+    // Temporary files of sorted indices have additional suffix
+    for (const char* resultFileName : resultFileNames) {
+        if (fileName.starts_with(resultFileName)) return false;
+    }
+    return true;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief Header file for FileWatcher class
+ */
+#ifndef POEM_SORTER_FILEWATCHER_H
+#define POEM_SORTER_FILEWATCHER_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Watches files and directories for changes using inotify.
+ * Directories that contain watched files are watched instead of the files themselves, so files that are saved
+ * by writing a temporary file and renaming it over the original are still tracked.
+ * A file is reported as changed when it's closed after writing or when it's moved into a watched directory.
+ */
+class FileWatcher {
+private:
+    /**
+     * Watched directory.
+     */
+    struct WatchedDirectory {
+        std::string path;                          /**< path to the directory */
+        bool recursive = false;                    /**< whether all files and subdirectories are watched */
+        std::unordered_set<std::string> fileNames; /**< names of the watched files (if not recursive) */
+    };
+
+    int inotifyFd = -1;
+    std::unordered_map<int, WatchedDirectory> directories;
+
+    /**
+     * Adds the watch on the directory.
+     * @param[in] path path to the directory
+     * @return watch descriptor or -1 on failure.
+     */
+    int addWatch(const std::string& path);
+
+    /**
+     * Reads all pending events and appends paths of changed files. New subdirectories of recursively watched
+     * directories are watched too, and files that are already in them are reported as changed.
+     * @param[in, out] changedPaths paths of the changed files
+     * @return true, if the events were read, false on failure.
+     */
+    bool readEvents(std::vector<std::string>& changedPaths);
+
+public:
+    /**
+     * Creates inotify instance.
+     */
+    FileWatcher();
+
+    FileWatcher(FileWatcher& fileWatcher) = delete;
+    FileWatcher &operator=(const FileWatcher&) = delete;
+
+    /**
+     * Closes inotify instance and removes all watches.
+     */
+    ~FileWatcher();
+
+    /**
+     * Starts watching the file.
+     * @param[in] path path to the file
+     * @return true, if the file is watched, false otherwise.
+     */
+    bool watchFile(const char* path);
+
+    /**
+     * Starts watching all files in the directory and its subdirectories (including ones that are created later).
+     * @param[in] path path to the directory
+     * @return true, if the directory is watched, false otherwise.
+     */
+    bool watchDirectory(const char* path);
+
+    /**
+     * Waits for changes of the watched files. After the first change, waits until no changes come
+     * for the debounce interval, so a file that is saved in several writes is reported once.
+     * Each changed file is reported once, in order of the first change.
+     * @param[out] changedPaths paths of the changed files (empty on timeout)
+     * @param[in]  debounceMs   debounce interval in milliseconds
+     * @param[in]  timeoutMs    maximum time to wait for the first change in milliseconds, -1 to wait infinitely
+     * @return true, if waiting finished normally or by timeout, false on failure or if waiting was interrupted by a signal.
+     */
+    bool waitForChanges(std::vector<std::string>& changedPaths, int debounceMs, int timeoutMs = -1);
+};
+
+/**
+ * Checks whether the file is an input of watch mode, and not a file written by the sorter itself: sort states,
+ * rhyme indices, anything in the cache directory (cached results and their temporary files) and results in
+ * the output directory. If the output directory is the watched one or contains it (e.g. the default "."),
+ * inputs lie in the output directory too, so there only result file names are excluded.
+ * @param[in] path            path to the file
+ * @param[in] watchPath       path to the watched file or directory
+ * @param[in] outputDirectory path to the output directory
+ * @param[in] cacheDirectory  path to the directory of the sort results cache or nullptr, if cache is disabled
+ * @return true, if the file should be sorted, false otherwise.
+ */
+bool isWatchInput(const char* path, const char* watchPath, const char* outputDirectory, const char* cacheDirectory);
+
+#endif //POEM_SORTER_FILEWATCHER_H
@@ -3,42 +3,181 @@
  * @brief Source file for MappedFile class
  */
 #include <cassert>
+#include <cerrno>
+#include <cstring>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include "MappedFile.h"
 
+/** Initial size of the anonymous mapping that the stream is read into. **/
+static constexpr size_t INITIAL_STREAM_MAPPING_SIZE = 1 << 20;
+
+/**
+ * Parses the comma-separated list of mapping hints: "populate", "advise", "huge" and "readonly",
+ * e.g. "populate,readonly".
+ * @param[in]  spec  list of the hints
+ * @param[out] hints parsed hints
+ * @return true, if the list is valid, false otherwise.
+ */
+bool parseMappingHints(const char* spec, MappingHints& hints) {
+    assert(spec != nullptr);
+
+    MappingHints parsed;
+    const char* nameStart = spec;
+    while (true) {
+        const char* nameEnd = strchr(nameStart, ',');
+        size_t nameLength = nameEnd == nullptr ? strlen(nameStart) : nameEnd - nameStart;
+        auto isName = [nameStart, nameLength](const char* name) {
+            return strlen(name) == nameLength && strncmp(name, nameStart, nameLength) == 0;
+        };
+
+        if (isName("populate")) {
+            parsed.populate = true;
+        } else if (isName("advise")) {
+            parsed.adviseAccess = true;
+        } else if (isName("huge")) {
+            parsed.hugePages = true;
+        } else if (isName("readonly")) {
+            parsed.readOnly = true;
+        } else {
+            return false;
+        }
+
+        if (nameEnd == nullptr) break;
+        nameStart = nameEnd + 1;
+    }
+
+    hints = parsed;
+    return true;
+}
+
 /**
  * Maps the given file using mmap function.
  * If the mapping fails, textPtr is set to nullptr and textSize is set to 0.
  * Constructor also ensures that the given file is POSIX-like (ends with '\\n') - just adds '\\n' to the end of the text.
+ * If the file is not a regular file (e.g. a pipe) or it's STDIN_FILE_PATH, it's read until the end instead.
+ * If the file is mapped read-only (see MappingHints), the text must not be modified.
  * @param[in] filePath path to the file to map
+ * @param[in] hints    hints for the kernel about the access to the mapping
  */
-MappedFile::MappedFile(const char* filePath) {
+MappedFile::MappedFile(const char* filePath, const MappingHints& hints) : hints(hints) {
     assert(filePath != nullptr);
 
+    if (strcmp(filePath, STDIN_FILE_PATH) == 0) {
+        readStream(STDIN_FILENO);
+        return;
+    }
+
     int fd = open(filePath, O_RDONLY);
     if (fd < 0) {
         return;
     }
 
     struct stat statbuf{};
-    if ((fstat(fd, &statbuf) < 0) || (statbuf.st_size == 0)) {
+    if (fstat(fd, &statbuf) < 0) {
+        close(fd);
+        return;
+    }
+    if (!S_ISREG(statbuf.st_mode)) {
+        readStream(fd);
+        close(fd);
+        return;
+    }
+    if (statbuf.st_size == 0) {
         close(fd);
         return;
     }
 
-    textSize = statbuf.st_size + 1; // +1 - to add \n at the end of the file
-    void* dataPtr = mmap(nullptr, textSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    mapRegularFile(fd, statbuf.st_size);
     close(fd);
-    if (dataPtr == MAP_FAILED) {
-        textSize = 0;
+}
+
+/**
+ * Maps the regular file. Region of fileSize + 1 bytes (rounded up to pages) is reserved by an anonymous mapping first,
+ * and the file is mapped over its front with MAP_FIXED, so the byte after the file content always belongs
+ * to the mapping - it's either the tail of the last file page or the first byte of the anonymous page
+ * (touching a file page that lies entirely beyond EOF raises SIGBUS). '\\n' is written to that byte.
+ * In read-only mode only the last partial page of the file is mapped privately to write '\\n' to it,
+ * so the rest of the pages are shared with the page cache and never copied.
+ * @param[in] fd       descriptor of the file
+ * @param[in] fileSize size of the file in bytes (not zero)
+ */
+void MappedFile::mapRegularFile(int fd, size_t fileSize) {
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t regionSize = (fileSize + 1 + pageSize - 1) / pageSize * pageSize;
+    void* regionPtr = mmap(nullptr, regionSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (regionPtr == MAP_FAILED) return;
+
+    char* region = static_cast<char*>(regionPtr);
+    int protection = hints.readOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+    int flags = MAP_PRIVATE | MAP_FIXED | (hints.populate ? MAP_POPULATE : 0);
+    bool mapped = mmap(region, fileSize, protection, flags, fd, 0) != MAP_FAILED;
+
+    size_t lastPageOffset = fileSize / pageSize * pageSize;
+    if (mapped && hints.readOnly && lastPageOffset < fileSize) {
+        mapped = mmap(
+                region + lastPageOffset, pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, lastPageOffset
+        ) != MAP_FAILED;
+    }
+    if (!mapped) {
+        munmap(region, regionSize);
         return;
     }
 
-    textPtr = static_cast<char*>(dataPtr);
-    textPtr[textSize - 1] = '\n'; // Ensures that this file is a POSIX-like text file (ends with \n)
+    textPtr = region;
+    textSize = fileSize + 1;
+    mappingSize = regionSize;
+    // Huge pages are supported only for some file systems, failure just means that regular pages are used
+    if (hints.hugePages) madvise(textPtr, fileSize, MADV_HUGEPAGE);
+    textPtr[fileSize] = '\n'; // Ensures that this file is a POSIX-like text file (ends with \n)
+    if (hints.readOnly) mprotect(region + lastPageOffset, regionSize - lastPageOffset, PROT_READ);
+}
+
+/**
+ * Reads the whole stream into an anonymous mapping that grows twice with mremap when it's full,
+ * so the read text is never copied. Adds '\\n' to the end of the text.
+ * If reading fails or the stream is empty, textPtr is set to nullptr and textSize is set to 0.
+ * @param[in] fd descriptor of the stream to read
+ */
+void MappedFile::readStream(int fd) {
+    size_t capacity = INITIAL_STREAM_MAPPING_SIZE;
+    void* dataPtr = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (dataPtr == MAP_FAILED) return;
+
+    char* data = static_cast<char*>(dataPtr);
+    if (hints.hugePages) madvise(data, capacity, MADV_HUGEPAGE);
+    size_t size = 0;
+    while (true) {
+        // One byte is always left for the trailing '\n'
+        if (size + 1 == capacity) {
+            void* grownPtr = mremap(data, capacity, 2 * capacity, MREMAP_MAYMOVE);
+            if (grownPtr == MAP_FAILED) {
+                munmap(data, capacity);
+                return;
+            }
+            data = static_cast<char*>(grownPtr);
+            capacity *= 2;
+            if (hints.hugePages) madvise(data, capacity, MADV_HUGEPAGE);
+        }
+
+        ssize_t readSize = read(fd, data + size, capacity - 1 - size);
+        if (readSize < 0 && errno == EINTR) continue;
+        if (readSize <= 0) {
+            if (readSize < 0 || size == 0) {
+                munmap(data, capacity);
+                return;
+            }
+            break;
+        }
+        size += readSize;
+    }
+
+    textPtr = data;
+    textSize = size + 1;
+    mappingSize = capacity;
+    textPtr[textSize - 1] = '\n';
 }
 
 /**
@@ -46,10 +185,31 @@ MappedFile::MappedFile(const char* filePath) {
  */
 MappedFile::~MappedFile() {
     if (textPtr != nullptr) {
-        munmap(textPtr, textSize);
+        munmap(textPtr, mappingSize);
     }
 }
 
+/**
+ * Advises the kernel that the text is going to be read sequentially soon (MADV_SEQUENTIAL and MADV_WILLNEED),
+ * so it reads ahead aggressively. Does nothing if access advice is not enabled in the hints.
+ */
+void MappedFile::adviseSequentialAccess() const {
+    if (!hints.adviseAccess || textPtr == nullptr) return;
+
+    madvise(textPtr, mappingSize, MADV_SEQUENTIAL);
+    madvise(textPtr, mappingSize, MADV_WILLNEED);
+}
+
+/**
+ * Advises the kernel that the text is going to be accessed randomly (MADV_RANDOM), so it doesn't read ahead.
+ * Does nothing if access advice is not enabled in the hints.
+ */
+void MappedFile::adviseRandomAccess() const {
+    if (!hints.adviseAccess || textPtr == nullptr) return;
+
+    madvise(textPtr, mappingSize, MADV_RANDOM);
+}
+
 char* MappedFile::getTextPtr() const {
     return textPtr;
 }
@@ -7,17 +7,62 @@
 
 #include <cstddef>
 
+/** Path that means the standard input (see MappedFile). **/
+#define STDIN_FILE_PATH "-"
+
+/**
+ * Hints for the kernel about the way the mapped file is accessed.
+ */
+struct MappingHints {
+    bool populate = false;     /**< whether all pages are read in advance while mapping (MAP_POPULATE) */
+    bool adviseAccess = false; /**< whether sequential access is advised while splitting and random access while sorting */
+    bool hugePages = false;    /**< whether transparent huge pages are requested for the mapping (MADV_HUGEPAGE) */
+    bool readOnly = false;     /**< whether the file is mapped read-only, so its pages are shared with the page cache */
+};
+
+/**
+ * Parses the comma-separated list of mapping hints: "populate", "advise", "huge" and "readonly",
+ * e.g. "populate,readonly".
+ * @param[in]  spec  list of the hints
+ * @param[out] hints parsed hints
+ * @return true, if the list is valid, false otherwise.
+ */
+bool parseMappingHints(const char* spec, MappingHints& hints);
+
 /**
  * Represents a text file mapped by mmap function.
  * mmap is called during a constructor invocation.
  * munmap is called in destructor.
  * If the mapping fails, textPtr is set to nullptr and textSize is set to 0.
  * Otherwise, textPtr points to a text start and textSize is set to a text size in bytes.
+ * Files that can't be mapped (standard input, pipes, sockets) are read into an anonymous mapping instead.
  */
 class MappedFile {
 private:
     char* textPtr = nullptr;
     size_t textSize = 0;
+    size_t mappingSize = 0;
+    MappingHints hints;
+
+    /**
+     * Maps the regular file. Region of fileSize + 1 bytes (rounded up to pages) is reserved by an anonymous mapping first,
+     * and the file is mapped over its front with MAP_FIXED, so the byte after the file content always belongs
+     * to the mapping - it's either the tail of the last file page or the first byte of the anonymous page
+     * (touching a file page that lies entirely beyond EOF raises SIGBUS). '\\n' is written to that byte.
+     * In read-only mode only the last partial page of the file is mapped privately to write '\\n' to it,
+     * so the rest of the pages are shared with the page cache and never copied.
+     * @param[in] fd       descriptor of the file
+     * @param[in] fileSize size of the file in bytes (not zero)
+     */
+    void mapRegularFile(int fd, size_t fileSize);
+
+    /**
+     * Reads the whole stream into an anonymous mapping that grows twice with mremap when it's full,
+     * so the read text is never copied. Adds '\\n' to the end of the text.
+     * If reading fails or the stream is empty, textPtr is set to nullptr and textSize is set to 0.
+     * @param[in] fd descriptor of the stream to read
+     */
+    void readStream(int fd);
 
 public:
 
@@ -25,9 +70,12 @@ public:
      * Maps the given file using mmap function.
      * If the mapping fails, textPtr is set to nullptr and textSize is set to 0.
      * Constructor also ensures that the given file is POSIX-like (ends with '\\n') - just adds '\\n' to the end of the text.
+     * If the file is not a regular file (e.g. a pipe) or it's STDIN_FILE_PATH, it's read until the end instead.
+     * If the file is mapped read-only (see MappingHints), the text must not be modified.
      * @param[in] filePath path to the file to map
+     * @param[in] hints    hints for the kernel about the access to the mapping
      */
-    explicit MappedFile(const char* filePath);
+    explicit MappedFile(const char* filePath, const MappingHints& hints = {});
 
     MappedFile(MappedFile& mappedFile) = delete;
     MappedFile &operator=(const MappedFile&) = delete;
@@ -37,6 +85,18 @@ public:
      */
     ~MappedFile();
 
+    /**
+     * Advises the kernel that the text is going to be read sequentially soon (MADV_SEQUENTIAL and MADV_WILLNEED),
+     * so it reads ahead aggressively. Does nothing if access advice is not enabled in the hints.
+     */
+    void adviseSequentialAccess() const;
+
+    /**
+     * Advises the kernel that the text is going to be accessed randomly (MADV_RANDOM), so it doesn't read ahead.
+     * Does nothing if access advice is not enabled in the hints.
+     */
+    void adviseRandomAccess() const;
+
     char* getTextPtr() const;
 
     size_t getTextSize() const;
@@ -0,0 +1,87 @@
+/**
+ * @file
+ * @brief Source file for ResultCache class
+ */
+#include <cassert>
+#include <cinttypes>
+#include <filesystem>
+#include "hash.h"
+#include "ResultCache.h"
+#include "sorted_index.h"
+
+/**
+ * Creates the cache in the given directory. Directory is created if it doesn't exist.
+ * @param[in] cacheDirectory directory to store cache entries in
+ */
+ResultCache::ResultCache(const char* cacheDirectory) {
+    assert(cacheDirectory != nullptr);
+
+    directory = cacheDirectory;
+    optionsKey = getSortOptionsKey();
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+}
+
+/**
+ * Path of the cache entry for the text with the given hash.
+ * @param[in] contentHash hash of the text
+ * @return path to the entry file.
+ */
+std::string ResultCache::getEntryPath(uint64_t contentHash) const {
+    char fileName[32];
+    snprintf(fileName, sizeof(fileName), "%016" PRIx64 ".idx", contentHash);
+    return directory + '/' + fileName;
+}
+
+/**
+ * Hashes the text together with the sort options. Should be called before the text is split (modified).
+ * @param[in] text     pointer to the text
+ * @param[in] textSize size of the text in bytes
+ * @return hash that identifies the cache entry of the text.
+ */
+uint64_t ResultCache::hashText(const char* text, size_t textSize) const {
+    return hashBytes(text, textSize, optionsKey);
+}
+
+/**
+ * Loads sort results of the text from the cache.
+ * @param[in]  contentHash hash of the text (see hashText)
+ * @param[in]  text        pointer to the text
+ * @param[in]  textSize    size of the text in bytes
+ * @param[out] lines       lines of the text in original order
+ * @param[out] direct      indices of the lines in direct sorted order
+ * @param[out] reverse     indices of the lines in reverse sorted order
+ * @return true on cache hit, false on cache miss.
+ */
+bool ResultCache::load(
+        uint64_t contentHash,
+        const char* text,
+        size_t textSize,
+        std::vector<Line>& lines,
+        std::vector<size_t>& direct,
+        std::vector<size_t>& reverse
+) const {
+    return readSortedIndex(getEntryPath(contentHash).c_str(), contentHash, optionsKey, text, textSize, lines, direct, reverse);
+}
+
+/**
+ * Stores sort results of the text in the cache.
+ * @param[in] contentHash hash of the text (see hashText)
+ * @param[in] text        pointer to the text
+ * @param[in] textSize    size of the text in bytes
+ * @param[in] lines       lines of the text in original order
+ * @param[in] direct      indices of the lines in direct sorted order
+ * @param[in] reverse     indices of the lines in reverse sorted order
+ * @return true, if the results were stored, false otherwise.
+ */
+bool ResultCache::store(
+        uint64_t contentHash,
+        const char* text,
+        size_t textSize,
+        const std::vector<Line>& lines,
+        const std::vector<size_t>& direct,
+        const std::vector<size_t>& reverse
+) const {
+    return writeSortedIndex(getEntryPath(contentHash).c_str(), contentHash, optionsKey, text, textSize, lines, direct, reverse);
+}
@@ -0,0 +1,84 @@
+/**
+ * @file
+ * @brief Header file for ResultCache class
+ */
+#ifndef POEM_SORTER_RESULTCACHE_H
+#define POEM_SORTER_RESULTCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "text_helpers.h"
+
+/**
+ * On-disk cache of sort results. Each entry is a sorted index file (see sorted_index.h) named by the hash
+ * of the text content and the sort options, so unchanged texts are never split and sorted again.
+ */
+class ResultCache {
+private:
+    std::string directory;
+    uint64_t optionsKey;
+
+    /**
+     * Path of the cache entry for the text with the given hash.
+     * @param[in] contentHash hash of the text
+     * @return path to the entry file.
+     */
+    std::string getEntryPath(uint64_t contentHash) const;
+
+public:
+    /**
+     * Creates the cache in the given directory. Directory is created if it doesn't exist.
+     * @param[in] cacheDirectory directory to store cache entries in
+     */
+    explicit ResultCache(const char* cacheDirectory);
+
+    /**
+     * Hashes the text together with the sort options. Should be called before the text is split (modified).
+     * @param[in] text     pointer to the text
+     * @param[in] textSize size of the text in bytes
+     * @return hash that identifies the cache entry of the text.
+     */
+    uint64_t hashText(const char* text, size_t textSize) const;
+
+    /**
+     * Loads sort results of the text from the cache.
+     * @param[in]  contentHash hash of the text (see hashText)
+     * @param[in]  text        pointer to the text
+     * @param[in]  textSize    size of the text in bytes
+     * @param[out] lines       lines of the text in original order
+     * @param[out] direct      indices of the lines in direct sorted order
+     * @param[out] reverse     indices of the lines in reverse sorted order
+     * @return true on cache hit, false on cache miss.
+     */
+    bool load(
+            uint64_t contentHash,
+            const char* text,
+            size_t textSize,
+            std::vector<Line>& lines,
+            std::vector<size_t>& direct,
+            std::vector<size_t>& reverse
+    ) const;
+
+    /**
+     * Stores sort results of the text in the cache.
+     * @param[in] contentHash hash of the text (see hashText)
+     * @param[in] text        pointer to the text
+     * @param[in] textSize    size of the text in bytes
+     * @param[in] lines       lines of the text in original order
+     * @param[in] direct      indices of the lines in direct sorted order
+     * @param[in] reverse     indices of the lines in reverse sorted order
+     * @return true, if the results were stored, false otherwise.
+     */
+    bool store(
+            uint64_t contentHash,
+            const char* text,
+            size_t textSize,
+            const std::vector<Line>& lines,
+            const std::vector<size_t>& direct,
+            const std::vector<size_t>& reverse
+    ) const;
+};
+
+#endif //POEM_SORTER_RESULTCACHE_H
@@ -0,0 +1,311 @@
+/**
+ * @file
+ * @brief Source file for RhymeIndex class
+ */
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "RhymeIndex.h"
+#include "sorted_index.h"
+#include "sortlib.h"
+
+/**
+ * Converts the ending to the sequence of letter codes from its last letter to the first one.
+ * @param[in] ending ending to convert
+ * @return codes of the ending letters in reverse order.
+ */
+static std::vector<unsigned char> getReversedCodes(const char* ending) {
+    std::vector<unsigned char> codes;
+    size_t length = strlen(ending);
+    if (length == 0) return codes;
+
+    const char* ptr = ending + length - 1;
+    for (unsigned char code = seekAlphaCodeReverse(ptr, ending); code != 0; code = seekAlphaCodeReverse(ptr, ending)) {
+        codes.push_back(code);
+    }
+    return codes;
+}
+
+/**
+ * Compares reversed letters of the line with the given prefix.
+ * @param[in] line   line to compare
+ * @param[in] prefix codes of the letters in reverse order
+ * @return negative number, if the reversed line is less than the prefix; <br>
+ *         positive number, if the reversed line is greater than the prefix and doesn't start with it; <br>
+ *         zero,            if the reversed line starts with the prefix.
+ */
+static int compareWithReversedPrefix(const Line& line, const std::vector<unsigned char>& prefix) {
+    const char* ptr = line.lineEnd;
+    for (unsigned char prefixCode : prefix) {
+        unsigned char code = seekAlphaCodeReverse(ptr, line.lineStart);
+        if (code != prefixCode) return code < prefixCode ? -1 : +1;
+    }
+    return 0;
+}
+
+/**
+ * Number of common letters of two lines read from right to left.
+ * @param[in] line1 first line
+ * @param[in] line2 second line
+ * @return length of the common suffix in letters.
+ */
+static uint32_t getCommonSuffixLength(const Line& line1, const Line& line2) {
+    const char* ptr1 = line1.lineEnd;
+    const char* ptr2 = line2.lineEnd;
+    uint32_t length = 0;
+    while (true) {
+        unsigned char code1 = seekAlphaCodeReverse(ptr1, line1.lineStart);
+        unsigned char code2 = seekAlphaCodeReverse(ptr2, line2.lineStart);
+        if (code1 == 0 || code1 != code2) return length;
+        ++length;
+    }
+}
+
+/**
+ * Writes an array of numbers to the file.
+ * @param[in] file    file to write to
+ * @param[in] numbers numbers to write
+ * @return true, if the numbers were written, false otherwise.
+ */
+template <typename T>
+static bool writeArray(FILE* file, const std::vector<T>& numbers) {
+    return fwrite(numbers.data(), sizeof(T), numbers.size(), file) == numbers.size();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Unmaps the index and the text.
+ */
+RhymeIndex::~RhymeIndex() {
+    close();
+}
+
+/**
+ * Path of the rhyme index of the text.
+ * @param[in] textPath path to the text
+ * @return path to the index file.
+ */
+std::string RhymeIndex::getIndexPath(const char* textPath) {
+    assert(textPath != nullptr);
+
+    return std::string(textPath) + RHYME_INDEX_EXTENSION;
+}
+
+/**
+ * Builds the rhyme index of the text and writes it next to the text.
+ * @param[in] textPath path to the text
+ * @return true, if the index was built, false otherwise.
+ */
+bool RhymeIndex::build(const char* textPath) {
+    assert(textPath != nullptr);
+
+    struct stat textStat{};
+    if (stat(textPath, &textStat) < 0) return false;
+
+    MappedFile mappedFile(textPath);
+    if (mappedFile.getTextPtr() == nullptr) return false;
+
+    const char* text = mappedFile.getTextPtr();
+    std::vector<Line> lines = splitLines(mappedFile.getTextPtr(), mappedFile.getTextSize());
+    std::vector<size_t> order(lines.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    sortLineIndices(order.begin(), order.end(), lines, compareLinesReverse);
+
+    RhymeIndexHeader indexHeader{};
+    memcpy(indexHeader.magic, RHYME_INDEX_MAGIC, sizeof(indexHeader.magic));
+    indexHeader.version = RHYME_INDEX_VERSION;
+    indexHeader.headerSize = sizeof(RhymeIndexHeader);
+    indexHeader.textSize = textStat.st_size;
+    indexHeader.textModifiedSec = textStat.st_mtim.tv_sec;
+    indexHeader.textModifiedNsec = textStat.st_mtim.tv_nsec;
+    indexHeader.optionsKey = getSortOptionsKey();
+    indexHeader.linesNumber = lines.size();
+
+    std::vector<uint64_t> lineOffsets(lines.size());
+    std::vector<uint32_t> lineLengths(lines.size());
+    std::vector<uint32_t> lineLcps(lines.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        const Line& line = lines[order[i]];
+        lineOffsets[i] = line.lineStart - text;
+        lineLengths[i] = line.lineEnd - line.lineStart + 1;
+        lineLcps[i] = i == 0 ? 0 : getCommonSuffixLength(lines[order[i - 1]], line);
+    }
+
+    std::string indexPath = getIndexPath(textPath);
+    std::string tmpPath = indexPath + ".XXXXXX";
+    int fd = mkstemp(tmpPath.data());
+    if (fd < 0) return false;
+    FILE* file = fdopen(fd, "wb");
+    if (file == nullptr) {
+        ::close(fd);
+        unlink(tmpPath.c_str());
+        return false;
+    }
+
+    bool written = fwrite(&indexHeader, sizeof(indexHeader), 1, file) == 1
+            && writeArray(file, lineOffsets)
+            && writeArray(file, lineLengths)
+            && writeArray(file, lineLcps);
+    written = (fclose(file) == 0) && written;
+
+    if (!written || rename(tmpPath.c_str(), indexPath.c_str()) != 0) {
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Maps the text and its rhyme index. Index is rebuilt if it doesn't exist, the text has changed
+ * or it was built with another collation.
+ * @param[in] textPath path to the text
+ * @return true, if the index was opened, false otherwise.
+ */
+bool RhymeIndex::open(const char* textPath) {
+    assert(textPath != nullptr);
+
+    close();
+    if (!mapIndex(textPath)) {
+        if (!build(textPath) || !mapIndex(textPath)) return false;
+    }
+
+    mappedText = std::make_unique<MappedFile>(textPath);
+    if (mappedText->getTextPtr() == nullptr || mappedText->getTextSize() != header->textSize + 1) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Maps the index file and checks that it's valid and up-to-date, and that all its lines lie inside the text.
+ * @param[in] textPath path to the indexed text
+ * @return true, if the index was mapped, false otherwise.
+ */
+bool RhymeIndex::mapIndex(const char* textPath) {
+    struct stat textStat{};
+    if (stat(textPath, &textStat) < 0) return false;
+
+    int fd = ::open(getIndexPath(textPath).c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat indexStat{};
+    if (fstat(fd, &indexStat) < 0 || static_cast<size_t>(indexStat.st_size) < sizeof(RhymeIndexHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    indexSize = indexStat.st_size;
+    indexPtr = mmap(nullptr, indexSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (indexPtr == MAP_FAILED) {
+        indexPtr = nullptr;
+        indexSize = 0;
+        return false;
+    }
+
+    header = static_cast<const RhymeIndexHeader*>(indexPtr);
+    size_t linesNumber = header->linesNumber;
+    bool valid = memcmp(header->magic, RHYME_INDEX_MAGIC, sizeof(header->magic)) == 0
+            && header->version == RHYME_INDEX_VERSION
+            && header->headerSize == sizeof(RhymeIndexHeader)
+            && header->textSize == static_cast<uint64_t>(textStat.st_size)
+            && header->textModifiedSec == textStat.st_mtim.tv_sec
+            && header->textModifiedNsec == textStat.st_mtim.tv_nsec
+            && header->optionsKey == getSortOptionsKey()
+            && linesNumber <= header->textSize
+            && indexSize == sizeof(RhymeIndexHeader) + linesNumber * (sizeof(uint64_t) + 2 * sizeof(uint32_t));
+    if (!valid) {
+        close();
+        return false;
+    }
+
+    const char* data = static_cast<const char*>(indexPtr) + sizeof(RhymeIndexHeader);
+    offsets = reinterpret_cast<const uint64_t*>(data);
+    lengths = reinterpret_cast<const uint32_t*>(data + linesNumber * sizeof(uint64_t));
+    lcps = reinterpret_cast<const uint32_t*>(data + linesNumber * (sizeof(uint64_t) + sizeof(uint32_t)));
+
+    // Lines are checked once here, so getLine never points outside of the text even if the index is corrupted
+    size_t textSize = header->textSize;
+    for (size_t i = 0; i < linesNumber; ++i) {
+        if (lengths[i] == 0 || offsets[i] >= textSize || lengths[i] > textSize - offsets[i]) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Unmaps the index and the text.
+ */
+void RhymeIndex::close() {
+    mappedText.reset();
+    if (indexPtr != nullptr) {
+        munmap(indexPtr, indexSize);
+    }
+    indexPtr = nullptr;
+    indexSize = 0;
+    header = nullptr;
+    offsets = nullptr;
+    lengths = nullptr;
+    lcps = nullptr;
+}
+
+/**
+ * Number of indexed lines.
+ * @return number of lines.
+ */
+size_t RhymeIndex::size() const {
+    return header == nullptr ? 0 : header->linesNumber;
+}
+
+/**
+ * Line with the given index in reverse sorted order.
+ * @param[in] index index of the line (less than size())
+ * @return line of the text.
+ */
+Line RhymeIndex::getLine(size_t index) const {
+    assert(index < size());
+
+    const char* lineStart = mappedText->getTextPtr() + offsets[index];
+    return { lineStart, lineStart + lengths[index] - 1 };
+}
+
+/**
+ * Finds all lines that end with the given letters (punctuation and spaces are skipped in both the lines and
+ * the ending, letters are compared case-insensitively). Lines are found in reverse sorted order.
+ * @param[in]  ending ending of the lines to find (e.g. "ование")
+ * @param[out] result found lines
+ */
+void RhymeIndex::query(const char* ending, std::vector<Line>& result) const {
+    assert(ending != nullptr);
+
+    result.clear();
+    std::vector<unsigned char> prefix = getReversedCodes(ending);
+
+    // Lower bound: first line which reversed letters are not less than the prefix
+    size_t left = 0;
+    size_t right = size();
+    while (left < right) {
+        size_t middle = left + (right - left) / 2;
+        if (compareWithReversedPrefix(getLine(middle), prefix) < 0) {
+            left = middle + 1;
+        } else {
+            right = middle;
+        }
+    }
+
+    if (left == size() || compareWithReversedPrefix(getLine(left), prefix) != 0) return;
+
+    // Next lines match as long as they share at least prefix.size() last letters with the previous one
+    result.push_back(getLine(left));
+    for (size_t i = left + 1; i < size() && lcps[i] >= prefix.size(); ++i) {
+        result.push_back(getLine(i));
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @brief Header file for RhymeIndex class
+ *
+ * Rhyme index file is stored next to the indexed text (text path + RHYME_INDEX_EXTENSION) and contains:
+ * * RhymeIndexHeader;
+ * * uint64_t offsets[linesNumber] - offset of the first character of each line from the text start;
+ * * uint32_t lengths[linesNumber] - length of each line in bytes;
+ * * uint32_t lcps[linesNumber]    - number of common last letters of each line and the previous one (0 for the first line).
+ *
+ * Lines are stored in reverse sorted order (see compareLinesReverse), i.e. it's a sorted array of reversed line keys
+ * with their longest common prefixes.
+ */
+#ifndef POEM_SORTER_RHYMEINDEX_H
+#define POEM_SORTER_RHYMEINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "text_helpers.h"
+
+/** Magic bytes at the start of the rhyme index file. **/
+#define RHYME_INDEX_MAGIC "PSRHYIDX"
+/** Current version of the rhyme index format. **/
+#define RHYME_INDEX_VERSION 2
+/** Extension that is appended to the text path to get the path of its rhyme index. **/
+#define RHYME_INDEX_EXTENSION ".rhymeidx"
+
+/**
+ * Header of the rhyme index file.
+ */
+struct RhymeIndexHeader {
+    char magic[8];            /**< RHYME_INDEX_MAGIC without '\\0' */
+    uint32_t version;         /**< RHYME_INDEX_VERSION */
+    uint32_t headerSize;      /**< sizeof(RhymeIndexHeader) */
+    uint64_t textSize;        /**< size of the indexed file in bytes */
+    int64_t textModifiedSec;  /**< modification time of the indexed file (seconds) */
+    int64_t textModifiedNsec; /**< modification time of the indexed file (nanoseconds) */
+    uint64_t optionsKey;      /**< key of the sort options (see getSortOptionsKey), lines are ordered by its collation */
+    uint64_t linesNumber;     /**< number of lines */
+};
+
+/**
+ * Persistent index of the text lines in reverse order. Both the text and the index are memory-mapped,
+ * so opening the index of a large corpus doesn't read it, and each query takes O(log n) comparisons.
+ */
+class RhymeIndex {
+private:
+    std::unique_ptr<MappedFile> mappedText;
+    void* indexPtr = nullptr;
+    size_t indexSize = 0;
+
+    const RhymeIndexHeader* header = nullptr;
+    const uint64_t* offsets = nullptr;
+    const uint32_t* lengths = nullptr;
+    const uint32_t* lcps = nullptr;
+
+    /**
+     * Maps the index file and checks that it's valid and up-to-date, and that all its lines lie inside the text.
+     * @param[in] textPath path to the indexed text
+     * @return true, if the index was mapped, false otherwise.
+     */
+    bool mapIndex(const char* textPath);
+
+    /**
+     * Unmaps the index and the text.
+     */
+    void close();
+
+public:
+    RhymeIndex() = default;
+
+    RhymeIndex(RhymeIndex& rhymeIndex) = delete;
+    RhymeIndex &operator=(const RhymeIndex&) = delete;
+
+    /**
+     * Unmaps the index and the text.
+     */
+    ~RhymeIndex();
+
+    /**
+     * Path of the rhyme index of the text.
+     * @param[in] textPath path to the text
+     * @return path to the index file.
+     */
+    static std::string getIndexPath(const char* textPath);
+
+    /**
+     * Builds the rhyme index of the text and writes it next to the text.
+     * @param[in] textPath path to the text
+     * @return true, if the index was built, false otherwise.
+     */
+    static bool build(const char* textPath);
+
+    /**
+     * Maps the text and its rhyme index. Index is rebuilt if it doesn't exist, the text has changed
+     * or it was built with another collation.
+     * @param[in] textPath path to the text
+     * @return true, if the index was opened, false otherwise.
+     */
+    bool open(const char* textPath);
+
+    /**
+     * Number of indexed lines.
+     * @return number of lines.
+     */
+    size_t size() const;
+
+    /**
+     * Line with the given index in reverse sorted order.
+     * @param[in] index index of the line (less than size())
+     * @return line of the text.
+     */
+    Line getLine(size_t index) const;
+
+    /**
+     * Finds all lines that end with the given letters (punctuation and spaces are skipped in both the lines and
+     * the ending, letters are compared case-insensitively). Lines are found in reverse sorted order.
+     * @param[in]  ending ending of the lines to find (e.g. "ование")
+     * @param[out] result found lines
+     */
+    void query(const char* ending, std::vector<Line>& result) const;
+};
+
+#endif //POEM_SORTER_RHYMEINDEX_H
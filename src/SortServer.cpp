@@ -0,0 +1,414 @@
+/**
+ * @file
+ * @brief Source file for SortServer and SortClient classes
+ */
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "line_output.h"
+#include "SortServer.h"
+
+/**
+ * Reads exactly size bytes from the socket.
+ * @param[in]  fd   socket to read from
+ * @param[out] buf  buffer to read to
+ * @param[in]  size number of bytes to read
+ * @return true, if all bytes were read, false on error or end of stream.
+ */
+static bool readAll(int fd, void* buf, size_t size) {
+    char* ptr = static_cast<char*>(buf);
+    while (size > 0) {
+        ssize_t readBytes = read(fd, ptr, size);
+        if (readBytes < 0 && errno == EINTR) continue;
+        if (readBytes <= 0) return false;
+        ptr += readBytes;
+        size -= readBytes;
+    }
+    return true;
+}
+
+/**
+ * Writes exactly size bytes to the socket. SIGPIPE is not raised if the other side disconnected.
+ * @param[in] fd   socket to write to
+ * @param[in] buf  buffer to write from
+ * @param[in] size number of bytes to write
+ * @return true, if all bytes were written, false otherwise.
+ */
+static bool writeAll(int fd, const void* buf, size_t size) {
+    const char* ptr = static_cast<const char*>(buf);
+    while (size > 0) {
+        ssize_t writtenBytes = send(fd, ptr, size, MSG_NOSIGNAL);
+        if (writtenBytes < 0 && errno == EINTR) continue;
+        if (writtenBytes <= 0) return false;
+        ptr += writtenBytes;
+        size -= writtenBytes;
+    }
+    return true;
+}
+
+/**
+ * Sends a message (header and payload) to the socket.
+ * @param[in] fd          socket to write to
+ * @param[in] type        message type
+ * @param[in] order       sort order character ('D' or 'R')
+ * @param[in] payload     message payload
+ * @param[in] payloadSize size of the payload in bytes
+ * @return true, if the message was sent, false otherwise.
+ */
+static bool sendMessage(int fd, SortMessageType type, char order, const char* payload, size_t payloadSize) {
+    SortMessageHeader header{};
+    header.type = type;
+    header.order = order;
+    header.payloadSize = payloadSize;
+    return writeAll(fd, &header, sizeof(header)) && writeAll(fd, payload, payloadSize);
+}
+
+/**
+ * Sets the timeout of blocking reads and writes of the socket, so they fail with EAGAIN when it expires.
+ * @param[in] fd        socket
+ * @param[in] timeoutMs timeout in milliseconds, 0 means no timeout
+ * @return true, if the timeout was set, false otherwise.
+ */
+static bool setSocketTimeout(int fd, unsigned int timeoutMs) {
+    timeval timeout{};
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    return setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0
+        && setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) == 0;
+}
+
+/**
+ * Fills Unix domain socket address with the given path.
+ * @param[out] address    address to fill
+ * @param[in]  socketPath path of the socket
+ * @return true, if the path fits into the address, false otherwise.
+ */
+static bool makeSocketAddress(sockaddr_un& address, const char* socketPath) {
+    assert(socketPath != nullptr);
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) return false;
+    strcpy(address.sun_path, socketPath);
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Records latency of one request.
+ * @param[in] latencyNs latency in nanoseconds
+ */
+void LatencyRecorder::record(uint64_t latencyNs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (latencies.size() < LATENCY_WINDOW) {
+        latencies.push_back(latencyNs);
+    } else {
+        latencies[nextLatencyIndex] = latencyNs;
+    }
+    nextLatencyIndex = (nextLatencyIndex + 1) % LATENCY_WINDOW;
+    ++requestsNumber;
+}
+
+/**
+ * Percentiles of the recorded latencies in human-readable form (e.g. "requests 10\\np50_us 12.5\\n...").
+ * @return text with number of requests and p50, p90, p99 and max latencies in microseconds.
+ */
+std::string LatencyRecorder::getReport() {
+    std::vector<uint64_t> sortedLatencies;
+    uint64_t totalRequests;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sortedLatencies = latencies;
+        totalRequests = requestsNumber;
+    }
+    std::sort(sortedLatencies.begin(), sortedLatencies.end());
+
+    auto percentile = [&sortedLatencies](double p) {
+        if (sortedLatencies.empty()) return 0.0;
+        size_t index = static_cast<size_t>(p * (sortedLatencies.size() - 1));
+        return sortedLatencies[index] / 1000.0;
+    };
+
+    char report[256];
+    snprintf(
+            report, sizeof(report),
+            "requests %llu\np50_us %.1f\np90_us %.1f\np99_us %.1f\nmax_us %.1f\n",
+            static_cast<unsigned long long>(totalRequests),
+            percentile(0.5), percentile(0.9), percentile(0.99), percentile(1.0)
+    );
+    return report;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Stops the server if it's running.
+ */
+SortServer::~SortServer() {
+    stop();
+}
+
+/**
+ * Binds the socket to the given path and starts workers. Existing socket file is replaced,
+ * the socket is accessible only by its owner.
+ * @param[in] path           path of the Unix domain socket
+ * @param[in] workersNumber  number of workers (maximum number of concurrently served clients)
+ * @param[in] maxPayloadSize maximum size of the request payload, larger requests are rejected before they are read
+ * @param[in] idleTimeoutMs  time in milliseconds after which a client that doesn't send or receive is disconnected
+ * @return true, if the server was started, false otherwise.
+ */
+bool SortServer::start(const char* path, unsigned int workersNumber, uint64_t maxPayloadSize, unsigned int idleTimeoutMs) {
+    assert(path != nullptr);
+    assert(workersNumber > 0);
+    assert(listenFd < 0);
+
+    this->maxPayloadSize = maxPayloadSize;
+    this->idleTimeoutMs = idleTimeoutMs;
+    sockaddr_un address{};
+    if (!makeSocketAddress(address, path)) return false;
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) return false;
+
+    socketPath = path;
+    unlink(path);
+    // Mode is changed before listening, so no one can connect while the socket is accessible by others
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+        || chmod(path, S_IRUSR | S_IWUSR) < 0
+        || listen(listenFd, SOMAXCONN) < 0) {
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    stopped = false;
+    for (unsigned int i = 0; i < workersNumber; ++i) {
+        workers.emplace_back(&SortServer::workerLoop, this);
+    }
+    return true;
+}
+
+/**
+ * Stops accepting connections, disconnects clients and waits for workers to finish.
+ */
+void SortServer::stop() {
+    if (listenFd < 0) return;
+
+    stopped = true;
+    shutdown(listenFd, SHUT_RDWR); // Wakes up workers blocked in accept
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        for (int clientFd : clientFds) {
+            shutdown(clientFd, SHUT_RDWR);
+        }
+    }
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    unlink(socketPath.c_str());
+    close(listenFd);
+    listenFd = -1;
+}
+
+/**
+ * Latency statistics of the served requests.
+ * @return human-readable statistics.
+ */
+std::string SortServer::getStats() {
+    return latencyRecorder.getReport();
+}
+
+/**
+ * Accepts connections and serves them until the server is stopped.
+ */
+void SortServer::workerLoop() {
+    SortSession session;
+    std::vector<char> requestBuffer;
+    std::vector<char> responseBuffer;
+
+    while (!stopped) {
+        int clientFd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (clientFd < 0) {
+            if (!stopped && (errno == EINTR || errno == ECONNABORTED)) continue;
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            if (stopped) {
+                close(clientFd);
+                return;
+            }
+            clientFds.insert(clientFd);
+        }
+
+        // Idle client is disconnected after the timeout, so it doesn't hold the worker
+        if (setSocketTimeout(clientFd, idleTimeoutMs)) serveClient(clientFd, session, requestBuffer, responseBuffer);
+
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            clientFds.erase(clientFd);
+        }
+        close(clientFd);
+        session.clear();
+    }
+}
+
+/**
+ * Serves requests from one client until it disconnects or the server is stopped.
+ * @param[in]      clientFd      connected client socket
+ * @param[in, out] session       worker session
+ * @param[in, out] requestBuffer worker buffer for requests payload
+ * @param[in, out] responseBuffer worker buffer for responses payload
+ */
+void SortServer::serveClient(int clientFd, SortSession& session, std::vector<char>& requestBuffer, std::vector<char>& responseBuffer) {
+    SortMessageHeader header{};
+    while (!stopped && readAll(clientFd, &header, sizeof(header))) {
+        auto startTime = std::chrono::steady_clock::now();
+
+        // Checked before the buffer is resized, so one header can't make the worker allocate more
+        if (header.payloadSize > maxPayloadSize) {
+            const char* error = "Payload is too large";
+            sendMessage(clientFd, SORT_ERROR, header.order, error, strlen(error));
+            return;
+        }
+
+        // +1 - to add \n at the end of the text, so it can be split in-place
+        requestBuffer.resize(header.payloadSize + 1);
+        if (!readAll(clientFd, requestBuffer.data(), header.payloadSize)) return;
+
+        const char* error = nullptr;
+        SortOrder order = header.order == 'R' ? SortOrder::REVERSE : SortOrder::DIRECT;
+        if (header.type == STATS) {
+            std::string stats = getStats();
+            responseBuffer.assign(stats.begin(), stats.end());
+        } else if (header.order != 'D' && header.order != 'R') {
+            error = "Invalid sort order";
+        } else if (header.type == SORT_BUFFER) {
+            requestBuffer[header.payloadSize] = '\n';
+            session.loadBuffer(requestBuffer.data(), requestBuffer.size());
+        } else if (header.type == SORT_FILE) {
+            requestBuffer[header.payloadSize] = '\0';
+            if (!session.loadFile(requestBuffer.data())) error = "Invalid file";
+        } else {
+            error = "Invalid request type";
+        }
+
+        if (error == nullptr && header.type != STATS) {
+            responseBuffer.clear();
+            appendLines(responseBuffer, session.getSortedLines(order));
+        }
+
+        bool sent = error == nullptr
+                ? sendMessage(clientFd, SORT_OK, header.order, responseBuffer.data(), responseBuffer.size())
+                : sendMessage(clientFd, SORT_ERROR, header.order, error, strlen(error));
+        if (!sent) return;
+
+        std::chrono::duration<uint64_t, std::nano> latency = std::chrono::steady_clock::now() - startTime;
+        latencyRecorder.record(latency.count());
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Closes the connection if it's open.
+ */
+SortClient::~SortClient() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+/**
+ * Connects to the server.
+ * @param[in] socketPath path of the Unix domain socket the server listens on
+ * @return true, if connected, false otherwise.
+ */
+bool SortClient::connect(const char* socketPath) {
+    assert(socketPath != nullptr);
+    assert(fd < 0);
+
+    sockaddr_un address{};
+    if (!makeSocketAddress(address, socketPath)) return false;
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Sends a request and receives a response.
+ * @param[in]  type        request type
+ * @param[in]  order       sort order
+ * @param[in]  payload     request payload
+ * @param[in]  payloadSize size of the request payload in bytes
+ * @param[out] response    response payload
+ * @return true, if the server responded with SORT_OK, false otherwise.
+ */
+bool SortClient::request(SortMessageType type, SortOrder order, const char* payload, size_t payloadSize, std::vector<char>& response) {
+    assert(fd >= 0);
+
+    response.clear();
+    char orderChar = order == SortOrder::REVERSE ? 'R' : 'D';
+    if (!sendMessage(fd, type, orderChar, payload, payloadSize)) return false;
+
+    SortMessageHeader header{};
+    if (!readAll(fd, &header, sizeof(header))) return false;
+    response.resize(header.payloadSize);
+    if (!readAll(fd, response.data(), header.payloadSize)) return false;
+
+    return header.type == SORT_OK;
+}
+
+/**
+ * Sorts the given text on the server.
+ * @param[in]  text   text to sort
+ * @param[in]  size   size of the text in bytes
+ * @param[in]  order  sort order
+ * @param[out] result sorted lines each ending with '\\n' (or error message on failure)
+ * @return true, if the text was sorted, false otherwise.
+ */
+bool SortClient::sortBuffer(const char* text, size_t size, SortOrder order, std::vector<char>& result) {
+    assert(text != nullptr || size == 0);
+
+    return request(SORT_BUFFER, order, text, size, result);
+}
+
+/**
+ * Sorts the given file on the server. Path is resolved by the server.
+ * @param[in]  filePath path to the file to sort
+ * @param[in]  order    sort order
+ * @param[out] result   sorted lines each ending with '\\n' (or error message on failure)
+ * @return true, if the file was sorted, false otherwise.
+ */
+bool SortClient::sortFile(const char* filePath, SortOrder order, std::vector<char>& result) {
+    assert(filePath != nullptr);
+
+    return request(SORT_FILE, order, filePath, strlen(filePath), result);
+}
+
+/**
+ * Requests latency statistics of the server.
+ * @param[out] result human-readable statistics
+ * @return true, if the statistics was received, false otherwise.
+ */
+bool SortClient::getStats(std::vector<char>& result) {
+    return request(STATS, SortOrder::DIRECT, nullptr, 0, result);
+}
@@ -0,0 +1,220 @@
+/**
+ * @file
+ * @brief Header file for SortServer and SortClient classes
+ *
+ * Server and client communicate over a local Unix domain socket with a simple binary protocol.
+ * Each request is a SortMessageHeader followed by payloadSize bytes of payload:
+ * * SORT_BUFFER - payload is a text to sort;
+ * * SORT_FILE   - payload is a path to a file to sort (without '\\0');
+ * * STATS       - no payload, server returns its latency statistics as a text.
+ *
+ * Each response is a SortMessageHeader (type is SORT_OK or SORT_ERROR) followed by payloadSize bytes:
+ * sorted lines each ending with '\\n', statistics text or an error message.
+ * Many requests can be sent over one connection, a connection that stays idle longer than the idle timeout is closed,
+ * so idle clients don't hold workers.
+ *
+ * SORT_FILE opens any file the server process can read (relative paths are resolved from its working directory),
+ * so the socket is created with mode 0600: only the user that runs the server can connect to it.
+ */
+#ifndef POEM_SORTER_SORTSERVER_H
+#define POEM_SORTER_SORTSERVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "SortSession.h"
+
+/** Default maximum size of the request payload that server accepts (64 MiB). **/
+#define DEFAULT_MAX_PAYLOAD_SIZE (64ull << 20)
+
+/** Default time after which a client that doesn't send or receive is disconnected (30 seconds). **/
+#define DEFAULT_IDLE_TIMEOUT_MS 30000u
+
+/**
+ * Types of the messages in sort server protocol.
+ */
+enum SortMessageType : uint8_t {
+    SORT_BUFFER = 'B', /**< request: sort the text from payload */
+    SORT_FILE   = 'F', /**< request: sort the file, path to which is in payload */
+    STATS       = 'S', /**< request: get latency statistics */
+    SORT_OK     = 'K', /**< response: request succeeded */
+    SORT_ERROR  = 'E', /**< response: request failed, payload contains error message */
+};
+
+/**
+ * Header of each request and response in sort server protocol.
+ */
+struct SortMessageHeader {
+    uint8_t type;         /**< one of SortMessageType */
+    uint8_t order;        /**< 'D' for direct order, 'R' for reverse order (ignored in responses) */
+    uint8_t reserved[6];  /**< must be zero */
+    uint64_t payloadSize; /**< size of the payload that follows the header in bytes */
+};
+
+/**
+ * Collects request latencies and computes percentiles over the last LATENCY_WINDOW requests.
+ */
+class LatencyRecorder {
+private:
+    static constexpr size_t LATENCY_WINDOW = 1 << 16;
+
+    std::mutex mutex;
+    std::vector<uint64_t> latencies;
+    size_t nextLatencyIndex = 0;
+    uint64_t requestsNumber = 0;
+
+public:
+    /**
+     * Records latency of one request.
+     * @param[in] latencyNs latency in nanoseconds
+     */
+    void record(uint64_t latencyNs);
+
+    /**
+     * Percentiles of the recorded latencies in human-readable form (e.g. "requests 10\\np50_us 12.5\\n...").
+     * @return text with number of requests and p50, p90, p99 and max latencies in microseconds.
+     */
+    std::string getReport();
+};
+
+/**
+ * Long-running server that sorts texts sent over a Unix domain socket.
+ * Server keeps a pool of workers that accept connections. Each worker has its own SortSession and buffers
+ * that are reused between requests, so warm requests don't pay for process start and allocations.
+ */
+class SortServer {
+private:
+    int listenFd = -1;
+    std::string socketPath;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopped = false;
+    uint64_t maxPayloadSize = DEFAULT_MAX_PAYLOAD_SIZE;
+    unsigned int idleTimeoutMs = DEFAULT_IDLE_TIMEOUT_MS;
+
+    std::mutex clientsMutex;
+    std::unordered_set<int> clientFds;
+
+    LatencyRecorder latencyRecorder;
+
+    /**
+     * Accepts connections and serves them until the server is stopped.
+     */
+    void workerLoop();
+
+    /**
+     * Serves requests from one client until it disconnects or the server is stopped.
+     * @param[in]      clientFd      connected client socket
+     * @param[in, out] session       worker session
+     * @param[in, out] requestBuffer worker buffer for requests payload
+     * @param[in, out] responseBuffer worker buffer for responses payload
+     */
+    void serveClient(int clientFd, SortSession& session, std::vector<char>& requestBuffer, std::vector<char>& responseBuffer);
+
+public:
+    SortServer() = default;
+
+    SortServer(SortServer& sortServer) = delete;
+    SortServer &operator=(const SortServer&) = delete;
+
+    /**
+     * Stops the server if it's running.
+     */
+    ~SortServer();
+
+    /**
+     * Binds the socket to the given path and starts workers. Existing socket file is replaced,
+     * the socket is accessible only by its owner.
+     * @param[in] path           path of the Unix domain socket
+     * @param[in] workersNumber  number of workers (maximum number of concurrently served clients)
+     * @param[in] maxPayloadSize maximum size of the request payload, larger requests are rejected before they are read
+     * @param[in] idleTimeoutMs  time in milliseconds after which a client that doesn't send or receive is disconnected
+     * @return true, if the server was started, false otherwise.
+     */
+    bool start(
+            const char* path,
+            unsigned int workersNumber,
+            uint64_t maxPayloadSize = DEFAULT_MAX_PAYLOAD_SIZE,
+            unsigned int idleTimeoutMs = DEFAULT_IDLE_TIMEOUT_MS
+    );
+
+    /**
+     * Stops accepting connections, disconnects clients and waits for workers to finish.
+     */
+    void stop();
+
+    /**
+     * Latency statistics of the served requests.
+     * @return human-readable statistics.
+     */
+    std::string getStats();
+};
+
+/**
+ * Client for the SortServer.
+ */
+class SortClient {
+private:
+    int fd = -1;
+
+    /**
+     * Sends a request and receives a response.
+     * @param[in]  type        request type
+     * @param[in]  order       sort order
+     * @param[in]  payload     request payload
+     * @param[in]  payloadSize size of the request payload in bytes
+     * @param[out] response    response payload
+     * @return true, if the server responded with SORT_OK, false otherwise.
+     */
+    bool request(SortMessageType type, SortOrder order, const char* payload, size_t payloadSize, std::vector<char>& response);
+
+public:
+    SortClient() = default;
+
+    SortClient(SortClient& sortClient) = delete;
+    SortClient &operator=(const SortClient&) = delete;
+
+    /**
+     * Closes the connection if it's open.
+     */
+    ~SortClient();
+
+    /**
+     * Connects to the server.
+     * @param[in] socketPath path of the Unix domain socket the server listens on
+     * @return true, if connected, false otherwise.
+     */
+    bool connect(const char* socketPath);
+
+    /**
+     * Sorts the given text on the server.
+     * @param[in]  text   text to sort
+     * @param[in]  size   size of the text in bytes
+     * @param[in]  order  sort order
+     * @param[out] result sorted lines each ending with '\\n' (or error message on failure)
+     * @return true, if the text was sorted, false otherwise.
+     */
+    bool sortBuffer(const char* text, size_t size, SortOrder order, std::vector<char>& result);
+
+    /**
+     * Sorts the given file on the server. Path is resolved by the server (relative to its working directory).
+     * @param[in]  filePath path to the file to sort
+     * @param[in]  order    sort order
+     * @param[out] result   sorted lines each ending with '\\n' (or error message on failure)
+     * @return true, if the file was sorted, false otherwise.
+     */
+    bool sortFile(const char* filePath, SortOrder order, std::vector<char>& result);
+
+    /**
+     * Requests latency statistics of the server.
+     * @param[out] result human-readable statistics
+     * @return true, if the statistics was received, false otherwise.
+     */
+    bool getStats(std::vector<char>& result);
+};
+
+#endif //POEM_SORTER_SORTSERVER_H
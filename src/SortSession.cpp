@@ -0,0 +1,560 @@
+/**
+ * @file
+ * @brief Source file for SortSession class
+ */
+#include <cassert>
+#include <cstring>
+#include <string>
+#include "hash.h"
+#include "SortSession.h"
+#include "sorted_index.h"
+#include "sortlib.h"
+
+/**
+ * Splits the given text by lines and resets all sorted results.
+ * @param[in] text pointer to the text that ends with '\\n'
+ * @param[in] size size of the text in bytes
+ */
+void SortSession::split(char* text, size_t size) {
+    assert(text != nullptr);
+    assert(size > 0 && text[size - 1] == '\n');
+
+    if (mappedFile != nullptr) mappedFile->adviseSequentialAccess();
+    // Line tables are sized once from the number of '\n' symbols, so they don't grow while the text is split
+    size_t linesEstimate = countNewlines(text, size);
+    lines.reserve(linesEstimate);
+    if (isKeyFieldSet(keyField)) wordTable.lineWordStarts.reserve(linesEstimate + 1);
+    bool filtered = isLineFilterSet(lineFilter);
+    if (mappingHints.readOnly || lineNumbering) {
+        splitLinesReadOnly(
+                text, size, lines, isKeyFieldSet(keyField) ? &wordTable : nullptr, filtered ? &lineFilter : nullptr
+        );
+    } else if (isKeyFieldSet(keyField) && filtered) {
+        splitLines(text, size, lines, wordTable, lineFilter);
+    } else if (isKeyFieldSet(keyField)) {
+        splitLines(text, size, lines, wordTable);
+    } else if (filtered) {
+        splitLines(text, size, lines, lineFilter);
+    } else {
+        splitLines(text, size, lines);
+    }
+    // Sorting and writing access lines in arbitrary order
+    if (mappedFile != nullptr) mappedFile->adviseRandomAccess();
+    keyLines.clear();
+    lineTableReady = false;
+    for (size_t i = 0; i < ORDERS_NUMBER; ++i) {
+        permutationReady[i] = false;
+        sortedLinesReady[i] = false;
+    }
+}
+
+/**
+ * Builds keys of the lines from the word table, if the key field is set and the keys are not built yet.
+ */
+void SortSession::buildKeyLines() {
+    if (!isKeyFieldSet(keyField) || keyLines.size() == lines.size()) return;
+
+    buildKeyFields(lines, wordTable, keyField, keyLines);
+}
+
+/**
+ * Builds the table of the loaded lines (see LineTable), if it's not built yet.
+ * @return true, if the table is built, false if the lines don't fit in it.
+ */
+bool SortSession::prepareLineTable() {
+    if (!lineTableReady) lineTableReady = buildLineTable(loadedText, lines, lineTable);
+    return lineTableReady;
+}
+
+/**
+ * Remembers the loaded text and hashes it, if hashing is enabled. Must be called before the text is split.
+ * @param[in] text     pointer to the original text
+ * @param[in] textSize size of the original text in bytes
+ */
+void SortSession::setLoadedText(const char* text, size_t textSize) {
+    loadedText = text;
+    loadedTextSize = textSize;
+    loadedTextHash = contentHashing ? hashBytes(text, textSize) : 0;
+}
+
+/**
+ * Normalizes the text (see normalizeText), if normalization is enabled and the text isn't read-only.
+ * Must be called before the text is hashed and split.
+ * @param[in, out] text pointer to the text
+ * @param[in]      size size of the text in bytes
+ * @return size of the normalized text in bytes.
+ */
+size_t SortSession::normalize(char* text, size_t size) {
+    if (!textNormalization || mappingHints.readOnly) return size;
+
+    return normalizeText(text, size, normalizationStats);
+}
+
+/**
+ * Sets the key field of the lines (see KeyField): lines are sorted by their key fields, lines with equal keys
+ * are sorted as a whole. Word boundaries are computed while the text is split, so the key field must be set
+ * before loading. Cache and incremental loading are not supported with the key field.
+ * @param[in] field key field, not set key field means that lines are sorted as a whole
+ */
+void SortSession::setKeyField(const KeyField& field) {
+    keyField = field;
+}
+
+/**
+ * Sets the filter of the lines (see LineFilter): lines that don't pass it are dropped while the text is split,
+ * so they are never sorted. Filter must be set before loading. Cache and incremental loading are not supported
+ * with the filter.
+ * @param[in] filter filter of the lines, not set filter means that all lines with letters are kept
+ */
+void SortSession::setLineFilter(const LineFilter& filter) {
+    lineFilter = filter;
+}
+
+/**
+ * Sets the keys of the composite order (SortOrder::COMPOSITE). Keys of all lines are materialized once,
+ * when the composite order is requested for the first time. If the key field is set, keys are built from it.
+ * @param[in] keys keys of the composite order (see parseSortKeys)
+ */
+void SortSession::setSortKeys(const std::vector<SortKey>& keys) {
+    sortKeys = keys;
+    size_t composite = static_cast<size_t>(SortOrder::COMPOSITE);
+    permutationReady[composite] = false;
+    sortedLinesReady[composite] = false;
+}
+
+/**
+ * Limits sorted results to the first lines: only they are sorted (see partialSortLineIndices), the rest of
+ * the lines are never ordered. Cache and incremental loading are not supported with the limit.
+ * @param[in] count number of the first lines of each order, 0 means all lines
+ */
+void SortSession::setHeadLines(size_t count) {
+    headLines = count;
+    for (size_t i = 0; i < ORDERS_NUMBER; ++i) {
+        permutationReady[i] = false;
+        sortedLinesReady[i] = false;
+    }
+}
+
+/**
+ * Sets the hints for the kernel about the access to the mapped files (see MappingHints). Access advice is given
+ * right before splitting (sequential access) and right after it (random access while sorting). With the read-only
+ * hint the text is split without modification (see splitLinesReadOnly), also for buffers given to loadBuffer.
+ * @param[in] hints mapping hints of the next loaded files
+ */
+void SortSession::setMappingHints(const MappingHints& hints) {
+    mappingHints = hints;
+}
+
+/**
+ * Enables hashing of the loaded texts, which is needed to save their sorted indices (see saveSortedIndex).
+ * Text is hashed before it's split, so hashing must be enabled before loading.
+ * @param[in] enabled whether loaded texts are hashed
+ */
+void SortSession::setContentHashing(bool enabled) {
+    contentHashing = enabled;
+}
+
+/**
+     * Enables numbering of the text lines of the first occurrences of the collapsed lines (see getLineNumbers).
+     * Numbers are counted by the '\\n' symbols of the original text, so with numbering the text is split without
+     * modification (see splitLinesReadOnly) and literal '\\0' symbols don't end lines. Numbering must be enabled
+     * before loading.
+     * @param[in] enabled whether line numbers of the first occurrences are kept
+     */
+void SortSession::setLineNumbering(bool enabled) {
+    lineNumbering = enabled;
+}
+
+/**
+ * Enables normalization of the loaded texts (see normalizeText): invalid UTF-8 bytes are replaced and CRLF line
+ * endings become '\\n', so lines point into the normalized text instead of the original one. Normalization isn't
+ * applied to read-only texts (see setMappingHints), and incremental loading and sorted indices are not supported
+ * with it, because their offsets must match the original file.
+ * @param[in] enabled whether loaded texts are normalized
+ */
+void SortSession::setTextNormalization(bool enabled) {
+    textNormalization = enabled;
+}
+
+/**
+ * Statistics of the normalization of the loaded text.
+ * @return statistics, all zeros if the text wasn't normalized.
+ */
+const NormalizationStats& SortSession::getNormalizationStats() const {
+    return normalizationStats;
+}
+
+/**
+ * Keys of the composite order.
+ * @return keys, empty if composite order is not set.
+ */
+const std::vector<SortKey>& SortSession::getSortKeys() const {
+    return sortKeys;
+}
+
+/**
+ * Maps the given file and splits it by lines. Previously loaded text is released.
+ * If the cache is given, lines and both sorted permutations are loaded from it without splitting and sorting.
+ * On cache miss the text is split and sorted in both orders, and the results are stored in the cache.
+ * @param[in] filePath path to the file to load
+ * @param[in] cache    cache of sort results or nullptr
+ * @return true, if the file was loaded, false otherwise (e.g. file doesn't exist or it's empty).
+ */
+bool SortSession::loadFile(const char* filePath, const ResultCache* cache) {
+    assert(filePath != nullptr);
+    assert(cache == nullptr || !isKeyFieldSet(keyField));
+    assert(cache == nullptr || !isLineFilterSet(lineFilter));
+    assert(cache == nullptr || headLines == 0);
+
+    clear();
+    mappedFile = std::make_unique<MappedFile>(filePath, mappingHints);
+    if (mappedFile->getTextPtr() == nullptr) {
+        mappedFile.reset();
+        return false;
+    }
+
+    char* text = mappedFile->getTextPtr();
+    // '\n' added by MappedFile stays the last byte of the normalized text
+    size_t textSize = normalize(text, mappedFile->getTextSize());
+    // MappedFile adds '\n' after the file content, it's not a part of the original text
+    setLoadedText(text, textSize - 1);
+    if (cache == nullptr) {
+        split(text, textSize);
+        return true;
+    }
+
+    uint64_t contentHash = cache->hashText(text, textSize);
+    size_t direct = static_cast<size_t>(SortOrder::DIRECT);
+    size_t reverse = static_cast<size_t>(SortOrder::REVERSE);
+    if (cache->load(contentHash, text, textSize, lines, permutations[direct], permutations[reverse])) {
+        permutationReady[direct] = true;
+        permutationReady[reverse] = true;
+        loadedFromCache = true;
+        return true;
+    }
+
+    split(text, textSize);
+    cache->store(
+            contentHash, text, textSize, lines,
+            getSortedPermutation(SortOrder::DIRECT), getSortedPermutation(SortOrder::REVERSE)
+    );
+    return true;
+}
+
+/**
+ * Loads lines and permutations from the saved sort state if it describes a prefix of the text that ends with '\\n'.
+ * @param[in]  statePath  path to the sort state file
+ * @param[in]  text       pointer to the text
+ * @param[in]  fileSize   size of the text without the trailing '\\n' added by MappedFile
+ * @param[out] lines      lines of the saved prefix
+ * @param[out] direct     direct sorted permutation of the lines
+ * @param[out] reverse    reverse sorted permutation of the lines
+ * @param[out] prefixSize size of the saved prefix
+ * @return true, if the sort state can be reused, false otherwise.
+ */
+static bool loadSortState(
+        const char* statePath,
+        const char* text, size_t fileSize,
+        std::vector<Line>& lines,
+        std::vector<size_t>& direct,
+        std::vector<size_t>& reverse,
+        size_t& prefixSize
+) {
+    SortedIndexHeader header = {};
+    if (!readSortedIndexHeader(statePath, header)) return false;
+    if (header.optionsKey != getSortOptionsKey() || header.textSize == 0 || header.textSize > fileSize) return false;
+
+    prefixSize = static_cast<size_t>(header.textSize);
+    // Last line of the saved text must be complete, otherwise appended bytes would change it
+    if (prefixSize != fileSize && text[prefixSize - 1] != '\n') return false;
+    if (hashBytes(text, prefixSize) != header.contentHash) return false;
+
+    return readSortedIndex(statePath, header.contentHash, header.optionsKey, text, prefixSize, lines, direct, reverse);
+}
+
+/**
+ * Maps the given file and sorts it in both orders, reusing the sort state saved by the previous call for this file
+ * (see SORT_STATE_EXTENSION). If the file only grew since then (the saved text is a prefix of the current one
+ * and it ended with '\\n'), only the appended lines are split and sorted, and they are merged into
+ * the saved permutations in linear time. Otherwise the whole file is split and sorted.
+ * The new sort state is saved next to the file.
+ * @param[in] filePath path to the file to load
+ * @return true, if the file was loaded, false otherwise (e.g. file doesn't exist or it's empty).
+ */
+bool SortSession::loadFileIncremental(const char* filePath) {
+    assert(filePath != nullptr);
+    assert(!textNormalization);
+    assert(!isKeyFieldSet(keyField));
+    assert(!isLineFilterSet(lineFilter));
+    assert(headLines == 0);
+
+    clear();
+    mappedFile = std::make_unique<MappedFile>(filePath, mappingHints);
+    if (mappedFile->getTextPtr() == nullptr) {
+        mappedFile.reset();
+        return false;
+    }
+
+    char* text = mappedFile->getTextPtr();
+    size_t textSize = mappedFile->getTextSize();
+    size_t fileSize = textSize - 1;
+    // Hash must be calculated before splitting, because splitting replaces '\n' with '\0'
+    uint64_t contentHash = hashBytes(text, fileSize);
+    loadedText = text;
+    loadedTextSize = fileSize;
+    loadedTextHash = contentHash;
+
+    std::string statePath = std::string(filePath) + SORT_STATE_EXTENSION;
+    size_t direct = static_cast<size_t>(SortOrder::DIRECT);
+    size_t reverse = static_cast<size_t>(SortOrder::REVERSE);
+    size_t prefixSize = 0;
+    if (loadSortState(
+            statePath.c_str(), text, fileSize, lines, permutations[direct], permutations[reverse], prefixSize
+    )) {
+        size_t prefixLinesNumber = lines.size();
+        std::vector<Line> appendedLines;
+        if (prefixSize < fileSize) {
+            if (mappingHints.readOnly || lineNumbering) {
+                splitLinesReadOnly(text + prefixSize, textSize - prefixSize, appendedLines);
+            } else {
+                splitLines(text + prefixSize, textSize - prefixSize, appendedLines);
+            }
+        }
+        lines.insert(lines.end(), appendedLines.begin(), appendedLines.end());
+
+        std::vector<size_t> appendedPermutation(appendedLines.size());
+        std::vector<size_t> merged;
+        for (size_t orderIndex : { direct, reverse }) {
+            int (*compare)(const Line&, const Line&) = compareLinesReverse;
+            if (orderIndex == direct) compare = compareLinesDirect;
+            for (size_t i = 0; i < appendedPermutation.size(); ++i) {
+                appendedPermutation[i] = prefixLinesNumber + i;
+            }
+            sortLineIndices(appendedPermutation.begin(), appendedPermutation.end(), lines, compare);
+            mergeLineIndices(permutations[orderIndex], appendedPermutation, lines, compare, merged);
+            permutations[orderIndex].swap(merged);
+            permutationReady[orderIndex] = true;
+        }
+        loadedIncrementally = true;
+    } else {
+        split(text, textSize);
+    }
+
+    writeSortedIndex(
+            statePath.c_str(), contentHash, getSortOptionsKey(), text, fileSize, lines,
+            getSortedPermutation(SortOrder::DIRECT), getSortedPermutation(SortOrder::REVERSE)
+    );
+    return true;
+}
+
+/**
+ * Saves lines of the loaded text and their direct and reverse sorted permutations to the sorted index file
+ * (see writeSortedIndex), so consumers can map it and get positions of the sorted lines in the original text
+ * without parsing the text outputs. Content hash of the index is XXH64 (seed 0) of the original text.
+ * Hashing must be enabled before loading (see setContentHashing), the first lines must not be limited.
+ * @param[in] filePath path to the index file
+ * @return true, if the index was saved, false otherwise.
+ */
+bool SortSession::saveSortedIndex(const char* filePath) {
+    assert(filePath != nullptr);
+    assert(contentHashing);
+    assert(headLines == 0);
+
+    if (loadedText == nullptr) return false;
+    return writeSortedIndex(
+            filePath, loadedTextHash, getSortOptionsKey(), loadedText, loadedTextSize, lines,
+            getSortedPermutation(SortOrder::DIRECT), getSortedPermutation(SortOrder::REVERSE)
+    );
+}
+
+/**
+ * Whether the last loaded file was sorted by merging appended lines into the saved sort state.
+ * @return true, if the saved sort state was reused, false otherwise.
+ */
+bool SortSession::isLoadedIncrementally() const {
+    return loadedIncrementally;
+}
+
+/**
+ * Whether the last loaded file was loaded from the cache.
+ * @return true on cache hit, false otherwise.
+ */
+bool SortSession::isLoadedFromCache() const {
+    return loadedFromCache;
+}
+
+/**
+ * Splits the given caller-owned buffer by lines. Previously loaded text is released.
+ * If the buffer ends with '\\n', it's used in-place: each '\\n' is replaced with '\\0' (see splitLines),
+ * unless the read-only mapping hint is set (see setMappingHints) or line numbering is enabled,
+ * and the buffer must outlive the loaded lines. Otherwise the buffer is copied to an internal reusable buffer.
+ * If normalization is enabled (see setTextNormalization), the in-place buffer is normalized too.
+ * @param[in, out] buffer pointer to the text
+ * @param[in]      size   size of the text in bytes
+ */
+void SortSession::loadBuffer(char* buffer, size_t size) {
+    assert(buffer != nullptr || size == 0);
+
+    clear();
+    if (size > 0 && buffer[size - 1] == '\n') {
+        size = normalize(buffer, size);
+        setLoadedText(buffer, size);
+        split(buffer, size);
+        return;
+    }
+
+    textCopy.resize(size + 1);
+    if (size > 0) memcpy(textCopy.data(), buffer, size);
+    textCopy[size] = '\n';
+    textCopy.resize(normalize(textCopy.data(), textCopy.size()));
+    setLoadedText(textCopy.data(), textCopy.size() - 1);
+    split(textCopy.data(), textCopy.size());
+}
+
+/**
+ * Collapses duplicate lines of the loaded text (see collapseDuplicates): only the first occurrence of each
+ * distinct line is kept in getLines(), the number of occurrences is kept in getLineCounts() and, if line numbering
+ * is enabled (see setLineNumbering), the number of the text line of the first occurrence is kept
+ * in getLineNumbers(). Sorted results are reset, so only distinct lines are sorted.
+ */
+void SortSession::collapseDuplicateLines() {
+    buildKeyLines();
+    collapseDuplicates(lines, distinctLines, scratch);
+
+    // First occurrences are ascending, so the text is scanned once. Text isn't modified with numbering (see split)
+    lineNumbers.clear();
+    if (lineNumbering) {
+        const char* textPtr = loadedText;
+        size_t lineNumber = 1;
+        for (size_t index : distinctLines.lineIndices) {
+            lineNumber += countNewlines(textPtr, lines[index].lineStart - textPtr);
+            textPtr = lines[index].lineStart;
+            lineNumbers.push_back(lineNumber);
+        }
+    }
+
+    for (size_t i = 0; i < distinctLines.lineIndices.size(); ++i) {
+        lines[i] = lines[distinctLines.lineIndices[i]];
+        if (!keyLines.empty()) keyLines[i] = keyLines[distinctLines.lineIndices[i]];
+    }
+    lines.erase(lines.begin() + distinctLines.lineIndices.size(), lines.end());
+    if (!keyLines.empty()) keyLines.erase(keyLines.begin() + distinctLines.lineIndices.size(), keyLines.end());
+    lineCounts.swap(distinctLines.counts);
+    lineTableReady = false;
+
+    for (size_t i = 0; i < ORDERS_NUMBER; ++i) {
+        permutationReady[i] = false;
+        sortedLinesReady[i] = false;
+    }
+}
+
+/**
+ * Number of occurrences of each line of getLines() in the loaded text.
+ * @return vector of the counts, empty if duplicates were not collapsed.
+ */
+const std::vector<size_t>& SortSession::getLineCounts() const {
+    return lineCounts;
+}
+
+/**
+ * Number of the text line (starting from 1, lines without letters are counted too) of the first occurrence
+ * of each line of getLines().
+ * @return vector of the line numbers, empty if duplicates were not collapsed or line numbering is disabled.
+ */
+const std::vector<size_t>& SortSession::getLineNumbers() const {
+    return lineNumbers;
+}
+
+/**
+ * Releases loaded text. Internal buffers and the scratch arena are kept for reuse.
+ */
+void SortSession::clear() {
+    mappedFile.reset();
+    scratch.reset();
+    loadedText = nullptr;
+    loadedTextSize = 0;
+    loadedTextHash = 0;
+    normalizationStats = {};
+    loadedFromCache = false;
+    loadedIncrementally = false;
+    lines.clear();
+    lineCounts.clear();
+    lineNumbers.clear();
+    keyLines.clear();
+    lineTableReady = false;
+    for (size_t i = 0; i < ORDERS_NUMBER; ++i) {
+        permutations[i].clear();
+        sortedLines[i].clear();
+        permutationReady[i] = false;
+        sortedLinesReady[i] = false;
+    }
+}
+
+/**
+ * Lines of the loaded text in original order. Lines without letters are removed.
+ * @return vector of the lines.
+ */
+const std::vector<Line>& SortSession::getLines() const {
+    return lines;
+}
+
+/**
+ * Sorted permutation of the lines: getLines()[permutation[0]] is the first line in the given order etc.
+ * If the number of the first lines is limited (see setHeadLines), only these lines are in the permutation.
+ * @param[in] order order to sort the lines in
+ * @return vector of the indices of the lines.
+ */
+const std::vector<size_t>& SortSession::getSortedPermutation(SortOrder order) {
+    size_t orderIndex = static_cast<size_t>(order);
+    std::vector<size_t>& permutation = permutations[orderIndex];
+    if (permutationReady[orderIndex]) return permutation;
+
+    permutation.resize(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        permutation[i] = i;
+    }
+    int (*compare)(const Line&, const Line&) = compareLinesReverse;
+    if (order == SortOrder::DIRECT) compare = compareLinesDirect;
+    auto middle = headLines != 0 && headLines < lines.size() ? permutation.begin() + headLines : permutation.end();
+    if (order == SortOrder::COMPOSITE) {
+        assert(!sortKeys.empty());
+        // Keys are built once for the loaded lines, the composite order never rescans the text
+        buildKeyLines();
+        buildLineKeys(isKeyFieldSet(keyField) ? keyLines : lines, lineKeys);
+        partialSortLineIndicesByCompositeKeys(permutation.begin(), middle, permutation.end(), lineKeys, sortKeys);
+    } else if (isKeyFieldSet(keyField)) {
+        buildKeyLines();
+        partialSortLineIndicesByKeys(permutation.begin(), middle, permutation.end(), keyLines, lines, compare);
+    } else if (prepareLineTable()) {
+        // Most comparisons are decided by the key columns of the table, without scanning the text
+        SortKey key = order == SortOrder::DIRECT ? SortKey::DIRECT : SortKey::REVERSE;
+        partialSortLineIndicesByTable(permutation.begin(), middle, permutation.end(), lineTable, key);
+    } else {
+        partialSortLineIndices(permutation.begin(), middle, permutation.end(), lines, compare);
+    }
+    permutation.erase(middle, permutation.end());
+
+    permutationReady[orderIndex] = true;
+    return permutation;
+}
+
+/**
+ * Lines of the loaded text sorted in the given order.
+ * @param[in] order order to sort the lines in
+ * @return vector of the sorted lines.
+ */
+const std::vector<Line>& SortSession::getSortedLines(SortOrder order) {
+    size_t orderIndex = static_cast<size_t>(order);
+    std::vector<Line>& sorted = sortedLines[orderIndex];
+    if (sortedLinesReady[orderIndex]) return sorted;
+
+    const std::vector<size_t>& permutation = getSortedPermutation(order);
+    sorted.clear();
+    sorted.reserve(permutation.size());
+    for (size_t index : permutation) {
+        sorted.push_back(lines[index]);
+    }
+
+    sortedLinesReady[orderIndex] = true;
+    return sorted;
+}
@@ -0,0 +1,294 @@
+/**
+ * @file
+ * @brief Header file for SortSession class
+ */
+#ifndef POEM_SORTER_SORTSESSION_H
+#define POEM_SORTER_SORTSESSION_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "Arena.h"
+#include "duplicates.h"
+#include "fields.h"
+#include "line_filter.h"
+#include "line_table.h"
+#include "MappedFile.h"
+#include "sort_keys.h"
+#include "ResultCache.h"
+#include "text_helpers.h"
+#include "text_normalization.h"
+
+/**
+ * Order in which lines are sorted.
+ */
+enum class SortOrder {
+    DIRECT,    /**< from left to right, see compareLinesDirect */
+    REVERSE,   /**< from right to left, see compareLinesReverse */
+    COMPOSITE, /**< by the composite keys (see SortSession::setSortKeys) */
+};
+
+/**
+ * Reusable sorting session: loads a text (from a file or from a caller-owned buffer), splits it by lines and
+ * gives lines sorted in direct or reverse order.
+ * Sorting is performed lazily - only for the requested order and only once per loaded text.
+ * Internal buffers are kept between loads, so a single session can process many texts without reallocations:
+ * line tables are sized from the number of '\\n' symbols before splitting, temporary buffers are taken from
+ * the scratch arena (see Arena) that is reset on each load.
+ *
+ * @note Lines point into the loaded text, so they are valid only until the next load or clear() call.
+ */
+class SortSession {
+private:
+    static constexpr size_t ORDERS_NUMBER = 3;
+
+    std::unique_ptr<MappedFile> mappedFile;
+    std::vector<char> textCopy;
+    const char* loadedText = nullptr;
+    size_t loadedTextSize = 0;
+    uint64_t loadedTextHash = 0;
+    bool contentHashing = false;
+    bool lineNumbering = false;
+    bool textNormalization = false;
+    NormalizationStats normalizationStats;
+    MappingHints mappingHints;
+    Arena scratch;
+
+    std::vector<Line> lines;
+    LineTable lineTable;
+    bool lineTableReady = false;
+    std::vector<size_t> lineCounts;
+    std::vector<size_t> lineNumbers;
+    LineFilter lineFilter;
+    KeyField keyField;
+    WordTable wordTable;
+    std::vector<Line> keyLines;
+    std::vector<SortKey> sortKeys;
+    size_t headLines = 0;
+    LineKeys lineKeys;
+    DistinctLines distinctLines;
+    std::vector<size_t> permutations[ORDERS_NUMBER];
+    std::vector<Line> sortedLines[ORDERS_NUMBER];
+    bool permutationReady[ORDERS_NUMBER] = { false, false, false };
+    bool sortedLinesReady[ORDERS_NUMBER] = { false, false, false };
+    bool loadedFromCache = false;
+    bool loadedIncrementally = false;
+
+    /**
+     * Splits the given text by lines and resets all sorted results.
+     * @param[in] text pointer to the text that ends with '\\n'
+     * @param[in] size size of the text in bytes
+     */
+    void split(char* text, size_t size);
+
+    /**
+     * Remembers the loaded text and hashes it, if hashing is enabled. Must be called before the text is split.
+     * @param[in] text     pointer to the original text
+     * @param[in] textSize size of the original text in bytes
+     */
+    void setLoadedText(const char* text, size_t textSize);
+
+    /**
+     * Normalizes the text (see normalizeText), if normalization is enabled and the text isn't read-only.
+     * Must be called before the text is hashed and split.
+     * @param[in, out] text pointer to the text
+     * @param[in]      size size of the text in bytes
+     * @return size of the normalized text in bytes.
+     */
+    size_t normalize(char* text, size_t size);
+
+    /**
+     * Builds keys of the lines from the word table, if the key field is set and the keys are not built yet.
+     */
+    void buildKeyLines();
+
+    /**
+     * Builds the table of the loaded lines (see LineTable), if it's not built yet.
+     * @return true, if the table is built, false if the lines don't fit in it.
+     */
+    bool prepareLineTable();
+
+public:
+    SortSession() = default;
+
+    SortSession(SortSession& sortSession) = delete;
+    SortSession &operator=(const SortSession&) = delete;
+
+    /**
+     * Sets the key field of the lines (see KeyField): lines are sorted by their key fields, lines with equal keys
+     * are sorted as a whole. Word boundaries are computed while the text is split, so the key field must be set
+     * before loading. Cache and incremental loading are not supported with the key field.
+     * @param[in] field key field, not set key field means that lines are sorted as a whole
+     */
+    void setKeyField(const KeyField& field);
+
+    /**
+     * Sets the filter of the lines (see LineFilter): lines that don't pass it are dropped while the text is split,
+     * so they are never sorted. Filter must be set before loading. Cache and incremental loading are not supported
+     * with the filter.
+     * @param[in] filter filter of the lines, not set filter means that all lines with letters are kept
+     */
+    void setLineFilter(const LineFilter& filter);
+
+    /**
+     * Sets the keys of the composite order (SortOrder::COMPOSITE). Keys of all lines are materialized once,
+     * when the composite order is requested for the first time. If the key field is set, keys are built from it.
+     * @param[in] keys keys of the composite order (see parseSortKeys)
+     */
+    void setSortKeys(const std::vector<SortKey>& keys);
+
+    /**
+     * Limits sorted results to the first lines: only they are sorted (see partialSortLineIndices), the rest of
+     * the lines are never ordered. Cache and incremental loading are not supported with the limit.
+     * @param[in] count number of the first lines of each order, 0 means all lines
+     */
+    void setHeadLines(size_t count);
+
+    /**
+     * Sets the hints for the kernel about the access to the mapped files (see MappingHints). Access advice is given
+     * right before splitting (sequential access) and right after it (random access while sorting). With the read-only
+     * hint the text is split without modification (see splitLinesReadOnly), also for buffers given to loadBuffer.
+     * @param[in] hints mapping hints of the next loaded files
+     */
+    void setMappingHints(const MappingHints& hints);
+
+    /**
+     * Enables hashing of the loaded texts, which is needed to save their sorted indices (see saveSortedIndex).
+     * Text is hashed before it's split, so hashing must be enabled before loading.
+     * @param[in] enabled whether loaded texts are hashed
+     */
+    void setContentHashing(bool enabled);
+
+    /**
+     * Enables numbering of the text lines of the first occurrences of the collapsed lines (see getLineNumbers).
+     * Numbers are counted by the '\\n' symbols of the original text, so with numbering the text is split without
+     * modification (see splitLinesReadOnly) and literal '\\0' symbols don't end lines. Numbering must be enabled
+     * before loading.
+     * @param[in] enabled whether line numbers of the first occurrences are kept
+     */
+    void setLineNumbering(bool enabled);
+
+    /**
+     * Enables normalization of the loaded texts (see normalizeText): invalid UTF-8 bytes are replaced and CRLF line
+     * endings become '\\n', so lines point into the normalized text instead of the original one. Normalization isn't
+     * applied to read-only texts (see setMappingHints), and incremental loading and sorted indices are not supported
+     * with it, because their offsets must match the original file.
+     * @param[in] enabled whether loaded texts are normalized
+     */
+    void setTextNormalization(bool enabled);
+
+    /**
+     * Statistics of the normalization of the loaded text.
+     * @return statistics, all zeros if the text wasn't normalized.
+     */
+    const NormalizationStats& getNormalizationStats() const;
+
+    /**
+     * Keys of the composite order.
+     * @return keys, empty if composite order is not set.
+     */
+    const std::vector<SortKey>& getSortKeys() const;
+
+    /**
+     * Maps the given file and splits it by lines. Previously loaded text is released.
+     * If the cache is given, lines and both sorted permutations are loaded from it without splitting and sorting.
+     * On cache miss the text is split and sorted in both orders, and the results are stored in the cache.
+     * @param[in] filePath path to the file to load
+     * @param[in] cache    cache of sort results or nullptr
+     * @return true, if the file was loaded, false otherwise (e.g. file doesn't exist or it's empty).
+     */
+    bool loadFile(const char* filePath, const ResultCache* cache = nullptr);
+
+    /**
+     * Maps the given file and sorts it in both orders, reusing the sort state saved by the previous call for this file
+     * (see SORT_STATE_EXTENSION). If the file only grew since then (the saved text is a prefix of the current one
+     * and it ended with '\\n'), only the appended lines are split and sorted, and they are merged into
+     * the saved permutations in linear time. Otherwise the whole file is split and sorted.
+     * The new sort state is saved next to the file.
+     * @param[in] filePath path to the file to load
+     * @return true, if the file was loaded, false otherwise (e.g. file doesn't exist or it's empty).
+     */
+    bool loadFileIncremental(const char* filePath);
+
+    /**
+     * Saves lines of the loaded text and their direct and reverse sorted permutations to the sorted index file
+     * (see writeSortedIndex), so consumers can map it and get positions of the sorted lines in the original text
+     * without parsing the text outputs. Content hash of the index is XXH64 (seed 0) of the original text.
+     * Hashing must be enabled before loading (see setContentHashing), the first lines must not be limited.
+     * @param[in] filePath path to the index file
+     * @return true, if the index was saved, false otherwise.
+     */
+    bool saveSortedIndex(const char* filePath);
+
+    /**
+     * Whether the last loaded file was sorted by merging appended lines into the saved sort state.
+     * @return true, if the saved sort state was reused, false otherwise.
+     */
+    bool isLoadedIncrementally() const;
+
+    /**
+     * Whether the last loaded file was loaded from the cache.
+     * @return true on cache hit, false otherwise.
+     */
+    bool isLoadedFromCache() const;
+
+    /**
+     * Splits the given caller-owned buffer by lines. Previously loaded text is released.
+     * If the buffer ends with '\\n', it's used in-place: each '\\n' is replaced with '\\0' (see splitLines),
+     * unless the read-only mapping hint is set (see setMappingHints) or line numbering is enabled,
+     * and the buffer must outlive the loaded lines. Otherwise the buffer is copied to an internal reusable buffer.
+     * If normalization is enabled (see setTextNormalization), the in-place buffer is normalized too.
+     * @param[in, out] buffer pointer to the text
+     * @param[in]      size   size of the text in bytes
+     */
+    void loadBuffer(char* buffer, size_t size);
+
+    /**
+     * Collapses duplicate lines of the loaded text (see collapseDuplicates): only the first occurrence of each
+     * distinct line is kept in getLines(), the number of occurrences is kept in getLineCounts() and, if line numbering
+     * is enabled (see setLineNumbering), the number of the text line of the first occurrence is kept
+     * in getLineNumbers(). Sorted results are reset, so only distinct lines are sorted.
+     */
+    void collapseDuplicateLines();
+
+    /**
+     * Number of occurrences of each line of getLines() in the loaded text.
+     * @return vector of the counts, empty if duplicates were not collapsed.
+     */
+    const std::vector<size_t>& getLineCounts() const;
+
+    /**
+     * Number of the text line (starting from 1, lines without letters are counted too) of the first occurrence
+     * of each line of getLines().
+     * @return vector of the line numbers, empty if duplicates were not collapsed or line numbering is disabled.
+     */
+    const std::vector<size_t>& getLineNumbers() const;
+
+    /**
+     * Releases loaded text. Internal buffers and the scratch arena are kept for reuse.
+     */
+    void clear();
+
+    /**
+     * Lines of the loaded text in original order. Lines without letters are removed.
+     * @return vector of the lines.
+     */
+    const std::vector<Line>& getLines() const;
+
+    /**
+     * Sorted permutation of the lines: getLines()[permutation[0]] is the first line in the given order etc.
+     * If the number of the first lines is limited (see setHeadLines), only these lines are in the permutation.
+     * @param[in] order order to sort the lines in
+     * @return vector of the indices of the lines.
+     */
+    const std::vector<size_t>& getSortedPermutation(SortOrder order);
+
+    /**
+     * Lines of the loaded text sorted in the given order.
+     * @param[in] order order to sort the lines in
+     * @return vector of the sorted lines.
+     */
+    const std::vector<Line>& getSortedLines(SortOrder order);
+};
+
+#endif //POEM_SORTER_SORTSESSION_H
@@ -0,0 +1,251 @@
+/**
+ * @file
+ * @brief Source file with command line options parsing of the sorter
+ */
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <thread>
+#include "MappedFile.h"
+#include "rhymes.h"
+#include "SorterOptions.h"
+
+/**
+ * Parses a positive number from the option argument.
+ * @param[in]  arg    option argument
+ * @param[out] result parsed number
+ * @return true, if the argument is a positive number, false otherwise.
+ */
+static bool parsePositiveNumber(const char* arg, unsigned int& result) {
+    assert(arg != nullptr);
+
+    char* end = nullptr;
+    unsigned long number = strtoul(arg, &end, 10);
+    if (end == arg || *end != '\0' || number == 0) return false;
+    result = number;
+    return true;
+}
+
+/**
+ * Parses command line arguments of the sorter.
+ * @param[in]  argc    number of arguments
+ * @param[in]  argv    arguments
+ * @param[out] options parsed options
+ * @return true, if arguments are valid, false otherwise.
+ */
+bool parseSorterOptions(int argc, char* argv[], SorterOptions& options) {
+    assert(argv != nullptr);
+
+    static const option longOptions[] = {
+            { "serve",       required_argument, nullptr, 's' },
+            { "max-payload", required_argument, nullptr, 'X' },
+            { "threads",     required_argument, nullptr, 't' },
+            { "batch",       required_argument, nullptr, 'b' },
+            { "watch",       required_argument, nullptr, 'w' },
+            { "output",      required_argument, nullptr, 'o' },
+            { "combined",    no_argument,       nullptr, 'c' },
+            { "cache-dir",   required_argument, nullptr, 'C' },
+            { "incremental", no_argument,       nullptr, 'i' },
+            { "unique",      no_argument,       nullptr, 'u' },
+            { "count",       no_argument,       nullptr, 'n' },
+            { "contains",    required_argument, nullptr, 'x' },
+            { "min-letters", required_argument, nullptr, 'm' },
+            { "max-letters", required_argument, nullptr, 'M' },
+            { "capital",     no_argument,       nullptr, 'p' },
+            { "match",       required_argument, nullptr, 'P' },
+            { "key",         required_argument, nullptr, 'k' },
+            { "order",       required_argument, nullptr, 'O' },
+            { "stdout",      no_argument,       nullptr, 'S' },
+            { "perm-out",    no_argument,       nullptr, 'I' },
+            { "mmap",        required_argument, nullptr, 'a' },
+            { "normalize",   no_argument,       nullptr, 'N' },
+            { "force-isa",   required_argument, nullptr, 'F' },
+            { "collation",   required_argument, nullptr, 'L' },
+            { "head",        required_argument, nullptr, 'H' },
+            { "rhyme",       required_argument, nullptr, 'r' },
+            { nullptr,       0,                 nullptr, 0   },
+    };
+
+    if (argc > 1 && strcmp(argv[1], "query") == 0) {
+        options.command = SorterCommand::QUERY;
+        optind = 2;
+    } else if (argc > 1 && strcmp(argv[1], "scheme") == 0) {
+        options.command = SorterCommand::SCHEME;
+        optind = 2;
+    }
+
+    int opt;
+    unsigned int lettersNumber = 0;
+    while ((opt = getopt_long(argc, argv, "k:", longOptions, nullptr)) != -1) {
+        switch (opt) {
+            case 's':
+                options.servePath = optarg;
+                break;
+            case 'X':
+                if (!parsePositiveNumber(optarg, options.maxPayloadMb)) return false;
+                break;
+            case 'b':
+                options.batchPath = optarg;
+                break;
+            case 'w':
+                options.watchPath = optarg;
+                break;
+            case 'o':
+                options.outputDirectory = optarg;
+                break;
+            case 'c':
+                options.combinedOutput = true;
+                break;
+            case 'C':
+                options.cacheDirectory = optarg;
+                break;
+            case 'i':
+                options.incremental = true;
+                break;
+            case 'u':
+                options.uniqueLines = true;
+                break;
+            case 'n':
+                options.uniqueLines = true;
+                options.countLines = true;
+                break;
+            case 'x':
+                options.lineFilter.substring = optarg;
+                break;
+            case 'm':
+                if (!parsePositiveNumber(optarg, lettersNumber)) return false;
+                options.lineFilter.minLetters = lettersNumber;
+                break;
+            case 'M':
+                if (!parsePositiveNumber(optarg, lettersNumber)) return false;
+                options.lineFilter.maxLetters = lettersNumber;
+                break;
+            case 'p':
+                options.lineFilter.capital = true;
+                break;
+            case 'P':
+                if (!parseLetterPattern(optarg, options.lineFilter.pattern)) return false;
+                break;
+            case 'k':
+                if (!parseKeyField(optarg, options.keyField)) return false;
+                break;
+            case 'O':
+                if (!parseSortKeys(optarg, options.sortKeys)) return false;
+                break;
+            case 'S':
+                options.standardOutput = true;
+                break;
+            case 'I':
+                options.indexOutput = true;
+                break;
+            case 'a':
+                if (!parseMappingHints(optarg, options.mappingHints)) return false;
+                break;
+            case 'N':
+                options.textNormalization = true;
+                break;
+            case 'F':
+                if (!parseIsa(optarg, options.forcedIsa)) return false;
+                options.isaForced = true;
+                break;
+            case 'L':
+                options.collation = findCollationTable(optarg);
+                if (options.collation == nullptr) return false;
+                break;
+            case 'H':
+                if (!parsePositiveNumber(optarg, options.headLines)) return false;
+                break;
+            case 'r':
+                if (!parsePositiveNumber(optarg, options.rhymeLetters) || options.rhymeLetters > MAX_RHYME_LETTERS) {
+                    return false;
+                }
+                break;
+            case 't':
+                if (!parsePositiveNumber(optarg, options.threadsNumber)) return false;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    if (optind < argc) {
+        options.filePath = argv[optind++];
+    }
+    if (options.command == SorterCommand::QUERY) {
+        if (optind >= argc) return false;
+        options.queryEnding = argv[optind++];
+    }
+    if (optind < argc) return false;
+    if (options.maxPayloadMb != 0 && options.servePath == nullptr) return false;
+    if (options.command == SorterCommand::SCHEME && options.filePath == nullptr) return false;
+    // Scheme command only splits the poems, options of sorting and writing the results don't apply to it
+    if (options.command == SorterCommand::SCHEME
+        && (options.uniqueLines || options.standardOutput || options.indexOutput || options.combinedOutput
+            || options.incremental || options.cacheDirectory != nullptr || isKeyFieldSet(options.keyField)
+            || !options.sortKeys.empty() || options.headLines != 0 || isLineFilterSet(options.lineFilter)
+            || options.servePath != nullptr || options.batchPath != nullptr || options.watchPath != nullptr)) {
+        return false;
+    }
+    // Cached and saved sort results are built for all lines sorted as a whole
+    if ((isKeyFieldSet(options.keyField) || isLineFilterSet(options.lineFilter) || options.headLines != 0)
+        && (options.incremental || options.cacheDirectory != nullptr)) {
+        return false;
+    }
+    if (options.lineFilter.minLetters > options.lineFilter.maxLetters) return false;
+    // Standard input can't be reread, and there is no file to put the saved state or rhyme index next to
+    bool standardInput = options.filePath != nullptr && strcmp(options.filePath, STDIN_FILE_PATH) == 0;
+    if (standardInput && (options.incremental || options.command == SorterCommand::QUERY)) return false;
+    if (options.standardOutput
+        && (options.indexOutput || options.servePath != nullptr || options.batchPath != nullptr || options.watchPath != nullptr)) {
+        return false;
+    }
+    // Sort states and sorted indices store offsets in the original file, and read-only texts can't be normalized
+    if (options.textNormalization && (options.incremental || options.indexOutput || options.mappingHints.readOnly)) {
+        return false;
+    }
+    // Sorted index stores all lines in direct and reverse orders of the whole lines
+    if (options.indexOutput
+        && (options.headLines != 0 || isKeyFieldSet(options.keyField) || !options.sortKeys.empty() || options.countLines)) {
+        return false;
+    }
+
+    return options.servePath != nullptr || options.batchPath != nullptr || options.watchPath != nullptr
+        || options.filePath != nullptr;
+}
+
+/**
+ * Prints usage of the sorter to stderr.
+ * @param[in] programName name of the program (argv[0])
+ */
+void printSorterUsage(const char* programName) {
+    fprintf(
+            stderr,
+            "Usage: %s file_name|- [--cache-dir directory | --incremental | -k N[,M]] [--order keys] [--unique | --count]\n"
+            "             [--head N] [--stdout | --perm-out] [--contains text] [--min-letters N] [--max-letters N] [--capital]\n"
+            "             [--match pattern] [--mmap hints] [--normalize] [--force-isa name] [--collation name]\n"
+            "       %s file_name|- --rhyme N [--stdout] [--normalize]\n"
+            "       %s query file_name ending\n"
+            "       %s scheme file_or_directory [--rhyme N] [--threads N] [--normalize]\n"
+            "       %s --serve socket_path [--threads N] [--max-payload MiB]\n"
+            "       %s --batch directory_or_list [--output directory] [--combined] [--cache-dir directory] [--threads N]\n"
+            "       %s --watch file_or_directory [--output directory] [--cache-dir directory | --incremental | -k N[,M]]\n"
+            "             [--order keys] [--unique | --count] [--threads N]\n"
+            "             [--head N | --perm-out] [--contains text] [--min-letters N] [--max-letters N] [--capital] [--match pattern]\n"
+            "             [--mmap hints] [--normalize] [--force-isa name] [--collation name]\n",
+            programName, programName, programName, programName, programName, programName, programName
+    );
+}
+
+/**
+ * Number of worker threads that should be used: the given number or number of CPUs if it's zero.
+ * @param[in] options sorter options
+ * @return number of threads (at least 1).
+ */
+unsigned int getThreadsNumber(const SorterOptions& options) {
+    if (options.threadsNumber != 0) return options.threadsNumber;
+
+    unsigned int cpusNumber = std::thread::hardware_concurrency();
+    return cpusNumber != 0 ? cpusNumber : 1;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file
+ * @brief Header file with command line options of the sorter
+ */
+#ifndef POEM_SORTER_SORTEROPTIONS_H
+#define POEM_SORTER_SORTEROPTIONS_H
+
+#include <vector>
+#include "collation.h"
+#include "fields.h"
+#include "line_filter.h"
+#include "MappedFile.h"
+#include "sort_keys.h"
+#include "text_kernels.h"
+
+/**
+ * Command (first argument) of the sorter.
+ */
+enum class SorterCommand {
+    SORT,   /**< sort files (default) */
+    QUERY,  /**< find lines by ending using the rhyme index ("query" command) */
+    SCHEME, /**< detect rhyme schemes of the stanzas ("scheme" command) */
+};
+
+/**
+ * Command line options of the sorter.
+ */
+struct SorterOptions {
+    SorterCommand command = SorterCommand::SORT; /**< command to run */
+    const char* filePath = nullptr;              /**< file to sort (or poems of scheme command), STDIN_FILE_PATH to sort the standard input */
+    const char* queryEnding = nullptr;           /**< ending of the lines to find (query command) */
+    const char* servePath = nullptr;             /**< socket path to serve requests on (--serve), nullptr if not in server mode */
+    unsigned int maxPayloadMb = 0;               /**< maximum size of the server request payload in MiB (--max-payload), 0 means the default */
+    const char* batchPath = nullptr;             /**< directory or list of files to sort (--batch), nullptr if not in batch mode */
+    const char* watchPath = nullptr;             /**< file or directory to watch and re-sort on changes (--watch), nullptr if not in watch mode */
+    const char* outputDirectory = ".";           /**< directory to write batch results to (--output) */
+    bool combinedOutput = false;                 /**< whether batch results are written to combined files (--combined) */
+    bool incremental = false;                    /**< whether appended lines are merged into the saved sort state (--incremental) */
+    bool uniqueLines = false;                    /**< whether duplicate lines are collapsed (--unique or --count) */
+    bool standardOutput = false;                 /**< whether sorted lines are written to stdout instead of the files (--stdout) */
+    bool indexOutput = false;                    /**< whether the sorted index is written instead of the text results (--perm-out) */
+    bool countLines = false;                     /**< whether distinct lines are written with their counts (--count) */
+    LineFilter lineFilter;                       /**< filter of the lines (--contains, --min-letters, --max-letters, --capital, --match) */
+    KeyField keyField;                           /**< key field of the lines (-k, --key), not set if lines are sorted as a whole */
+    std::vector<SortKey> sortKeys;               /**< keys of the composite order (--order), empty if lines are sorted in direct and reverse orders */
+    unsigned int headLines = 0;                  /**< number of the first sorted lines to write (--head), 0 means all lines */
+    MappingHints mappingHints;                   /**< hints for the kernel about the access to the mapped files (--mmap) */
+    bool textNormalization = false;              /**< whether invalid UTF-8 is replaced and CRLF line endings are dropped (--normalize) */
+    bool isaForced = false;                      /**< whether text kernels of the forced instruction set are used (--force-isa) */
+    Isa forcedIsa = Isa::SCALAR;                 /**< instruction set of the text kernels, if it's forced (--force-isa) */
+    const CollationTable* collation = nullptr;   /**< collation table of letters (--collation), nullptr means the default one */
+    const char* cacheDirectory = nullptr;        /**< directory of the sort results cache (--cache-dir), nullptr if cache is disabled */
+    unsigned int rhymeLetters = 0;               /**< number of letters in rhyme key (--rhyme), 0 if lines are not grouped by rhyme */
+    unsigned int threadsNumber = 0;              /**< number of worker threads (--threads), 0 means number of CPUs */
+};
+
+/**
+ * Parses command line arguments of the sorter.
+ * @param[in]  argc    number of arguments
+ * @param[in]  argv    arguments
+ * @param[out] options parsed options
+ * @return true, if arguments are valid, false otherwise.
+ */
+bool parseSorterOptions(int argc, char* argv[], SorterOptions& options);
+
+/**
+ * Prints usage of the sorter to stderr.
+ * @param[in] programName name of the program (argv[0])
+ */
+void printSorterUsage(const char* programName);
+
+/**
+ * Number of worker threads that should be used: the given number or number of CPUs if it's zero.
+ * @param[in] options sorter options
+ * @return number of threads (at least 1).
+ */
+unsigned int getThreadsNumber(const SorterOptions& options);
+
+#endif //POEM_SORTER_SORTEROPTIONS_H
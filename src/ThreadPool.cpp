@@ -0,0 +1,84 @@
+/**
+ * @file
+ * @brief Source file for ThreadPool class
+ */
+#include <cassert>
+#include "ThreadPool.h"
+
+/**
+ * Starts the given number of threads.
+ * @param[in] threadsNumber number of threads in the pool (at least 1)
+ */
+ThreadPool::ThreadPool(size_t threadsNumber) {
+    assert(threadsNumber > 0);
+
+    threads.reserve(threadsNumber);
+    for (size_t i = 0; i < threadsNumber; ++i) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+/**
+ * Stops and joins all threads.
+ */
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+    runStarted.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * Number of threads in the pool.
+ * @return number of threads.
+ */
+size_t ThreadPool::size() const {
+    return threads.size();
+}
+
+/**
+ * Runs task with indices 0, 1, ..., tasksNumber - 1 on the pool threads and waits until all of them are finished.
+ * @param[in] tasksNumber number of tasks to run
+ * @param[in] poolTask    task to run
+ */
+void ThreadPool::run(size_t tasksNumber, const PoolTask& poolTask) {
+    std::unique_lock<std::mutex> lock(mutex);
+    task = &poolTask;
+    this->tasksNumber = tasksNumber;
+    nextTaskIndex = 0;
+    runningWorkersNumber = threads.size();
+    ++runId;
+    runStarted.notify_all();
+
+    runFinished.wait(lock, [this]() { return runningWorkersNumber == 0; });
+    task = nullptr;
+}
+
+/**
+ * Waits for runs and executes their tasks until the pool is destroyed.
+ * @param[in] workerIndex index of this worker
+ */
+void ThreadPool::workerLoop(size_t workerIndex) {
+    size_t lastRunId = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        runStarted.wait(lock, [this, lastRunId]() { return stopped || runId != lastRunId; });
+        if (stopped) return;
+        lastRunId = runId;
+
+        while (nextTaskIndex < tasksNumber) {
+            size_t taskIndex = nextTaskIndex++;
+            lock.unlock();
+            (*task)(workerIndex, taskIndex);
+            lock.lock();
+        }
+
+        if (--runningWorkersNumber == 0) {
+            runFinished.notify_one();
+        }
+    }
+}
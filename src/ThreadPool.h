@@ -0,0 +1,74 @@
+/**
+ * @file
+ * @brief Header file for ThreadPool class
+ */
+#ifndef POEM_SORTER_THREADPOOL_H
+#define POEM_SORTER_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Task that is run by ThreadPool: receives index of the worker that runs it and index of the task.
+ * Worker index can be used to access per-worker state (e.g. SortSession) without synchronization.
+ */
+using PoolTask = std::function<void(size_t workerIndex, size_t taskIndex)>;
+
+/**
+ * Fixed pool of threads that are started once and reused for many runs of tasks.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable runStarted;
+    std::condition_variable runFinished;
+
+    const PoolTask* task = nullptr;
+    size_t tasksNumber = 0;
+    size_t nextTaskIndex = 0;
+    size_t runningWorkersNumber = 0;
+    size_t runId = 0;
+    bool stopped = false;
+
+    /**
+     * Waits for runs and executes their tasks until the pool is destroyed.
+     * @param[in] workerIndex index of this worker
+     */
+    void workerLoop(size_t workerIndex);
+
+public:
+    /**
+     * Starts the given number of threads.
+     * @param[in] threadsNumber number of threads in the pool (at least 1)
+     */
+    explicit ThreadPool(size_t threadsNumber);
+
+    ThreadPool(ThreadPool& threadPool) = delete;
+    ThreadPool &operator=(const ThreadPool&) = delete;
+
+    /**
+     * Stops and joins all threads.
+     */
+    ~ThreadPool();
+
+    /**
+     * Number of threads in the pool.
+     * @return number of threads.
+     */
+    size_t size() const;
+
+    /**
+     * Runs task with indices 0, 1, ..., tasksNumber - 1 on the pool threads and waits until all of them are finished.
+     * @param[in] tasksNumber number of tasks to run
+     * @param[in] poolTask    task to run
+     */
+    void run(size_t tasksNumber, const PoolTask& poolTask);
+};
+
+#endif //POEM_SORTER_THREADPOOL_H
@@ -0,0 +1,182 @@
+/**
+ * @file
+ * @brief Source file with functions for sorting many files in one run
+ */
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include "batch.h"
+#include "line_output.h"
+#include "SortSession.h"
+
+namespace fs = std::filesystem;
+
+/**
+ * Output name for the listed file: its path without root and leading ".." components.
+ * @param[in] path path to the file
+ * @return relative output name.
+ */
+static std::string listedFileOutputName(const fs::path& path) {
+    fs::path outputName;
+    bool leading = true;
+    for (const fs::path& component : path.lexically_normal().relative_path()) {
+        if (leading && component == "..") continue;
+        leading = false;
+        outputName /= component;
+    }
+    return outputName.string();
+}
+
+/**
+ * Collects files to sort in batch mode.
+ * If the path is a directory, all regular files in it (recursively) are collected and
+ * output name of each file is its path relative to the directory.
+ * Otherwise the path is a list of files: one path per line.
+ * Output name of each listed file is its path without root and leading ".." components.
+ * @param[in]  path  path to a directory or to a list of files
+ * @param[out] files collected files
+ * @return true, if the files were collected, false if the path can't be read or listed
+ *         (unreadable subdirectories are skipped).
+ */
+bool collectBatchFiles(const char* path, std::vector<BatchFile>& files) {
+    assert(path != nullptr);
+
+    std::error_code error;
+    if (fs::is_directory(path, error)) {
+        // Unreadable subdirectories are skipped, other errors (e.g. a directory removed while it's listed) fail
+        fs::recursive_directory_iterator it(path, fs::directory_options::skip_permission_denied, error);
+        for (; !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+            if (it->is_regular_file(error)) {
+                files.push_back({ it->path().string(), it->path().lexically_relative(path).string() });
+            }
+        }
+        return !error;
+    }
+
+    std::ifstream list(path);
+    if (!list) return false;
+    std::string filePath;
+    while (std::getline(list, filePath)) {
+        if (filePath.empty()) continue;
+        files.push_back({ filePath, listedFileOutputName(filePath) });
+    }
+    return true;
+}
+
+/**
+ * Sorts the given files in parallel on the pool. Each worker reuses its SortSession and buffers for all its files.
+ * If combined is false, results of each file are written to outputDirectory/outputName/ directory
+ * (see writeSortResults). Otherwise results of all files are appended to three files in outputDirectory,
+ * results of each file are preceded by "==> inputPath <==" marker line. Order of files in combined output is not specified.
+ * Empty files are skipped: nothing is written for them.
+ * @param[in]      files           files to sort
+ * @param[in]      outputDirectory directory to write results to (created if doesn't exist)
+ * @param[in]      combined        whether results should be written to combined files
+ * @param[in]      cache           cache of sort results or nullptr
+ * @param[in, out] pool            pool to sort files on
+ * @return number of sorted, skipped and failed files.
+ */
+BatchStats sortBatch(
+        const std::vector<BatchFile>& files,
+        const char* outputDirectory,
+        bool combined,
+        const ResultCache* cache,
+        ThreadPool& pool
+) {
+    assert(outputDirectory != nullptr);
+
+    BatchStats stats;
+    std::error_code error;
+    fs::create_directories(outputDirectory, error);
+
+    static constexpr size_t COMBINED_FILES_NUMBER = 3;
+    static const char* combinedFileNames[COMBINED_FILES_NUMBER] = {
+            DIRECT_SORTED_FILE_NAME, REVERSE_SORTED_FILE_NAME, ORIGINAL_FILE_NAME
+    };
+    FILE* combinedFiles[COMBINED_FILES_NUMBER] = {};
+    std::mutex combinedFilesMutex;
+    if (combined) {
+        for (size_t i = 0; i < COMBINED_FILES_NUMBER; ++i) {
+            combinedFiles[i] = fopen((fs::path(outputDirectory) / combinedFileNames[i]).c_str(), "w");
+            if (combinedFiles[i] == nullptr) {
+                for (size_t j = 0; j < i; ++j) fclose(combinedFiles[j]);
+                stats.failedFilesNumber = files.size();
+                return stats;
+            }
+        }
+    }
+
+    std::unique_ptr<SortSession[]> sessions(new SortSession[pool.size()]);
+    std::vector<std::vector<char>> buffers(pool.size() * COMBINED_FILES_NUMBER);
+    std::atomic<size_t> sortedFilesNumber = 0;
+    std::atomic<size_t> skippedFilesNumber = 0;
+    std::atomic<size_t> failedFilesNumber = 0;
+
+    pool.run(files.size(), [&](size_t workerIndex, size_t taskIndex) {
+        const BatchFile& file = files[taskIndex];
+        SortSession& session = sessions[workerIndex];
+        std::vector<char>* workerBuffers = &buffers[workerIndex * COMBINED_FILES_NUMBER];
+
+        if (!session.loadFile(file.inputPath.c_str(), cache)) {
+            // Empty file can't be mapped, but it's not an error: it just has no lines
+            std::error_code sizeError;
+            if (fs::file_size(file.inputPath, sizeError) == 0 && !sizeError) {
+                ++skippedFilesNumber;
+            } else {
+                ++failedFilesNumber;
+            }
+            return;
+        }
+
+        bool written = true;
+        if (combined) {
+            std::string marker = "==> " + file.inputPath + " <==\n";
+            const std::vector<Line>* fileLines[COMBINED_FILES_NUMBER] = {
+                    &session.getSortedLines(SortOrder::DIRECT),
+                    &session.getSortedLines(SortOrder::REVERSE),
+                    &session.getLines(),
+            };
+            for (size_t i = 0; i < COMBINED_FILES_NUMBER; ++i) {
+                workerBuffers[i].assign(marker.begin(), marker.end());
+                appendLines(workerBuffers[i], *fileLines[i]);
+            }
+
+            std::lock_guard<std::mutex> lock(combinedFilesMutex);
+            for (size_t i = 0; i < COMBINED_FILES_NUMBER; ++i) {
+                written &= fwrite(workerBuffers[i].data(), 1, workerBuffers[i].size(), combinedFiles[i]) == workerBuffers[i].size();
+            }
+        } else {
+            fs::path fileOutputDirectory = fs::path(outputDirectory) / file.outputName;
+            std::error_code directoryError;
+            fs::create_directories(fileOutputDirectory, directoryError);
+            written = !directoryError && writeSortResults(session, fileOutputDirectory.c_str(), workerBuffers[0]);
+        }
+        session.clear();
+
+        if (written) {
+            ++sortedFilesNumber;
+        } else {
+            ++failedFilesNumber;
+        }
+    });
+
+    if (combined) {
+        bool closed = true;
+        for (FILE* combinedFile : combinedFiles) {
+            closed &= fclose(combinedFile) == 0;
+        }
+        if (!closed) {
+            sortedFilesNumber = 0;
+            skippedFilesNumber = 0;
+            failedFilesNumber = files.size();
+        }
+    }
+
+    stats.sortedFilesNumber = sortedFilesNumber;
+    stats.skippedFilesNumber = skippedFilesNumber;
+    stats.failedFilesNumber = failedFilesNumber;
+    return stats;
+}
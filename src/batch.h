@@ -0,0 +1,64 @@
+/**
+ * @file
+ * @brief Header file with functions for sorting many files in one run
+ */
+#ifndef POEM_SORTER_BATCH_H
+#define POEM_SORTER_BATCH_H
+
+#include <string>
+#include <vector>
+#include "ResultCache.h"
+#include "ThreadPool.h"
+
+/**
+ * File that is sorted in batch mode.
+ */
+struct BatchFile {
+    std::string inputPath;  /**< path to the file to sort */
+    std::string outputName; /**< relative path of the output directory for this file */
+};
+
+/**
+ * Statistics of the batch run.
+ */
+struct BatchStats {
+    size_t sortedFilesNumber = 0;  /**< number of files that were sorted and written */
+    size_t skippedFilesNumber = 0; /**< number of empty files, they have nothing to sort */
+    size_t failedFilesNumber = 0;  /**< number of files that couldn't be loaded or written */
+};
+
+/**
+ * Collects files to sort in batch mode.
+ * If the path is a directory, all regular files in it (recursively) are collected and
+ * output name of each file is its path relative to the directory.
+ * Otherwise the path is a list of files: one path per line.
+ * Output name of each listed file is its path without root and leading ".." components.
+ * @param[in]  path  path to a directory or to a list of files
+ * @param[out] files collected files
+ * @return true, if the files were collected, false if the path can't be read or listed
+ *         (unreadable subdirectories are skipped).
+ */
+bool collectBatchFiles(const char* path, std::vector<BatchFile>& files);
+
+/**
+ * Sorts the given files in parallel on the pool. Each worker reuses its SortSession and buffers for all its files.
+ * If combined is false, results of each file are written to outputDirectory/outputName/ directory
+ * (see writeSortResults). Otherwise results of all files are appended to three files in outputDirectory,
+ * results of each file are preceded by "==> inputPath <==" marker line. Order of files in combined output is not specified.
+ * Empty files are skipped: nothing is written for them.
+ * @param[in]      files           files to sort
+ * @param[in]      outputDirectory directory to write results to (created if doesn't exist)
+ * @param[in]      combined        whether results should be written to combined files
+ * @param[in]      cache           cache of sort results or nullptr
+ * @param[in, out] pool            pool to sort files on
+ * @return number of sorted, skipped and failed files.
+ */
+BatchStats sortBatch(
+        const std::vector<BatchFile>& files,
+        const char* outputDirectory,
+        bool combined,
+        const ResultCache* cache,
+        ThreadPool& pool
+);
+
+#endif //POEM_SORTER_BATCH_H
@@ -0,0 +1,166 @@
+/**
+ * @file
+ * @brief Source file with collation tables: which UTF-8 characters are letters and how they are ordered
+ *
+ * Collation is defined by the ordered lists of letter groups. All letters of a group get the same code (the number
+ * of the group counting from 1), letters of a group are pairs of an uppercase letter and its lowercase letter.
+ * Tables are built by constexpr functions, so they are compiled into the binary and invalid definitions
+ * don't compile.
+ */
+#include <cassert>
+#include <cstring>
+#include "collation.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+// Alphabets
+//----------------------------------------------------------------------------------------------------------------------
+
+/** English letters. **/
+static constexpr const char* LATIN_GROUPS[] = {
+        "Aa", "Bb", "Cc", "Dd", "Ee", "Ff", "Gg", "Hh", "Ii", "Jj", "Kk", "Ll", "Mm",
+        "Nn", "Oo", "Pp", "Qq", "Rr", "Ss", "Tt", "Uu", "Vv", "Ww", "Xx", "Yy", "Zz",
+};
+
+/** English letters with accented latin letters (Latin-1 and Latin Extended-A), which are equal to their base letters. **/
+static constexpr const char* ACCENTED_LATIN_GROUPS[] = {
+        "AaÀàÁáÂâÃãÄäÅåĀāĂăĄą", "Bb", "CcÇçĆćĈĉĊċČč", "DdĎďĐđ", "EeÈèÉéÊêËëĒēĔĕĖėĘęĚě", "Ff", "GgĜĝĞğĠġĢģ",
+        "HhĤĥĦħ", "IiÌìÍíÎîÏïĨĩĪīĬĭĮį", "JjĴĵ", "KkĶķ", "LlĹĺĻļĽľĿŀŁł", "Mm", "NnÑñŃńŅņŇň",
+        "OoÒòÓóÔôÕõÖöØøŌōŎŏŐő", "Pp", "Qq", "RrŔŕŖŗŘř", "SsŚśŜŝŞşŠš", "TtŢţŤťŦŧ", "UuÙùÚúÛûÜüŨũŪūŬŭŮůŰűŲų", "Vv",
+        "WwŴŵ", "Xx", "YyÝýŸÿŶŷ", "ZzŹźŻżŽž",
+};
+
+/** Russian letters. **/
+static constexpr const char* RUSSIAN_GROUPS[] = {
+        "Аа", "Бб", "Вв", "Гг", "Дд", "Ее", "Ёё", "Жж", "Зз", "Ии", "Йй", "Кк", "Лл", "Мм", "Нн", "Оо", "Пп",
+        "Рр", "Сс", "Тт", "Уу", "Фф", "Хх", "Цц", "Чч", "Шш", "Щщ", "Ъъ", "Ыы", "Ьь", "Ээ", "Юю", "Яя",
+};
+
+/** Ukrainian letters. **/
+static constexpr const char* UKRAINIAN_GROUPS[] = {
+        "Аа", "Бб", "Вв", "Гг", "Ґґ", "Дд", "Ее", "Єє", "Жж", "Зз", "Ии", "Іі", "Її", "Йй", "Кк", "Лл", "Мм",
+        "Нн", "Оо", "Пп", "Рр", "Сс", "Тт", "Уу", "Фф", "Хх", "Цц", "Чч", "Шш", "Щщ", "Ьь", "Юю", "Яя",
+};
+
+/** Belarusian letters. **/
+static constexpr const char* BELARUSIAN_GROUPS[] = {
+        "Аа", "Бб", "Вв", "Гг", "Дд", "Ее", "Ёё", "Жж", "Зз", "Іі", "Йй", "Кк", "Лл", "Мм", "Нн", "Оо",
+        "Пп", "Рр", "Сс", "Тт", "Уу", "Ўў", "Фф", "Хх", "Цц", "Чч", "Шш", "Ыы", "Ьь", "Ээ", "Юю", "Яя",
+};
+
+/** Russian, ukrainian and belarusian letters in one order that keeps the order of each alphabet. **/
+static constexpr const char* CYRILLIC_GROUPS[] = {
+        "Аа", "Бб", "Вв", "Гг", "Ґґ", "Дд", "Ее", "Ёё", "Єє", "Жж", "Зз", "Ии", "Іі", "Її", "Йй", "Кк", "Лл", "Мм", "Нн",
+        "Оо", "Пп", "Рр", "Сс", "Тт", "Уу", "Ўў", "Фф", "Хх", "Цц", "Чч", "Шш", "Щщ", "Ъъ", "Ыы", "Ьь", "Ээ", "Юю", "Яя",
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// Tables
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Adds letter groups to the collation table. Codes of the groups are consecutive, starting from the given one.
+ * @param[in, out] table        collation table
+ * @param[in]      groups       letter groups (pairs of uppercase and lowercase letters, see the file description)
+ * @param[in]      groupsNumber number of letter groups
+ * @param[in]      firstCode    code of the first group
+ */
+static constexpr void addLetterGroups(
+        CollationTable& table,
+        const char* const* groups,
+        size_t groupsNumber,
+        size_t firstCode
+) {
+    // Codes are one byte, 255 is reserved for patterns (see PATTERN_ANY_SEQUENCE)
+    assert(firstCode > 0 && firstCode + groupsNumber <= 255);
+
+    for (size_t group = 0; group < groupsNumber; ++group) {
+        bool upper = true;
+        for (const char* ptr = groups[group]; *ptr != '\0'; upper = !upper) {
+            unsigned char first = *ptr;
+            CollationLetter* letter = nullptr;
+            if (first < 128) {
+                letter = &table.asciiLetters[first];
+                ++ptr;
+            } else {
+                unsigned char second = *(ptr + 1);
+                assert(first >= COLLATION_FIRST_LEAD_BYTE && first < COLLATION_FIRST_LEAD_BYTE + COLLATION_LEAD_BYTES);
+                assert((second & 0xC0) == 0x80);
+                letter = &table.twoByteLetters[first - COLLATION_FIRST_LEAD_BYTE][second - 0x80];
+                ptr += 2;
+            }
+            assert(letter->code == 0); // Each letter belongs to one group
+            letter->code = firstCode + group;
+            letter->upper = upper;
+        }
+        assert(upper); // Each uppercase letter has its lowercase letter
+    }
+}
+
+/**
+ * Builds the collation table of latin letters followed by letters of another alphabet.
+ * @param[in] name   name of the collation
+ * @param[in] latin  groups of latin letters
+ * @param[in] others groups of letters of the other alphabet
+ * @return collation table.
+ */
+template <size_t LatinGroupsNumber, size_t OtherGroupsNumber>
+static constexpr CollationTable buildCollationTable(
+        const char* name,
+        const char* const (&latin)[LatinGroupsNumber],
+        const char* const (&others)[OtherGroupsNumber]
+) {
+    CollationTable table;
+    table.name = name;
+    addLetterGroups(table, latin, LatinGroupsNumber, 1);
+    addLetterGroups(table, others, OtherGroupsNumber, 1 + LatinGroupsNumber);
+    return table;
+}
+
+/**
+ * Checks that ASCII letters of the table are exactly the english ones (vectorized kernels rely on it).
+ * @param[in] table collation table
+ * @return true, if ASCII letters are english letters, false otherwise.
+ */
+static constexpr bool hasEnglishAsciiLetters(const CollationTable& table) {
+    for (unsigned char c = 0; c < 128; ++c) {
+        bool upper = c >= 'A' && c <= 'Z';
+        bool lower = c >= 'a' && c <= 'z';
+        const CollationLetter& letter = table.asciiLetters[c];
+        if ((letter.code != 0) != (upper || lower) || letter.upper != upper) return false;
+    }
+    return true;
+}
+
+/** Default collation table (english letters have codes 1 - 26, russian letters have codes 27 - 59). **/
+constexpr CollationTable DEFAULT_COLLATION_TABLE =
+        buildCollationTable(DEFAULT_COLLATION_NAME, LATIN_GROUPS, RUSSIAN_GROUPS);
+
+static constexpr CollationTable UKRAINIAN_COLLATION_TABLE = buildCollationTable("en-uk", LATIN_GROUPS, UKRAINIAN_GROUPS);
+static constexpr CollationTable BELARUSIAN_COLLATION_TABLE = buildCollationTable("en-be", LATIN_GROUPS, BELARUSIAN_GROUPS);
+static constexpr CollationTable MULTI_COLLATION_TABLE = buildCollationTable("multi", ACCENTED_LATIN_GROUPS, CYRILLIC_GROUPS);
+
+static_assert(hasEnglishAsciiLetters(DEFAULT_COLLATION_TABLE));
+static_assert(hasEnglishAsciiLetters(UKRAINIAN_COLLATION_TABLE));
+static_assert(hasEnglishAsciiLetters(BELARUSIAN_COLLATION_TABLE));
+static_assert(hasEnglishAsciiLetters(MULTI_COLLATION_TABLE));
+
+/** Built-in collation tables. **/
+static const CollationTable* const COLLATION_TABLES[] = {
+        &DEFAULT_COLLATION_TABLE, &UKRAINIAN_COLLATION_TABLE, &BELARUSIAN_COLLATION_TABLE, &MULTI_COLLATION_TABLE,
+};
+
+/**
+ * Finds the built-in collation table by its name: "en-ru" (default), "en-uk" (english and ukrainian), "en-be"
+ * (english and belarusian) or "multi" (latin with accented letters equal to their base letters,
+ * and all russian, ukrainian and belarusian letters).
+ * @param[in] name name of the collation
+ * @return collation table or nullptr, if there is no collation with the given name.
+ */
+const CollationTable* findCollationTable(const char* name) {
+    assert(name != nullptr);
+
+    for (const CollationTable* table : COLLATION_TABLES) {
+        if (strcmp(table->name, name) == 0) return table;
+    }
+    return nullptr;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file
+ * @brief Header file with collation tables: which UTF-8 characters are letters and how they are ordered
+ *
+ * Collations are defined by lists of letter groups (see collation.cpp) and compiled into flat lookup tables
+ * at build time, so classifying a letter and getting its collation code takes one table lookup.
+ * Letters are ASCII characters or 2-byte UTF-8 sequences (U+0080 - U+07FF: accented Latin, Greek, Cyrillic).
+ */
+#ifndef POEM_SORTER_COLLATION_H
+#define POEM_SORTER_COLLATION_H
+
+#include <cstddef>
+
+/** First lead byte of 2-byte UTF-8 sequences. **/
+#define COLLATION_FIRST_LEAD_BYTE 0xC0
+/** Number of lead bytes of 2-byte UTF-8 sequences (0xC0 - 0xDF). **/
+#define COLLATION_LEAD_BYTES 32
+/** Number of continuation bytes of UTF-8 sequences (0x80 - 0xBF). **/
+#define COLLATION_CONTINUATION_BYTES 64
+/** Name of the default collation: english and russian letters. **/
+#define DEFAULT_COLLATION_NAME "en-ru"
+
+/**
+ * Letter of the collation table.
+ */
+struct CollationLetter {
+    unsigned char code = 0; /**< collation code of the letter (1 - 254), 0 if the character is not a letter */
+    bool upper = false;     /**< whether the letter is uppercase */
+};
+
+/**
+ * Collation table. Letters with equal codes are equal in comparisons (e.g. lowercase and uppercase letters).
+ * ASCII letters are the english ones in every collation, so vectorized kernels can find them without the table.
+ */
+struct CollationTable {
+    const char* name = nullptr;        /**< name of the collation */
+    CollationLetter asciiLetters[128]; /**< letters indexed by the ASCII byte */
+    /** Letters of 2-byte sequences, indexed by the lead byte - 0xC0 and by the continuation byte - 0x80. */
+    CollationLetter twoByteLetters[COLLATION_LEAD_BYTES][COLLATION_CONTINUATION_BYTES];
+};
+
+/**
+ * Gives the letter of the collation table that starts with the given byte pair.
+ * @param[in] table  collation table
+ * @param[in] first  first byte of the pair
+ * @param[in] second second byte of the pair
+ * @return letter, if the first byte is an ASCII letter or the pair is a 2-byte letter, not a letter (zero code) otherwise.
+ */
+inline CollationLetter getCollationLetter(const CollationTable& table, unsigned char first, unsigned char second) {
+    if (first < 128) return table.asciiLetters[first];
+    if (first >= COLLATION_FIRST_LEAD_BYTE && first < COLLATION_FIRST_LEAD_BYTE + COLLATION_LEAD_BYTES
+        && (second & 0xC0) == 0x80) {
+        return table.twoByteLetters[first - COLLATION_FIRST_LEAD_BYTE][second - 0x80];
+    }
+    return {};
+}
+
+/**
+ * Finds the built-in collation table by its name: "en-ru" (default), "en-uk" (english and ukrainian), "en-be"
+ * (english and belarusian) or "multi" (latin with accented letters equal to their base letters,
+ * and all russian, ukrainian and belarusian letters).
+ * @param[in] name name of the collation
+ * @return collation table or nullptr, if there is no collation with the given name.
+ */
+const CollationTable* findCollationTable(const char* name);
+
+/** Default collation table (english letters have codes 1 - 26, russian letters have codes 27 - 59). **/
+extern const CollationTable DEFAULT_COLLATION_TABLE;
+
+#endif //POEM_SORTER_COLLATION_H
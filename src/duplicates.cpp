@@ -0,0 +1,71 @@
+/**
+ * @file
+ * @brief Source file with functions for collapsing duplicate lines
+ */
+#include <algorithm>
+#include <cassert>
+#include "duplicates.h"
+#include "hash.h"
+#include "sortlib.h"
+
+/**
+ * Hashes the normalized letter sequence of the line: collation codes of its letters (see getAlphaCode) in direct order.
+ * Lines that are equal in compareLinesDirect have equal hashes.
+ * @param[in]      line  line to hash
+ * @param[in, out] codes buffer for the letter codes (reused between calls)
+ * @return hash of the letters of the line.
+ */
+uint64_t hashLineLetters(const Line& line, std::vector<unsigned char>& codes) {
+    codes.clear();
+    appendAlphaCodes(line, codes);
+    return hashBytes(codes.data(), codes.size());
+}
+
+/**
+ * Collapses duplicate lines in linear time: hashes of the normalized letter sequences are put in an open-addressing
+ * hash table, lines with equal hashes are checked with compareLinesDirect.
+ * @param[in]  lines    lines to collapse
+ * @param[out] distinct distinct lines in order of their first occurrence
+ */
+void collapseDuplicates(const std::vector<Line>& lines, DistinctLines& distinct) {
+    Arena scratch;
+    collapseDuplicates(lines, distinct, scratch);
+}
+
+/**
+ * Collapses duplicate lines like collapseDuplicates, taking the hash table and the hashes from the given arena,
+ * so repeated calls (e.g. for many texts) don't allocate them again.
+ * @param[in]      lines    lines to collapse
+ * @param[out]     distinct distinct lines in order of their first occurrence
+ * @param[in, out] scratch  arena for the temporary buffers (they are not released)
+ */
+void collapseDuplicates(const std::vector<Line>& lines, DistinctLines& distinct, Arena& scratch) {
+    static constexpr size_t EMPTY_SLOT = SIZE_MAX;
+
+    size_t capacity = 16;
+    while (capacity < 2 * lines.size()) capacity *= 2;
+    scratch.reserve(capacity * sizeof(size_t) + lines.size() * sizeof(uint64_t));
+    size_t* slots = scratch.allocate<size_t>(capacity); // Indices of the distinct lines
+    std::fill(slots, slots + capacity, EMPTY_SLOT);
+    uint64_t* hashes = scratch.allocate<uint64_t>(lines.size());
+    std::vector<unsigned char> codes;
+
+    distinct.lineIndices.clear();
+    distinct.counts.clear();
+    for (size_t i = 0; i < lines.size(); ++i) {
+        uint64_t hash = hashLineLetters(lines[i], codes);
+
+        size_t slot = hash & (capacity - 1);
+        while (slots[slot] != EMPTY_SLOT
+               && (hashes[slots[slot]] != hash || compareLinesDirect(lines[distinct.lineIndices[slots[slot]]], lines[i]) != 0)) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (slots[slot] == EMPTY_SLOT) {
+            slots[slot] = distinct.lineIndices.size();
+            hashes[slots[slot]] = hash;
+            distinct.lineIndices.push_back(i);
+            distinct.counts.push_back(0);
+        }
+        ++distinct.counts[slots[slot]];
+    }
+}
@@ -0,0 +1,49 @@
+/**
+ * @file
+ * @brief Header file with functions for collapsing duplicate lines
+ */
+#ifndef POEM_SORTER_DUPLICATES_H
+#define POEM_SORTER_DUPLICATES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Arena.h"
+#include "text_helpers.h"
+
+/**
+ * Distinct lines of the text: lines that are equal in compareLinesDirect (i.e. have the same letters,
+ * regardless of case, punctuation and spaces) are collapsed into one.
+ */
+struct DistinctLines {
+    std::vector<size_t> lineIndices; /**< index of the first occurrence of each distinct line, ascending */
+    std::vector<size_t> counts;      /**< number of occurrences of each distinct line */
+};
+
+/**
+ * Hashes the normalized letter sequence of the line: collation codes of its letters (see getAlphaCode) in direct order.
+ * Lines that are equal in compareLinesDirect have equal hashes.
+ * @param[in]      line  line to hash
+ * @param[in, out] codes buffer for the letter codes (reused between calls)
+ * @return hash of the letters of the line.
+ */
+uint64_t hashLineLetters(const Line& line, std::vector<unsigned char>& codes);
+
+/**
+ * Collapses duplicate lines in linear time: hashes of the normalized letter sequences are put in an open-addressing
+ * hash table, lines with equal hashes are checked with compareLinesDirect.
+ * @param[in]  lines    lines to collapse
+ * @param[out] distinct distinct lines in order of their first occurrence
+ */
+void collapseDuplicates(const std::vector<Line>& lines, DistinctLines& distinct);
+
+/**
+ * Collapses duplicate lines like collapseDuplicates, taking the hash table and the hashes from the given arena,
+ * so repeated calls (e.g. for many texts) don't allocate them again.
+ * @param[in]      lines    lines to collapse
+ * @param[out]     distinct distinct lines in order of their first occurrence
+ * @param[in, out] scratch  arena for the temporary buffers (they are not released)
+ */
+void collapseDuplicates(const std::vector<Line>& lines, DistinctLines& distinct, Arena& scratch);
+
+#endif //POEM_SORTER_DUPLICATES_H
@@ -0,0 +1,96 @@
+/**
+ * @file
+ * @brief Source file with functions for sorting lines by key fields (words)
+ */
+#include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include "fields.h"
+
+/**
+ * Checks whether the key field is set.
+ * @param[in] field key field
+ * @return true, if the key field is set, false otherwise.
+ */
+bool isKeyFieldSet(const KeyField& field) {
+    return field.firstWord != 0;
+}
+
+/**
+ * Parses non-zero word number.
+ * @param[in]  str    string to parse
+ * @param[out] end    pointer to the first character after the number
+ * @param[out] result parsed number
+ * @return true, if the number is valid, false otherwise.
+ */
+static bool parseWordNumber(const char* str, char*& end, int& result) {
+    errno = 0;
+    long number = strtol(str, &end, 10);
+    if (end == str || errno != 0 || number == 0 || number < INT_MIN || number > INT_MAX) return false;
+    result = number;
+    return true;
+}
+
+/**
+ * Parses the key field specification: "N" (from word N to the end of the line) or "N,M" (from word N to word M).
+ * @param[in]  spec  key field specification
+ * @param[out] field parsed key field
+ * @return true, if the specification is valid, false otherwise.
+ */
+bool parseKeyField(const char* spec, KeyField& field) {
+    assert(spec != nullptr);
+
+    KeyField parsed;
+    char* end = nullptr;
+    if (!parseWordNumber(spec, end, parsed.firstWord)) return false;
+    if (*end == ',' && !parseWordNumber(end + 1, end, parsed.lastWord)) return false;
+    if (*end != '\0') return false;
+
+    field = parsed;
+    return true;
+}
+
+/**
+ * Converts the word number of the key field to the index of the word in the line.
+ * @param[in] wordNumber  word number (from 1, or negative from the end)
+ * @param[in] wordsNumber number of words in the line
+ * @return index of the word (may be out of range [0; wordsNumber)).
+ */
+static long getWordIndex(int wordNumber, size_t wordsNumber) {
+    return wordNumber > 0 ? wordNumber - 1L : static_cast<long>(wordsNumber) + wordNumber;
+}
+
+/**
+ * Builds the key of each line: span from the start of its first key word to the end of its last key word.
+ * If the line doesn't have the key words, its key is empty (it's less than any other key).
+ * @param[in]  lines lines split with word boundaries
+ * @param[in]  words word boundaries of the lines
+ * @param[in]  field key field (must be set)
+ * @param[out] keys  key of each line
+ */
+void buildKeyFields(const std::vector<Line>& lines, const WordTable& words, const KeyField& field, std::vector<Line>& keys) {
+    assert(isKeyFieldSet(field));
+    assert(words.lineWordStarts.size() == lines.size() + 1);
+
+    keys.clear();
+    keys.reserve(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        size_t firstLineWord = words.lineWordStarts[i];
+        size_t wordsNumber = words.lineWordStarts[i + 1] - firstLineWord;
+
+        long first = getWordIndex(field.firstWord, wordsNumber);
+        long last = getWordIndex(field.lastWord, wordsNumber);
+        if (first < 0) first = 0;
+        if (last >= static_cast<long>(wordsNumber)) last = static_cast<long>(wordsNumber) - 1;
+        if (first > last) {
+            // Empty span right after the line
+            keys.emplace_back(lines[i].lineEnd + 1, lines[i].lineEnd);
+            continue;
+        }
+
+        const char* keyStart = lines[i].lineStart + words.wordBounds[2 * (firstLineWord + first)];
+        const char* keyEnd = lines[i].lineStart + words.wordBounds[2 * (firstLineWord + last) + 1] - 1;
+        keys.emplace_back(keyStart, keyEnd);
+    }
+}
@@ -0,0 +1,46 @@
+/**
+ * @file
+ * @brief Header file with functions for sorting lines by key fields (words)
+ */
+#ifndef POEM_SORTER_FIELDS_H
+#define POEM_SORTER_FIELDS_H
+
+#include <cstddef>
+#include <vector>
+#include "text_helpers.h"
+
+/**
+ * Key field of the lines: words from firstWord to lastWord (inclusive).
+ * Words are numbered from 1; negative numbers count words from the end of the line (-1 is the last word).
+ */
+struct KeyField {
+    int firstWord = 0; /**< first word of the key, 0 if the key field is not set */
+    int lastWord = -1; /**< last word of the key, the last word of the line by default */
+};
+
+/**
+ * Checks whether the key field is set.
+ * @param[in] field key field
+ * @return true, if the key field is set, false otherwise.
+ */
+bool isKeyFieldSet(const KeyField& field);
+
+/**
+ * Parses the key field specification: "N" (from word N to the end of the line) or "N,M" (from word N to word M).
+ * @param[in]  spec  key field specification
+ * @param[out] field parsed key field
+ * @return true, if the specification is valid, false otherwise.
+ */
+bool parseKeyField(const char* spec, KeyField& field);
+
+/**
+ * Builds the key of each line: span from the start of its first key word to the end of its last key word.
+ * If the line doesn't have the key words, its key is empty (it's less than any other key).
+ * @param[in]  lines lines split with word boundaries
+ * @param[in]  words word boundaries of the lines
+ * @param[in]  field key field (must be set)
+ * @param[out] keys  key of each line
+ */
+void buildKeyFields(const std::vector<Line>& lines, const WordTable& words, const KeyField& field, std::vector<Line>& keys);
+
+#endif //POEM_SORTER_FIELDS_H
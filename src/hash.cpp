@@ -0,0 +1,105 @@
+/**
+ * @file
+ * @brief Source file with fast non-cryptographic hash function
+ */
+#include <cassert>
+#include <cstring>
+#include "hash.h"
+
+static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr uint64_t PRIME3 = 0x165667B19E3779F9ull;
+static constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+static constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+static inline uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t read64(const unsigned char* ptr) {
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+static inline uint32_t read32(const unsigned char* ptr) {
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+static inline uint64_t round(uint64_t accumulator, uint64_t input) {
+    accumulator += input * PRIME2;
+    accumulator = rotateLeft(accumulator, 31);
+    return accumulator * PRIME1;
+}
+
+static inline uint64_t mergeRound(uint64_t accumulator, uint64_t value) {
+    accumulator ^= round(0, value);
+    return accumulator * PRIME1 + PRIME4;
+}
+
+/**
+ * Computes 64-bit hash of the given bytes. Algorithm is XXH64 (results are equal to the reference implementation).
+ * Hash is fast (works at memory bandwidth on large inputs), but it's not cryptographic.
+ * @param[in] data pointer to the bytes to hash
+ * @param[in] size number of bytes to hash
+ * @param[in] seed seed of the hash
+ * @return 64-bit hash.
+ */
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed) {
+    assert(data != nullptr || size == 0);
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "hash is implemented for little-endian platforms only");
+
+    const unsigned char* ptr = static_cast<const unsigned char*>(data);
+    const unsigned char* end = ptr + size;
+    uint64_t hash;
+
+    if (size >= 32) {
+        uint64_t v1 = seed + PRIME1 + PRIME2;
+        uint64_t v2 = seed + PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME1;
+        const unsigned char* limit = end - 32;
+        do {
+            v1 = round(v1, read64(ptr));
+            v2 = round(v2, read64(ptr + 8));
+            v3 = round(v3, read64(ptr + 16));
+            v4 = round(v4, read64(ptr + 24));
+            ptr += 32;
+        } while (ptr <= limit);
+
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    } else {
+        hash = seed + PRIME5;
+    }
+
+    hash += size;
+
+    while (ptr + 8 <= end) {
+        hash ^= round(0, read64(ptr));
+        hash = rotateLeft(hash, 27) * PRIME1 + PRIME4;
+        ptr += 8;
+    }
+    if (ptr + 4 <= end) {
+        hash ^= read32(ptr) * PRIME1;
+        hash = rotateLeft(hash, 23) * PRIME2 + PRIME3;
+        ptr += 4;
+    }
+    while (ptr < end) {
+        hash ^= *ptr * PRIME5;
+        hash = rotateLeft(hash, 11) * PRIME1;
+        ++ptr;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
@@ -0,0 +1,21 @@
+/**
+ * @file
+ * @brief Header file with fast non-cryptographic hash function
+ */
+#ifndef POEM_SORTER_HASH_H
+#define POEM_SORTER_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Computes 64-bit hash of the given bytes. Algorithm is XXH64 (results are equal to the reference implementation).
+ * Hash is fast (works at memory bandwidth on large inputs), but it's not cryptographic.
+ * @param[in] data pointer to the bytes to hash
+ * @param[in] size number of bytes to hash
+ * @param[in] seed seed of the hash
+ * @return 64-bit hash.
+ */
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+#endif //POEM_SORTER_HASH_H
@@ -0,0 +1,130 @@
+/**
+ * @file
+ * @brief Source file with filters of lines that are applied while the text is split
+ */
+#include <cassert>
+#include <cstring>
+#include <string_view>
+#include "line_filter.h"
+
+/**
+ * Checks whether any check of the filter is set.
+ * @param[in] filter filter of the lines
+ * @return true, if the filter is set, false if it keeps all lines.
+ */
+bool isLineFilterSet(const LineFilter& filter) {
+    return !filter.substring.empty()
+        || filter.minLetters > 0
+        || filter.maxLetters != SIZE_MAX
+        || filter.capital
+        || !filter.pattern.empty();
+}
+
+/**
+ * Compiles the pattern of letters. Pattern consists of letters (case is ignored), '.' (any letter) and
+ * '*' (any sequence of letters). Pattern is matched against letters of the line only (punctuation and spaces
+ * are skipped), anywhere in the line. '^' at the start and '$' at the end anchor it to the start and to the end of the line.
+ * @param[in]  pattern pattern to compile
+ * @param[out] codes   compiled pattern: collation codes of letters (see getAlphaCode), PATTERN_ANY_LETTER and
+ *                     PATTERN_ANY_SEQUENCE
+ * @return true, if the pattern is valid, false otherwise.
+ */
+bool parseLetterPattern(const char* pattern, std::vector<unsigned char>& codes) {
+    assert(pattern != nullptr);
+
+    const char* ptr = pattern;
+    const char* end = pattern + strlen(pattern);
+    bool anchoredStart = ptr < end && *ptr == '^';
+    bool anchoredEnd = end > ptr + anchoredStart && *(end - 1) == '$';
+    if (anchoredStart) ++ptr;
+    if (anchoredEnd) --end;
+    if (ptr == end) return false;
+
+    std::vector<unsigned char> compiled;
+    if (!anchoredStart) compiled.push_back(PATTERN_ANY_SEQUENCE);
+    while (ptr < end) {
+        unsigned short alphaSize = getAlphaSizeDirect(*ptr, ptr + 1 < end ? *(ptr + 1) : '\0');
+        if (alphaSize != 0) {
+            compiled.push_back(getAlphaCode(ptr, alphaSize));
+            ptr += alphaSize;
+        } else if (*ptr == '.') {
+            compiled.push_back(PATTERN_ANY_LETTER);
+            ++ptr;
+        } else if (*ptr == '*') {
+            compiled.push_back(PATTERN_ANY_SEQUENCE);
+            ++ptr;
+        } else {
+            return false;
+        }
+    }
+    if (!anchoredEnd) compiled.push_back(PATTERN_ANY_SEQUENCE);
+
+    codes = compiled;
+    return true;
+}
+
+/**
+ * Checks whether the collation codes of letters of the line match the compiled pattern.
+ * @param[in] pattern compiled pattern (see parseLetterPattern)
+ * @param[in] codes   collation codes of letters of the line
+ * @return true, if the letters match the pattern, false otherwise.
+ */
+bool matchesLetterPattern(const std::vector<unsigned char>& pattern, const std::vector<unsigned char>& codes) {
+    // Greedy wildcard matching: on mismatch, the last '*' takes one more letter
+    size_t patternIndex = 0;
+    size_t codeIndex = 0;
+    size_t lastSequence = SIZE_MAX;
+    size_t lastSequenceCode = 0;
+    while (codeIndex < codes.size()) {
+        if (patternIndex < pattern.size() && pattern[patternIndex] == PATTERN_ANY_SEQUENCE) {
+            lastSequence = patternIndex++;
+            lastSequenceCode = codeIndex;
+        } else if (patternIndex < pattern.size()
+                   && (pattern[patternIndex] == PATTERN_ANY_LETTER || pattern[patternIndex] == codes[codeIndex])) {
+            ++patternIndex;
+            ++codeIndex;
+        } else if (lastSequence != SIZE_MAX) {
+            patternIndex = lastSequence + 1;
+            codeIndex = ++lastSequenceCode;
+        } else {
+            return false;
+        }
+    }
+
+    while (patternIndex < pattern.size() && pattern[patternIndex] == PATTERN_ANY_SEQUENCE) ++patternIndex;
+    return patternIndex == pattern.size();
+}
+
+/**
+ * Checks whether the line passes the filter.
+ * @param[in]      filter        filter of the lines
+ * @param[in]      line          line to check
+ * @param[in]      lettersNumber number of letters in the line
+ * @param[in]      capital       whether the first letter of the line is uppercase
+ * @param[in, out] codes         buffer for collation codes of letters (reused between calls)
+ * @return true, if the line should be kept, false otherwise.
+ */
+bool passesLineFilter(
+        const LineFilter& filter,
+        const Line& line,
+        size_t lettersNumber,
+        bool capital,
+        std::vector<unsigned char>& codes
+) {
+    // Cheap checks go first, the pattern needs one more pass over the line
+    if (lettersNumber < filter.minLetters || lettersNumber > filter.maxLetters) return false;
+    if (filter.capital && !capital) return false;
+
+    if (!filter.substring.empty()) {
+        std::string_view lineView(line.lineStart, line.lineEnd - line.lineStart + 1);
+        if (lineView.find(filter.substring) == std::string_view::npos) return false;
+    }
+
+    if (!filter.pattern.empty()) {
+        codes.clear();
+        appendAlphaCodes(line, codes);
+        if (!matchesLetterPattern(filter.pattern, codes)) return false;
+    }
+
+    return true;
+}
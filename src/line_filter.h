@@ -0,0 +1,75 @@
+/**
+ * @file
+ * @brief Header file with filters of lines that are applied while the text is split
+ */
+#ifndef POEM_SORTER_LINE_FILTER_H
+#define POEM_SORTER_LINE_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "text_helpers.h"
+
+/** Code of the pattern element that matches any letter. **/
+#define PATTERN_ANY_LETTER 0
+/** Code of the pattern element that matches any sequence of letters (including empty one). **/
+#define PATTERN_ANY_SEQUENCE 255
+
+/**
+ * Filter of the lines. Line is kept only if it passes all the set checks.
+ * Checks of letters are evaluated while the text is split (see splitLines), so filtered out lines never get
+ * to the line table.
+ */
+struct LineFilter {
+    std::string substring;              /**< bytes that the line must contain, empty if not checked */
+    size_t minLetters = 0;              /**< minimum number of letters in the line */
+    size_t maxLetters = SIZE_MAX;       /**< maximum number of letters in the line */
+    bool capital = false;               /**< whether the first letter of the line must be uppercase */
+    std::vector<unsigned char> pattern; /**< compiled pattern of letters (see parseLetterPattern), empty if not checked */
+};
+
+/**
+ * Checks whether any check of the filter is set.
+ * @param[in] filter filter of the lines
+ * @return true, if the filter is set, false if it keeps all lines.
+ */
+bool isLineFilterSet(const LineFilter& filter);
+
+/**
+ * Compiles the pattern of letters. Pattern consists of letters (case is ignored), '.' (any letter) and
+ * '*' (any sequence of letters). Pattern is matched against letters of the line only (punctuation and spaces
+ * are skipped), anywhere in the line. '^' at the start and '$' at the end anchor it to the start and to the end of the line.
+ * @param[in]  pattern pattern to compile
+ * @param[out] codes   compiled pattern: collation codes of letters (see getAlphaCode), PATTERN_ANY_LETTER and
+ *                     PATTERN_ANY_SEQUENCE
+ * @return true, if the pattern is valid, false otherwise.
+ */
+bool parseLetterPattern(const char* pattern, std::vector<unsigned char>& codes);
+
+/**
+ * Checks whether the collation codes of letters of the line match the compiled pattern.
+ * @param[in] pattern compiled pattern (see parseLetterPattern)
+ * @param[in] codes   collation codes of letters of the line
+ * @return true, if the letters match the pattern, false otherwise.
+ */
+bool matchesLetterPattern(const std::vector<unsigned char>& pattern, const std::vector<unsigned char>& codes);
+
+/**
+ * Checks whether the line passes the filter.
+ * @param[in]      filter        filter of the lines
+ * @param[in]      line          line to check
+ * @param[in]      lettersNumber number of letters in the line
+ * @param[in]      capital       whether the first letter of the line is uppercase
+ * @param[in, out] codes         buffer for collation codes of letters (reused between calls)
+ * @return true, if the line should be kept, false otherwise.
+ */
+bool passesLineFilter(
+        const LineFilter& filter,
+        const Line& line,
+        size_t lettersNumber,
+        bool capital,
+        std::vector<unsigned char>& codes
+);
+
+#endif //POEM_SORTER_LINE_FILTER_H
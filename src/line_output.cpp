@@ -0,0 +1,232 @@
+/**
+ * @file
+ * @brief Source file with functions for writing lines to files
+ */
+#include <cassert>
+#include <charconv>
+#include <cstdio>
+#include <string>
+#include "line_output.h"
+
+/**
+ * Appends lines to the given buffer. Each line is followed by '\\n'.
+ * @param[in, out] buffer buffer to append lines to
+ * @param[in]      lines  lines to append
+ */
+void appendLines(std::vector<char>& buffer, const std::vector<Line>& lines) {
+    for (auto [start, end] : lines) {
+        buffer.insert(buffer.end(), start, end + 1);
+        buffer.push_back('\n');
+    }
+}
+
+/**
+ * Appends the number and '\\t' to the given buffer.
+ * @param[in, out] buffer buffer to append the number to
+ * @param[in]      number number to append
+ */
+static void appendNumberField(std::vector<char>& buffer, size_t number) {
+    char numberString[24];
+    char* numberEnd = std::to_chars(numberString, numberString + sizeof(numberString), number).ptr;
+    buffer.insert(buffer.end(), numberString, numberEnd);
+    buffer.push_back('\t');
+}
+
+/**
+ * Appends the line with its count to the given buffer: count, '\\t', number of the first occurrence, '\\t',
+ * line and '\\n'.
+ * @param[in, out] buffer     buffer to append the line to
+ * @param[in]      line       line to append
+ * @param[in]      count      count of the line
+ * @param[in]      lineNumber number of the text line of the first occurrence of the line
+ */
+static void appendCountedLine(std::vector<char>& buffer, const Line& line, size_t count, size_t lineNumber) {
+    appendNumberField(buffer, count);
+    appendNumberField(buffer, lineNumber);
+    buffer.insert(buffer.end(), line.lineStart, line.lineEnd + 1);
+    buffer.push_back('\n');
+}
+
+/**
+ * Appends lines in the order of the permutation with their counts to the given buffer.
+ * Each line is preceded by its count, '\\t', number of its first occurrence and '\\t', and followed by '\\n'.
+ * @param[in, out] buffer      buffer to append lines to
+ * @param[in]      lines       lines to append
+ * @param[in]      counts      count of each line
+ * @param[in]      lineNumbers number of the text line of the first occurrence of each line
+ * @param[in]      permutation indices of the lines in order they should be appended
+ */
+void appendCountedLines(
+        std::vector<char>& buffer,
+        const std::vector<Line>& lines,
+        const std::vector<size_t>& counts,
+        const std::vector<size_t>& lineNumbers,
+        const std::vector<size_t>& permutation
+) {
+    assert(counts.size() == lines.size());
+    assert(lineNumbers.size() == lines.size());
+
+    for (size_t index : permutation) {
+        appendCountedLine(buffer, lines[index], counts[index], lineNumbers[index]);
+    }
+}
+
+/**
+ * Appends lines with their counts to the given buffer.
+ * Each line is preceded by its count, '\\t', number of its first occurrence and '\\t', and followed by '\\n'.
+ * @param[in, out] buffer      buffer to append lines to
+ * @param[in]      lines       lines to append
+ * @param[in]      counts      count of each line
+ * @param[in]      lineNumbers number of the text line of the first occurrence of each line
+ */
+void appendCountedLines(
+        std::vector<char>& buffer,
+        const std::vector<Line>& lines,
+        const std::vector<size_t>& counts,
+        const std::vector<size_t>& lineNumbers
+) {
+    assert(counts.size() == lines.size());
+    assert(lineNumbers.size() == lines.size());
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        appendCountedLine(buffer, lines[i], counts[i], lineNumbers[i]);
+    }
+}
+
+/**
+ * Appends lines grouped by rhyme to the given buffer. Each line is followed by '\\n', groups are separated by empty lines.
+ * @param[in, out] buffer buffer to append lines to
+ * @param[in]      lines  lines that are referenced by the groups
+ * @param[in]      groups lines grouped by rhyme
+ */
+void appendRhymeGroups(std::vector<char>& buffer, const std::vector<Line>& lines, const RhymeGroups& groups) {
+    for (size_t group = 0; group + 1 < groups.groupStarts.size(); ++group) {
+        if (group > 0) buffer.push_back('\n');
+        for (size_t i = groups.groupStarts[group]; i < groups.groupStarts[group + 1]; ++i) {
+            auto [start, end] = lines[groups.lineIndices[i]];
+            buffer.insert(buffer.end(), start, end + 1);
+            buffer.push_back('\n');
+        }
+    }
+}
+
+/**
+ * Appends lines of the loaded text sorted in the given order to the given buffer.
+ * @param[in, out] buffer     buffer to append lines to
+ * @param[in, out] session    session with loaded text
+ * @param[in]      order      order to sort the lines in
+ * @param[in]      withCounts whether lines are preceded by their counts (see appendCountedLines)
+ */
+void appendSortedLines(std::vector<char>& buffer, SortSession& session, SortOrder order, bool withCounts) {
+    if (withCounts) {
+        appendCountedLines(
+                buffer, session.getLines(), session.getLineCounts(), session.getLineNumbers(),
+                session.getSortedPermutation(order)
+        );
+    } else {
+        appendLines(buffer, session.getSortedLines(order));
+    }
+}
+
+/**
+ * Writes the given buffer to the opened stream (e.g. stdout) and flushes it.
+ * @param[in] buffer buffer to write
+ * @param[in] stream stream to write the buffer to
+ * @return true, if the buffer was written, false otherwise.
+ */
+bool writeBuffer(const std::vector<char>& buffer, FILE* stream) {
+    assert(stream != nullptr);
+
+    bool written = fwrite(buffer.data(), 1, buffer.size(), stream) == buffer.size();
+    return (fflush(stream) == 0) && written;
+}
+
+/**
+ * Writes the given buffer to the file. File is truncated, if it exists.
+ * @param[in] buffer   buffer to write
+ * @param[in] fileName name of the file to write the buffer to
+ * @return true, if the buffer was written, false otherwise.
+ */
+bool writeBuffer(const std::vector<char>& buffer, const char* fileName) {
+    assert(fileName != nullptr);
+
+    FILE* file = fopen(fileName, "w");
+    if (file == nullptr) return false;
+
+    bool written = writeBuffer(buffer, file);
+    return (fclose(file) == 0) && written;
+}
+
+/**
+ * Writes lines to the given file. Each line is followed by '\\n'.
+ * @param[in] lines    lines to write
+ * @param[in] fileName name of the file to write the lines in
+ * @return true, if the lines were written, false otherwise.
+ */
+bool writeLines(const std::vector<Line>& lines, const char* fileName) {
+    assert(fileName != nullptr);
+
+    std::vector<char> buffer;
+    appendLines(buffer, lines);
+    return writeBuffer(buffer, fileName);
+}
+
+/**
+ * Writes lines of the loaded text sorted in the given order to the file.
+ * @param[in, out] session    session with loaded text
+ * @param[in]      order      order to sort the lines in
+ * @param[in]      filePath   path to the file to write the lines to
+ * @param[in, out] buffer     buffer that is used to prepare file content
+ * @param[in]      withCounts whether lines are preceded by their counts
+ * @return true, if the lines were written, false otherwise.
+ */
+static bool writeSortedLines(
+        SortSession& session,
+        SortOrder order,
+        const std::string& filePath,
+        std::vector<char>& buffer,
+        bool withCounts
+) {
+    buffer.clear();
+    appendSortedLines(buffer, session, order, withCounts);
+    return writeBuffer(buffer, filePath.c_str());
+}
+
+/**
+ * Writes lines of the loaded text sorted in direct order, in reverse order and in original order
+ * to DIRECT_SORTED_FILE_NAME, REVERSE_SORTED_FILE_NAME and ORIGINAL_FILE_NAME files in the given directory.
+ * If the composite order is set in the session, lines sorted in it are written to COMPOSITE_SORTED_FILE_NAME
+ * instead of direct and reverse orders.
+ * @param[in, out] session    session with loaded text
+ * @param[in]      directory  directory to write files to (must exist)
+ * @param[in, out] buffer     buffer that is used to prepare files content
+ * @param[in]      withCounts whether lines are preceded by their counts (duplicates must be collapsed in the session,
+ *                            see SortSession::collapseDuplicateLines)
+ * @return true, if all files were written, false otherwise.
+ */
+bool writeSortResults(SortSession& session, const char* directory, std::vector<char>& buffer, bool withCounts) {
+    assert(directory != nullptr);
+
+    std::string prefix = std::string(directory) + '/';
+    bool written = true;
+
+    const std::vector<size_t>& counts = session.getLineCounts();
+    assert(!withCounts || counts.size() == session.getLines().size());
+
+    if (!session.getSortKeys().empty()) {
+        written &= writeSortedLines(session, SortOrder::COMPOSITE, prefix + COMPOSITE_SORTED_FILE_NAME, buffer, withCounts);
+    } else {
+        written &= writeSortedLines(session, SortOrder::DIRECT, prefix + DIRECT_SORTED_FILE_NAME, buffer, withCounts);
+        written &= writeSortedLines(session, SortOrder::REVERSE, prefix + REVERSE_SORTED_FILE_NAME, buffer, withCounts);
+    }
+
+    buffer.clear();
+    if (withCounts) {
+        appendCountedLines(buffer, session.getLines(), counts, session.getLineNumbers());
+    } else {
+        appendLines(buffer, session.getLines());
+    }
+    written &= writeBuffer(buffer, (prefix + ORIGINAL_FILE_NAME).c_str());
+
+    return written;
+}
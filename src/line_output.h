@@ -0,0 +1,119 @@
+/**
+ * @file
+ * @brief Header file with functions for writing lines to files
+ */
+#ifndef POEM_SORTER_LINE_OUTPUT_H
+#define POEM_SORTER_LINE_OUTPUT_H
+
+#include <cstdio>
+#include <vector>
+#include "rhymes.h"
+#include "SortSession.h"
+#include "text_helpers.h"
+
+/** Name of the file with lines sorted in direct order. **/
+#define DIRECT_SORTED_FILE_NAME "direct_sorted.txt"
+/** Name of the file with lines sorted in reverse order. **/
+#define REVERSE_SORTED_FILE_NAME "reverse_sorted.txt"
+/** Name of the file with lines sorted in composite order. **/
+#define COMPOSITE_SORTED_FILE_NAME "composite_sorted.txt"
+/** Name of the file with original lines. **/
+#define ORIGINAL_FILE_NAME "original.txt"
+/** Name of the file with lines grouped by rhyme. **/
+#define RHYME_GROUPS_FILE_NAME "rhyme_groups.txt"
+
+/**
+ * Appends lines to the given buffer. Each line is followed by '\\n'.
+ * @param[in, out] buffer buffer to append lines to
+ * @param[in]      lines  lines to append
+ */
+void appendLines(std::vector<char>& buffer, const std::vector<Line>& lines);
+
+/**
+ * Appends lines in the order of the permutation with their counts to the given buffer.
+ * Each line is preceded by its count, '\\t', number of its first occurrence and '\\t', and followed by '\\n'.
+ * @param[in, out] buffer      buffer to append lines to
+ * @param[in]      lines       lines to append
+ * @param[in]      counts      count of each line
+ * @param[in]      lineNumbers number of the text line of the first occurrence of each line
+ * @param[in]      permutation indices of the lines in order they should be appended
+ */
+void appendCountedLines(
+        std::vector<char>& buffer,
+        const std::vector<Line>& lines,
+        const std::vector<size_t>& counts,
+        const std::vector<size_t>& lineNumbers,
+        const std::vector<size_t>& permutation
+);
+
+/**
+ * Appends lines with their counts to the given buffer.
+ * Each line is preceded by its count, '\\t', number of its first occurrence and '\\t', and followed by '\\n'.
+ * @param[in, out] buffer      buffer to append lines to
+ * @param[in]      lines       lines to append
+ * @param[in]      counts      count of each line
+ * @param[in]      lineNumbers number of the text line of the first occurrence of each line
+ */
+void appendCountedLines(
+        std::vector<char>& buffer,
+        const std::vector<Line>& lines,
+        const std::vector<size_t>& counts,
+        const std::vector<size_t>& lineNumbers
+);
+
+/**
+ * Appends lines grouped by rhyme to the given buffer. Each line is followed by '\\n', groups are separated by empty lines.
+ * @param[in, out] buffer buffer to append lines to
+ * @param[in]      lines  lines that are referenced by the groups
+ * @param[in]      groups lines grouped by rhyme
+ */
+void appendRhymeGroups(std::vector<char>& buffer, const std::vector<Line>& lines, const RhymeGroups& groups);
+
+/**
+ * Appends lines of the loaded text sorted in the given order to the given buffer.
+ * @param[in, out] buffer     buffer to append lines to
+ * @param[in, out] session    session with loaded text
+ * @param[in]      order      order to sort the lines in
+ * @param[in]      withCounts whether lines are preceded by their counts (see appendCountedLines)
+ */
+void appendSortedLines(std::vector<char>& buffer, SortSession& session, SortOrder order, bool withCounts);
+
+/**
+ * Writes the given buffer to the opened stream (e.g. stdout) and flushes it.
+ * @param[in] buffer buffer to write
+ * @param[in] stream stream to write the buffer to
+ * @return true, if the buffer was written, false otherwise.
+ */
+bool writeBuffer(const std::vector<char>& buffer, FILE* stream);
+
+/**
+ * Writes the given buffer to the file. File is truncated, if it exists.
+ * @param[in] buffer   buffer to write
+ * @param[in] fileName name of the file to write the buffer to
+ * @return true, if the buffer was written, false otherwise.
+ */
+bool writeBuffer(const std::vector<char>& buffer, const char* fileName);
+
+/**
+ * Writes lines to the given file. Each line is followed by '\\n'.
+ * @param[in] lines    lines to write
+ * @param[in] fileName name of the file to write the lines in
+ * @return true, if the lines were written, false otherwise.
+ */
+bool writeLines(const std::vector<Line>& lines, const char* fileName);
+
+/**
+ * Writes lines of the loaded text sorted in direct order, in reverse order and in original order
+ * to DIRECT_SORTED_FILE_NAME, REVERSE_SORTED_FILE_NAME and ORIGINAL_FILE_NAME files in the given directory.
+ * If the composite order is set in the session, lines sorted in it are written to COMPOSITE_SORTED_FILE_NAME
+ * instead of direct and reverse orders.
+ * @param[in, out] session    session with loaded text
+ * @param[in]      directory  directory to write files to (must exist)
+ * @param[in, out] buffer     buffer that is used to prepare files content
+ * @param[in]      withCounts whether lines are preceded by their counts (duplicates must be collapsed in the session,
+ *                            see SortSession::collapseDuplicateLines)
+ * @return true, if all files were written, false otherwise.
+ */
+bool writeSortResults(SortSession& session, const char* directory, std::vector<char>& buffer, bool withCounts = false);
+
+#endif //POEM_SORTER_LINE_OUTPUT_H
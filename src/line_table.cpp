@@ -0,0 +1,89 @@
+/**
+ * @file
+ * @brief Source file with the column-oriented table of lines and their metadata
+ */
+#include <cassert>
+#include "line_table.h"
+#include "sortlib.h"
+
+/**
+ * Builds the table of the lines in one pass over each line. Vectors of the table are reused.
+ * @param[in]  text  pointer to the text start (lines point into it)
+ * @param[in]  lines lines of the text in original order
+ * @param[out] table table of the lines
+ * @return true, if the table was built, false if the lines don't fit in its columns (more than UINT32_MAX lines
+ *         or a line longer than UINT32_MAX bytes).
+ */
+bool buildLineTable(const char* text, const std::vector<Line>& lines, LineTable& table) {
+    assert(text != nullptr || lines.empty());
+
+    if (lines.size() > UINT32_MAX) return false;
+
+    table.text = text;
+    table.offsets.resize(lines.size());
+    table.lengths.resize(lines.size());
+    table.letterCounts.resize(lines.size());
+    table.prefixKeys.resize(lines.size());
+    table.suffixKeys.resize(lines.size());
+    table.originalIndices.resize(lines.size());
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const Line& line = lines[i];
+        size_t length = line.lineEnd - line.lineStart + 1;
+        if (length > UINT32_MAX) return false;
+
+        // Prefix key is filled from the highest byte, the last letters are shifted through the lowest byte
+        size_t lettersNumber = 0;
+        uint64_t prefixKey = 0;
+        uint64_t lastLetters = 0;
+        const char* ptr = line.lineStart;
+        unsigned short alphaSize = 0;
+        while ((alphaSize = seekAlphaDirect(ptr, line.lineEnd)) != 0 && ptr <= line.lineEnd) {
+            uint64_t code = getAlphaCode(ptr, alphaSize);
+            if (lettersNumber < LINE_TABLE_KEY_LETTERS) {
+                prefixKey |= code << (8 * (LINE_TABLE_KEY_LETTERS - 1 - lettersNumber));
+            }
+            lastLetters = (lastLetters << 8) | code;
+            ++lettersNumber;
+            ptr += alphaSize;
+        }
+
+        table.offsets[i] = line.lineStart - text;
+        table.lengths[i] = length;
+        table.letterCounts[i] = lettersNumber > UINT32_MAX ? UINT32_MAX : lettersNumber;
+        table.prefixKeys[i] = prefixKey;
+        // The last letter moves from the lowest byte to the highest one, padding moves to the lowest bytes
+        table.suffixKeys[i] = __builtin_bswap64(lastLetters);
+        table.originalIndices[i] = i;
+    }
+    return true;
+}
+
+/**
+ * Compares two lines of the table by the given key. Keys of the table decide most comparisons,
+ * the text is compared (see compareLinesDirect and compareLinesReverse) only if both keys are equal
+ * and the lines are longer than them.
+ * @param[in] table  table of the lines
+ * @param[in] index1 index of the first line
+ * @param[in] index2 index of the second line
+ * @param[in] key    key to compare by
+ * @return negative number, if first line is less than second; <br>
+ *         positive number, if first line is greater than second; <br>
+ *         zero,            if both lines are equal by the key.
+ */
+int compareTableLines(const LineTable& table, size_t index1, size_t index2, SortKey key) {
+    uint32_t letters1 = table.letterCounts[index1];
+    uint32_t letters2 = table.letterCounts[index2];
+    if (key == SortKey::LENGTH) return letters1 < letters2 ? -1 : (letters1 > letters2 ? +1 : 0);
+
+    const std::vector<uint64_t>& keys = key == SortKey::DIRECT ? table.prefixKeys : table.suffixKeys;
+    uint64_t key1 = keys[index1];
+    uint64_t key2 = keys[index2];
+    if (key1 != key2) return key1 < key2 ? -1 : +1;
+    // Equal keys of short lines hold all their letters (letter codes are not zero, so the counts are equal too)
+    if (letters1 <= LINE_TABLE_KEY_LETTERS && letters2 <= LINE_TABLE_KEY_LETTERS) return 0;
+
+    int (*compare)(const Line&, const Line&) = compareLinesReverse;
+    if (key == SortKey::DIRECT) compare = compareLinesDirect;
+    return compare(getTableLine(table, index1), getTableLine(table, index2));
+}
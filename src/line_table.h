@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @brief Header file with the column-oriented table of lines and their metadata
+ */
+#ifndef POEM_SORTER_LINE_TABLE_H
+#define POEM_SORTER_LINE_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "sort_keys.h"
+#include "text_helpers.h"
+
+/** Number of letters that are packed into the prefix and suffix keys of the line (one byte per letter). **/
+#define LINE_TABLE_KEY_LETTERS 8
+
+/**
+ * Lines of the text with their metadata, stored column by column (structure of arrays), so code that needs
+ * one property of many lines (e.g. sorting by the prefix key) reads only one compact column.
+ * All columns have one element per line, lines are referenced by their indices.
+ *
+ * Prefix key of the line packs collation codes (see getAlphaCode) of its first LINE_TABLE_KEY_LETTERS letters,
+ * the first letter in the highest byte. Suffix key packs its last LINE_TABLE_KEY_LETTERS letters, the last letter
+ * in the highest byte (the same as getRhymeKey). Lines with less letters are padded with zero bytes, so keys are
+ * ordered the same way as the lines are in compareLinesDirect and compareLinesReverse, as far as the keys go.
+ */
+struct LineTable {
+    const char* text = nullptr;             /**< text that the offsets are counted from */
+    std::vector<uint64_t> offsets;          /**< offset of the first character of each line from the text start */
+    std::vector<uint32_t> lengths;          /**< length of each line in bytes */
+    std::vector<uint32_t> letterCounts;     /**< number of letters in each line */
+    std::vector<uint64_t> prefixKeys;       /**< keys of the first letters of each line */
+    std::vector<uint64_t> suffixKeys;       /**< keys of the last letters of each line */
+    std::vector<uint32_t> originalIndices;  /**< index of each line in the original order, it orders equal lines */
+};
+
+/**
+ * Builds the table of the lines in one pass over each line. Vectors of the table are reused.
+ * @param[in]  text  pointer to the text start (lines point into it)
+ * @param[in]  lines lines of the text in original order
+ * @param[out] table table of the lines
+ * @return true, if the table was built, false if the lines don't fit in its columns (more than UINT32_MAX lines
+ *         or a line longer than UINT32_MAX bytes).
+ */
+bool buildLineTable(const char* text, const std::vector<Line>& lines, LineTable& table);
+
+/**
+ * Line of the table.
+ * @param[in] table table of the lines
+ * @param[in] index index of the line
+ * @return line that points into the text of the table.
+ */
+inline Line getTableLine(const LineTable& table, size_t index) {
+    const char* lineStart = table.text + table.offsets[index];
+    return { lineStart, lineStart + table.lengths[index] - 1 };
+}
+
+/**
+ * Compares two lines of the table by the given key. Keys of the table decide most comparisons,
+ * the text is compared (see compareLinesDirect and compareLinesReverse) only if both keys are equal
+ * and the lines are longer than them.
+ * @param[in] table  table of the lines
+ * @param[in] index1 index of the first line
+ * @param[in] index2 index of the second line
+ * @param[in] key    key to compare by
+ * @return negative number, if first line is less than second; <br>
+ *         positive number, if first line is greater than second; <br>
+ *         zero,            if both lines are equal by the key.
+ */
+int compareTableLines(const LineTable& table, size_t index1, size_t index2, SortKey key);
+
+#endif //POEM_SORTER_LINE_TABLE_H
@@ -1,61 +1,395 @@
 /**
  * @file
  */
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <csignal>
+#include <filesystem>
 #include <iostream>
+#include <memory>
 #include <vector>
-#include "MappedFile.h"
-#include "sortlib.h"
-#include "text_helpers.h"
+#include "batch.h"
+#include "FileWatcher.h"
+#include "line_output.h"
+#include "rhymes.h"
+#include "RhymeIndex.h"
+#include "SorterOptions.h"
+#include "SortServer.h"
+#include "SortSession.h"
+#include "sorted_index.h"
+#include "text_kernels.h"
+
+namespace fs = std::filesystem;
+
+/** Interval in milliseconds without changes after which changed files are re-sorted in watch mode. **/
+static constexpr int WATCH_DEBOUNCE_MS = 50;
+
+/** Whether watch mode was stopped by SIGINT or SIGTERM. **/
+static volatile sig_atomic_t watchStopped = 0;
 
 /**
- * Writes lines to the given file.
- * @param[in] lines    lines to write
- * @param[in] fileName name of the file to write the lines in
+ * Prints the number of invalid UTF-8 bytes that were replaced in the loaded text to stderr, if there are any.
+ * @param[in] session  session with loaded file
+ * @param[in] filePath path to the file
  */
-void writeLines(const std::vector<Line>& lines, const char* fileName) {
-    assert(fileName != nullptr);
+static void reportNormalization(const SortSession& session, const char* filePath) {
+    const NormalizationStats& stats = session.getNormalizationStats();
+    if (stats.invalidBytes == 0) return;
 
-    FILE* file = fopen(fileName, "w");
-    for (auto [start, _] : lines) {
-        fprintf(file, "%s\n", start);
+    fprintf(
+            stderr, "%s: %zu invalid UTF-8 bytes replaced, first at byte %zu\n",
+            filePath, stats.invalidBytes, stats.firstInvalidOffset
+    );
+}
+
+/**
+ * Loads the file in the session according to the options (incrementally, with the cache or plainly).
+ * Key field, composite order, normalization and collapsing of duplicate lines are applied, if they are requested.
+ * @param[in, out] session  session to load the file to
+ * @param[in]      filePath path to the file
+ * @param[in]      options  sorter options
+ * @param[in]      cache    cache of sort results or nullptr
+ * @return true, if the file was loaded, false otherwise.
+ */
+static bool loadSessionFile(
+        SortSession& session,
+        const char* filePath,
+        const SorterOptions& options,
+        const ResultCache* cache
+) {
+    session.setKeyField(options.keyField);
+    session.setLineFilter(options.lineFilter);
+    session.setSortKeys(options.sortKeys);
+    session.setHeadLines(options.headLines);
+    session.setContentHashing(options.indexOutput);
+    session.setLineNumbering(options.countLines);
+    session.setMappingHints(options.mappingHints);
+    session.setTextNormalization(options.textNormalization);
+    bool loaded = options.incremental ? session.loadFileIncremental(filePath) : session.loadFile(filePath, cache);
+    if (loaded) reportNormalization(session, filePath);
+    if (loaded && options.uniqueLines) session.collapseDuplicateLines();
+    return loaded;
+}
+
+/**
+ * Writes results of the loaded session: lines sorted in direct (or composite) order to stdout, if it's requested,
+ * sorted index (see SortSession::saveSortedIndex) to the directory, if it's requested, or sorted lines
+ * to the directory (see writeSortResults) otherwise.
+ * @param[in, out] session   session with loaded file
+ * @param[in]      directory directory to write results to
+ * @param[in, out] buffer    buffer that is used to prepare files content
+ * @param[in]      options   sorter options
+ * @return true, if the results were written, false otherwise.
+ */
+static bool writeSessionResults(
+        SortSession& session,
+        const char* directory,
+        std::vector<char>& buffer,
+        const SorterOptions& options
+) {
+    if (options.standardOutput) {
+        buffer.clear();
+        SortOrder order = session.getSortKeys().empty() ? SortOrder::DIRECT : SortOrder::COMPOSITE;
+        appendSortedLines(buffer, session, order, options.countLines);
+        return writeBuffer(buffer, stdout);
+    }
+    if (options.indexOutput) {
+        return session.saveSortedIndex((fs::path(directory) / SORTED_INDEX_FILE_NAME).c_str());
     }
-    fclose(file);
+    return writeSortResults(session, directory, buffer, options.countLines);
+}
+
+/**
+ * Sorts one file (or the standard input) and writes direct_sorted.txt, reverse_sorted.txt and original.txt
+ * (or sorted_index.bin with --perm-out) to the current directory, or sorted lines to stdout with --stdout.
+ * @param[in] options sorter options
+ * @return exit code of the program.
+ */
+int sortFile(const SorterOptions& options) {
+    std::unique_ptr<ResultCache> cache;
+    if (options.cacheDirectory != nullptr) {
+        cache = std::make_unique<ResultCache>(options.cacheDirectory);
+    }
+
+    SortSession session;
+    if (!loadSessionFile(session, options.filePath, options, cache.get())) {
+        fprintf(stderr, "Invalid file");
+        return -1;
+    }
+
+    std::vector<char> buffer;
+    if (!writeSessionResults(session, ".", buffer, options)) {
+        fprintf(stderr, "Can't write results\n");
+        return -1;
+    }
+
+    return 0;
 }
 
 /**
- * Writes the text lines sorted in direct order to the given file.
- * @param[in] lines    lines to sort and write
- * @param[in] fileName name of the file to write the lines in
+ * Groups lines of one file by rhyme and writes them to rhyme_groups.txt in the current directory (or to stdout with --stdout).
+ * @param[in] options sorter options
+ * @return exit code of the program.
  */
-void writeSortedDirect(std::vector<Line> lines, const char* fileName) {
-    assert(fileName != nullptr);
+int groupFileByRhyme(const SorterOptions& options) {
+    SortSession session;
+    session.setTextNormalization(options.textNormalization);
+    if (!session.loadFile(options.filePath)) {
+        fprintf(stderr, "Invalid file");
+        return -1;
+    }
+    reportNormalization(session, options.filePath);
 
-    sortLines(lines.begin(), lines.end(), compareLinesDirect);
-    writeLines(lines, fileName);
+    RhymeGroups groups;
+    groupByRhyme(session.getLines(), options.rhymeLetters, groups);
+
+    std::vector<char> buffer;
+    appendRhymeGroups(buffer, session.getLines(), groups);
+    bool written = options.standardOutput ? writeBuffer(buffer, stdout) : writeBuffer(buffer, RHYME_GROUPS_FILE_NAME);
+    if (!written) {
+        fprintf(stderr, "Can't write results\n");
+        return -1;
+    }
+
+    return 0;
 }
 
 /**
- * Writes the text lines sorted in reverse order to the given file.
- * @param[in] lines    lines to sort and write
- * @param[in] fileName name of the file to write the lines in
+ * Prints lines of the file that end with the given letters to stdout. Rhyme index of the file is built if needed.
+ * @param[in] options sorter options
+ * @return exit code of the program.
  */
-void writeSortedReverse(std::vector<Line> lines, const char* fileName) {
-    assert(fileName != nullptr);
+int queryRhymeIndex(const SorterOptions& options) {
+    RhymeIndex index;
+    if (!index.open(options.filePath)) {
+        fprintf(stderr, "Invalid file");
+        return -1;
+    }
+
+    std::vector<Line> lines;
+    index.query(options.queryEnding, lines);
 
-    sortLines(lines.begin(), lines.end(), compareLinesReverse);
-    writeLines(lines, fileName);
+    std::vector<char> buffer;
+    appendLines(buffer, lines);
+    fwrite(buffer.data(), 1, buffer.size(), stdout);
+
+    return 0;
 }
 
 /**
- * Writes the original file lines to a given file.
- * @param[in] lines    lines of the original file
- * @param[in] fileName name of the file to write the lines in
+ * Detects rhyme schemes of the stanzas of the file (or of all files of the directory in parallel) and prints one
+ * record per file to stdout: path to the file and schemes of its stanzas separated by a tab (see detectRhymeSchemes).
+ * Records are printed in order of the file paths.
+ * @param[in] options sorter options
+ * @return exit code of the program.
  */
-void writeOriginal(const std::vector<Line>& lines, const char* fileName) {
-    assert(fileName != nullptr);
+int printRhymeSchemes(const SorterOptions& options) {
+    std::vector<BatchFile> files;
+    std::error_code error;
+    if (!fs::is_directory(options.filePath, error)) {
+        files.push_back({ options.filePath, "" });
+    } else if (!collectBatchFiles(options.filePath, files)) {
+        fprintf(stderr, "Can't read %s\n", options.filePath);
+        return -1;
+    }
+    // Files are listed in directory order, they are sorted so the output doesn't depend on the file system
+    std::sort(files.begin(), files.end(), [](const BatchFile& first, const BatchFile& second) {
+        return first.inputPath < second.inputPath;
+    });
+
+    unsigned int lettersNumber = options.rhymeLetters != 0 ? options.rhymeLetters : DEFAULT_SCHEME_RHYME_LETTERS;
+    ThreadPool pool(getThreadsNumber(options));
+    std::unique_ptr<SortSession[]> sessions(new SortSession[pool.size()]);
+    std::vector<std::string> schemes(pool.size());
+    std::vector<std::string> records(files.size());
+    std::atomic<size_t> failedFilesNumber = 0;
+    pool.run(files.size(), [&](size_t workerIndex, size_t taskIndex) {
+        SortSession& session = sessions[workerIndex];
+        const std::string& filePath = files[taskIndex].inputPath;
+        session.setTextNormalization(options.textNormalization);
+        if (!session.loadFile(filePath.c_str())) {
+            ++failedFilesNumber;
+            return;
+        }
+        reportNormalization(session, filePath.c_str());
+
+        detectRhymeSchemes(session.getLines(), lettersNumber, schemes[workerIndex]);
+        records[taskIndex] = filePath + '\t' + schemes[workerIndex] + '\n';
+        session.clear();
+    });
 
-    writeLines(lines, fileName);
+    for (const std::string& record : records) {
+        fwrite(record.data(), 1, record.size(), stdout);
+    }
+    if (failedFilesNumber != 0) fprintf(stderr, "%zu files failed\n", failedFilesNumber.load());
+
+    return failedFilesNumber == 0 ? 0 : -1;
+}
+
+/**
+ * Sorts all files of the directory or the list in parallel and writes results to the output directory.
+ * @param[in] options sorter options
+ * @return exit code of the program.
+ */
+int sortBatchFiles(const SorterOptions& options) {
+    std::vector<BatchFile> files;
+    if (!collectBatchFiles(options.batchPath, files)) {
+        fprintf(stderr, "Can't read %s\n", options.batchPath);
+        return -1;
+    }
+
+    std::unique_ptr<ResultCache> cache;
+    if (options.cacheDirectory != nullptr) {
+        cache = std::make_unique<ResultCache>(options.cacheDirectory);
+    }
+
+    ThreadPool pool(getThreadsNumber(options));
+    BatchStats stats = sortBatch(files, options.outputDirectory, options.combinedOutput, cache.get(), pool);
+    fprintf(
+            stderr, "%zu files sorted, %zu empty files skipped, %zu files failed\n",
+            stats.sortedFilesNumber, stats.skippedFilesNumber, stats.failedFilesNumber
+    );
+
+    return stats.failedFilesNumber == 0 ? 0 : -1;
+}
+
+/**
+ * Runs the sort server until SIGINT or SIGTERM is received. Latency statistics is printed on exit.
+ * @param[in] options sorter options
+ * @return exit code of the program.
+ */
+int serve(const SorterOptions& options) {
+    // Signals are blocked before workers are started, so only the main thread receives them in sigwait
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    SortServer server;
+    uint64_t maxPayloadSize = options.maxPayloadMb != 0 ? uint64_t(options.maxPayloadMb) << 20 : DEFAULT_MAX_PAYLOAD_SIZE;
+    if (!server.start(options.servePath, getThreadsNumber(options), maxPayloadSize)) {
+        fprintf(stderr, "Can't listen on %s\n", options.servePath);
+        return -1;
+    }
+
+    int signal = 0;
+    sigwait(&signals, &signal);
+
+    server.stop();
+    fprintf(stderr, "%s", server.getStats().c_str());
+    return 0;
+}
+
+/**
+ * Sorts the file in watch mode and writes its results to the output directory (to the relative path of the file
+ * in its subdirectory, if a directory is watched).
+ * @param[in, out] session          session to sort the file in
+ * @param[in, out] buffer           buffer that is used to prepare files content
+ * @param[in]      filePath         path to the file
+ * @param[in]      watchedDirectory whether a directory is watched
+ * @param[in]      options          sorter options
+ * @param[in]      cache            cache of sort results or nullptr
+ * @return true, if the file was sorted and written, false otherwise.
+ */
+static bool sortWatchedFile(
+        SortSession& session,
+        std::vector<char>& buffer,
+        const std::string& filePath,
+        bool watchedDirectory,
+        const SorterOptions& options,
+        const ResultCache* cache
+) {
+    fs::path fileOutputDirectory = options.outputDirectory;
+    if (watchedDirectory) fileOutputDirectory /= fs::path(filePath).lexically_relative(options.watchPath);
+    std::error_code error;
+    fs::create_directories(fileOutputDirectory, error);
+
+    bool sorted = loadSessionFile(session, filePath.c_str(), options, cache)
+            && writeSessionResults(session, fileOutputDirectory.c_str(), buffer, options);
+    session.clear();
+    return sorted;
+}
+
+/**
+ * Sorts the file (or all files of the directory) once, then watches it and re-sorts each file when it's changed.
+ * Results are written as in single file mode (for a file) or batch mode (for a directory) to the output directory.
+ * Runs until SIGINT or SIGTERM is received.
+ * @param[in] options sorter options
+ * @return exit code of the program.
+ */
+int watchFiles(const SorterOptions& options) {
+    std::error_code error;
+    bool watchedDirectory = fs::is_directory(options.watchPath, error);
+    fs::create_directories(options.outputDirectory, error);
+
+    FileWatcher watcher;
+    bool watched = watchedDirectory ? watcher.watchDirectory(options.watchPath) : watcher.watchFile(options.watchPath);
+    if (!watched) {
+        fprintf(stderr, "Can't watch %s\n", options.watchPath);
+        return -1;
+    }
+
+    std::unique_ptr<ResultCache> cache;
+    if (options.cacheDirectory != nullptr) {
+        cache = std::make_unique<ResultCache>(options.cacheDirectory);
+    }
+
+    std::vector<BatchFile> files;
+    if (watchedDirectory) {
+        collectBatchFiles(options.watchPath, files);
+        std::erase_if(files, [&options](const BatchFile& file) {
+            return !isWatchInput(
+                    file.inputPath.c_str(), options.watchPath, options.outputDirectory, options.cacheDirectory
+            );
+        });
+    } else {
+        files.push_back({ options.watchPath, "" });
+    }
+
+    // Handlers are installed before the first sort, so it can be stopped cleanly too
+    struct sigaction stopAction = {};
+    stopAction.sa_handler = [](int) { watchStopped = 1; };
+    sigaction(SIGINT, &stopAction, nullptr);
+    sigaction(SIGTERM, &stopAction, nullptr);
+
+    // Sessions and buffers are reused for all changes, so re-sorting a file doesn't allocate in steady state
+    ThreadPool pool(getThreadsNumber(options));
+    std::unique_ptr<SortSession[]> sessions(new SortSession[pool.size()]);
+    std::vector<std::vector<char>> buffers(pool.size());
+    std::atomic<size_t> failedFilesNumber = 0;
+    std::atomic<size_t> skippedFilesNumber = 0;
+    pool.run(files.size(), [&](size_t workerIndex, size_t taskIndex) {
+        if (watchStopped) {
+            ++skippedFilesNumber;
+            return;
+        }
+        if (!sortWatchedFile(
+                sessions[workerIndex], buffers[workerIndex], files[taskIndex].inputPath,
+                watchedDirectory, options, cache.get()
+        )) {
+            ++failedFilesNumber;
+        }
+    });
+    fprintf(
+            stderr, "%zu files sorted, %zu files failed\n",
+            files.size() - failedFilesNumber - skippedFilesNumber, failedFilesNumber.load()
+    );
+
+    std::vector<std::string> changedPaths;
+    while (!watchStopped && watcher.waitForChanges(changedPaths, WATCH_DEBOUNCE_MS)) {
+        for (const std::string& changedPath : changedPaths) {
+            if (!isWatchInput(changedPath.c_str(), options.watchPath, options.outputDirectory, options.cacheDirectory)) {
+                continue;
+            }
+
+            bool sorted = sortWatchedFile(sessions[0], buffers[0], changedPath, watchedDirectory, options, cache.get());
+            fprintf(stderr, "%s %s\n", sorted ? "sorted" : "failed", changedPath.c_str());
+        }
+    }
+
+    return watchStopped ? 0 : -1;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -66,19 +400,36 @@ int main(int argc, char* argv[]) {
         return -1;
     }
 
-    const char* filePath = argv[1];
-    MappedFile mappedFile(filePath);
-    if (mappedFile.getTextPtr() == nullptr) {
-        fprintf(stderr, "Invalid file");
+    SorterOptions options;
+    if (!parseSorterOptions(argc, argv, options)) {
+        printSorterUsage(argv[0]);
         return -1;
     }
 
-    auto lines = splitLines(mappedFile.getTextPtr(), mappedFile.getTextSize());
+    if (options.isaForced && !forceIsa(options.forcedIsa)) {
+        fprintf(stderr, "CPU doesn't support %s\n", getIsaName(options.forcedIsa));
+        return -1;
+    }
+    if (options.collation != nullptr) setCollationTable(*options.collation);
 
     srand(time(nullptr));
-    writeSortedDirect(lines, "direct_sorted.txt");
-    writeSortedReverse(lines, "reverse_sorted.txt");
-    writeOriginal(lines, "original.txt");
-
-    return 0;
+    if (options.command == SorterCommand::QUERY) {
+        return queryRhymeIndex(options);
+    }
+    if (options.command == SorterCommand::SCHEME) {
+        return printRhymeSchemes(options);
+    }
+    if (options.servePath != nullptr) {
+        return serve(options);
+    }
+    if (options.watchPath != nullptr) {
+        return watchFiles(options);
+    }
+    if (options.batchPath != nullptr) {
+        return sortBatchFiles(options);
+    }
+    if (options.rhymeLetters != 0) {
+        return groupFileByRhyme(options);
+    }
+    return sortFile(options);
 }
@@ -0,0 +1,132 @@
+/**
+ * @file
+ * @brief Source file with functions for grouping lines by rhyme and detecting rhyme schemes
+ */
+#include <algorithm>
+#include <cassert>
+#include "rhymes.h"
+
+/**
+ * Builds the rhyme key of the line: last lettersNumber letters (punctuation and spaces are skipped like in
+ * seekAlphaReverse), packed by their collation codes (see getAlphaCode) one byte per letter.
+ * Last letter of the line is stored in the highest byte, so keys are ordered the same way as endings of the lines
+ * are compared in compareLinesReverse. Lines with less letters are padded with zero bytes.
+ * @param[in] line          line to build the key of
+ * @param[in] lettersNumber number of letters in the key (1 - MAX_RHYME_LETTERS)
+ * @return rhyme key of the line.
+ */
+uint64_t getRhymeKey(const Line& line, unsigned int lettersNumber) {
+    assert(lettersNumber >= 1 && lettersNumber <= MAX_RHYME_LETTERS);
+
+    uint64_t key = 0;
+    const char* ptr = line.lineEnd;
+    for (unsigned int i = 0; i < lettersNumber; ++i) {
+        unsigned char code = seekAlphaCodeReverse(ptr, line.lineStart);
+        if (code == 0) break;
+
+        key |= static_cast<uint64_t>(code) << (8 * (MAX_RHYME_LETTERS - 1 - i));
+    }
+    return key;
+}
+
+/**
+ * Groups lines by rhyme key in near-linear time: keys are put in an open-addressing hash table,
+ * only distinct keys are sorted, lines are distributed into groups by counting sort.
+ * @param[in]      lines         lines to group
+ * @param[in]      lettersNumber number of letters in the rhyme key (1 - MAX_RHYME_LETTERS)
+ * @param[out]     groups        lines grouped by rhyme, groups are ordered by key
+ */
+void groupByRhyme(const std::vector<Line>& lines, unsigned int lettersNumber, RhymeGroups& groups) {
+    static constexpr size_t EMPTY_SLOT = SIZE_MAX;
+
+    size_t capacity = 16;
+    while (capacity < 2 * lines.size()) capacity *= 2;
+    std::vector<size_t> slots(capacity, EMPTY_SLOT); // Indices of the groups in order of their first appearance
+
+    std::vector<uint64_t> unsortedKeys;
+    std::vector<size_t> groupSizes;
+    std::vector<size_t> lineGroups(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        uint64_t key = getRhymeKey(lines[i], lettersNumber);
+
+        size_t slot = (key * 0x9E3779B97F4A7C15ull) >> 32 & (capacity - 1);
+        while (slots[slot] != EMPTY_SLOT && unsortedKeys[slots[slot]] != key) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (slots[slot] == EMPTY_SLOT) {
+            slots[slot] = unsortedKeys.size();
+            unsortedKeys.push_back(key);
+            groupSizes.push_back(0);
+        }
+
+        lineGroups[i] = slots[slot];
+        ++groupSizes[slots[slot]];
+    }
+
+    std::vector<size_t> groupOrder(unsortedKeys.size());
+    for (size_t i = 0; i < groupOrder.size(); ++i) groupOrder[i] = i;
+    std::sort(groupOrder.begin(), groupOrder.end(), [&unsortedKeys](size_t group1, size_t group2) {
+        return unsortedKeys[group1] < unsortedKeys[group2];
+    });
+
+    std::vector<size_t> groupPositions(unsortedKeys.size());
+    groups.keys.resize(unsortedKeys.size());
+    groups.groupStarts.resize(unsortedKeys.size() + 1);
+    size_t position = 0;
+    for (size_t i = 0; i < groupOrder.size(); ++i) {
+        groups.keys[i] = unsortedKeys[groupOrder[i]];
+        groups.groupStarts[i] = position;
+        groupPositions[groupOrder[i]] = position;
+        position += groupSizes[groupOrder[i]];
+    }
+    groups.groupStarts[groupOrder.size()] = position;
+
+    groups.lineIndices.resize(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        groups.lineIndices[groupPositions[lineGroups[i]]++] = i;
+    }
+}
+
+/**
+ * Checks whether there is a stanza break between two consecutive lines given by splitLines:
+ * at least one line without letters (e.g. an empty line) was removed between them.
+ * @param[in] previous previous line
+ * @param[in] next     next line
+ * @return true, if the lines belong to different stanzas, false otherwise.
+ */
+bool isStanzaBreak(const Line& previous, const Line& next) {
+    // Adjacent lines are separated only by the '\n' (or '\0') symbol of the previous line
+    return next.lineStart - previous.lineEnd > 2;
+}
+
+/**
+ * Detects rhyme schemes of the stanzas (see isStanzaBreak) in one pass. Lines of a stanza are marked with letters
+ * in order of the first appearance of their rhyme keys (see getRhymeKey), e.g. "ABAB" or "AABB". Each key
+ * is compared with at most MAX_SCHEME_RHYMES keys of its stanza, so detection takes linear time.
+ * @param[in]  lines         lines given by splitLines in original order
+ * @param[in]  lettersNumber number of letters in the rhyme key (1 - MAX_RHYME_LETTERS)
+ * @param[out] schemes       schemes of the stanzas separated by spaces
+ */
+void detectRhymeSchemes(const std::vector<Line>& lines, unsigned int lettersNumber, std::string& schemes) {
+    schemes.clear();
+    schemes.reserve(lines.size() + lines.size() / 4);
+
+    uint64_t stanzaKeys[MAX_SCHEME_RHYMES];
+    size_t stanzaKeysNumber = 0;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (i > 0 && isStanzaBreak(lines[i - 1], lines[i])) {
+            schemes.push_back(' ');
+            stanzaKeysNumber = 0;
+        }
+
+        uint64_t key = getRhymeKey(lines[i], lettersNumber);
+        size_t rhyme = std::find(stanzaKeys, stanzaKeys + stanzaKeysNumber, key) - stanzaKeys;
+        if (rhyme == stanzaKeysNumber && stanzaKeysNumber < MAX_SCHEME_RHYMES) stanzaKeys[stanzaKeysNumber++] = key;
+
+        if (rhyme >= MAX_SCHEME_RHYMES) {
+            schemes.push_back(SCHEME_OVERFLOW_MARK);
+        } else {
+            schemes.push_back(static_cast<char>(rhyme < 26 ? 'A' + rhyme : 'a' + rhyme - 26));
+        }
+    }
+}
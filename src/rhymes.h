@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @brief Header file with functions for grouping lines by rhyme and detecting rhyme schemes
+ */
+#ifndef POEM_SORTER_RHYMES_H
+#define POEM_SORTER_RHYMES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "text_helpers.h"
+
+/** Maximum number of letters in the rhyme key. **/
+#define MAX_RHYME_LETTERS 8
+/** Number of letters in the rhyme keys of rhyme schemes, if it's not given. **/
+#define DEFAULT_SCHEME_RHYME_LETTERS 2
+/** Maximum number of distinct rhymes in the scheme of a stanza: they are marked with 'A' - 'Z', then with 'a' - 'z'. **/
+#define MAX_SCHEME_RHYMES 52
+/** Mark of the lines whose rhymes don't fit in the scheme of the stanza (see MAX_SCHEME_RHYMES). **/
+#define SCHEME_OVERFLOW_MARK '*'
+
+/**
+ * Lines grouped by rhyme (by equal endings).
+ * Lines of the group i are lineIndices[groupStarts[i]], ..., lineIndices[groupStarts[i + 1] - 1] in original order.
+ */
+struct RhymeGroups {
+    std::vector<uint64_t> keys;      /**< rhyme key of each group, keys are ascending */
+    std::vector<size_t> groupStarts; /**< start of each group in lineIndices, last element is lineIndices.size() */
+    std::vector<size_t> lineIndices; /**< indices of the lines grouped by rhyme */
+};
+
+/**
+ * Builds the rhyme key of the line: last lettersNumber letters (punctuation and spaces are skipped like in
+ * seekAlphaReverse), packed by their collation codes (see getAlphaCode) one byte per letter.
+ * Last letter of the line is stored in the highest byte, so keys are ordered the same way as endings of the lines
+ * are compared in compareLinesReverse. Lines with less letters are padded with zero bytes.
+ * @param[in] line          line to build the key of
+ * @param[in] lettersNumber number of letters in the key (1 - MAX_RHYME_LETTERS)
+ * @return rhyme key of the line.
+ */
+uint64_t getRhymeKey(const Line& line, unsigned int lettersNumber);
+
+/**
+ * Groups lines by rhyme key in near-linear time: keys are put in an open-addressing hash table,
+ * only distinct keys are sorted, lines are distributed into groups by counting sort.
+ * @param[in]      lines         lines to group
+ * @param[in]      lettersNumber number of letters in the rhyme key (1 - MAX_RHYME_LETTERS)
+ * @param[out]     groups        lines grouped by rhyme, groups are ordered by key
+ */
+void groupByRhyme(const std::vector<Line>& lines, unsigned int lettersNumber, RhymeGroups& groups);
+
+/**
+ * Checks whether there is a stanza break between two consecutive lines given by splitLines:
+ * at least one line without letters (e.g. an empty line) was removed between them.
+ * @param[in] previous previous line
+ * @param[in] next     next line
+ * @return true, if the lines belong to different stanzas, false otherwise.
+ */
+bool isStanzaBreak(const Line& previous, const Line& next);
+
+/**
+ * Detects rhyme schemes of the stanzas (see isStanzaBreak) in one pass. Lines of a stanza are marked with letters
+ * in order of the first appearance of their rhyme keys (see getRhymeKey), e.g. "ABAB" or "AABB". Each key
+ * is compared with at most MAX_SCHEME_RHYMES keys of its stanza, so detection takes linear time.
+ * @param[in]  lines         lines given by splitLines in original order
+ * @param[in]  lettersNumber number of letters in the rhyme key (1 - MAX_RHYME_LETTERS)
+ * @param[out] schemes       schemes of the stanzas separated by spaces
+ */
+void detectRhymeSchemes(const std::vector<Line>& lines, unsigned int lettersNumber, std::string& schemes);
+
+#endif //POEM_SORTER_RHYMES_H
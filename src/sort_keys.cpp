@@ -0,0 +1,104 @@
+/**
+ * @file
+ * @brief Source file with composite sort keys of lines
+ */
+#include <cassert>
+#include <cstring>
+#include "sort_keys.h"
+
+/**
+ * Parses the composite order specification: comma-separated keys "direct", "reverse" and "length",
+ * e.g. "reverse,direct" (by rhyme, then from the start).
+ * @param[in]  spec composite order specification
+ * @param[out] keys parsed keys (1 - MAX_SORT_KEYS)
+ * @return true, if the specification is valid, false otherwise.
+ */
+bool parseSortKeys(const char* spec, std::vector<SortKey>& keys) {
+    assert(spec != nullptr);
+
+    static const struct {
+        const char* name;
+        SortKey key;
+    } keyNames[] = {
+            { "direct",  SortKey::DIRECT  },
+            { "reverse", SortKey::REVERSE },
+            { "length",  SortKey::LENGTH  },
+    };
+
+    std::vector<SortKey> parsed;
+    const char* nameStart = spec;
+    while (true) {
+        const char* nameEnd = strchr(nameStart, ',');
+        size_t nameLength = nameEnd == nullptr ? strlen(nameStart) : nameEnd - nameStart;
+
+        bool found = false;
+        for (const auto& keyName : keyNames) {
+            if (strlen(keyName.name) == nameLength && strncmp(keyName.name, nameStart, nameLength) == 0) {
+                parsed.push_back(keyName.key);
+                found = true;
+                break;
+            }
+        }
+        if (!found || parsed.size() > MAX_SORT_KEYS) return false;
+
+        if (nameEnd == nullptr) break;
+        nameStart = nameEnd + 1;
+    }
+
+    keys = parsed;
+    return true;
+}
+
+/**
+ * Builds keys of the lines in one pass over each line.
+ * @param[in]  lines lines to build keys of
+ * @param[out] keys  keys of the lines
+ */
+void buildLineKeys(const std::vector<Line>& lines, LineKeys& keys) {
+    keys.codes.clear();
+    keys.codeStarts.clear();
+    keys.codeStarts.reserve(lines.size() + 1);
+
+    for (const Line& line : lines) {
+        keys.codeStarts.push_back(keys.codes.size());
+        appendAlphaCodes(line, keys.codes);
+    }
+    keys.codeStarts.push_back(keys.codes.size());
+}
+
+/**
+ * Compares two lines by the given key.
+ * @param[in] keys   keys of the lines
+ * @param[in] index1 index of the first line
+ * @param[in] index2 index of the second line
+ * @param[in] key    key to compare by
+ * @return negative number, if first line is less than second; <br>
+ *         positive number, if first line is greater than second; <br>
+ *         zero,            if both lines are equal by the key.
+ */
+int compareLineKeys(const LineKeys& keys, size_t index1, size_t index2, SortKey key) {
+    const unsigned char* start1 = keys.codes.data() + keys.codeStarts[index1];
+    const unsigned char* end1 = keys.codes.data() + keys.codeStarts[index1 + 1];
+    const unsigned char* start2 = keys.codes.data() + keys.codeStarts[index2];
+    const unsigned char* end2 = keys.codes.data() + keys.codeStarts[index2 + 1];
+    size_t length1 = end1 - start1;
+    size_t length2 = end2 - start2;
+
+    switch (key) {
+        case SortKey::DIRECT:
+            for (; start1 < end1 && start2 < end2; ++start1, ++start2) {
+                if (*start1 != *start2) return *start1 < *start2 ? -1 : +1;
+            }
+            break;
+        case SortKey::REVERSE:
+            for (; start1 < end1 && start2 < end2; --end1, --end2) {
+                if (*(end1 - 1) != *(end2 - 1)) return *(end1 - 1) < *(end2 - 1) ? -1 : +1;
+            }
+            break;
+        case SortKey::LENGTH:
+            break;
+    }
+
+    if (length1 != length2) return length1 < length2 ? -1 : +1;
+    return 0;
+}
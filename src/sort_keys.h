@@ -0,0 +1,62 @@
+/**
+ * @file
+ * @brief Header file with composite sort keys of lines
+ */
+#ifndef POEM_SORTER_SORT_KEYS_H
+#define POEM_SORTER_SORT_KEYS_H
+
+#include <cstddef>
+#include <vector>
+#include "text_helpers.h"
+
+/** Maximum number of keys in the composite order. **/
+#define MAX_SORT_KEYS 8
+
+/**
+ * Key of the composite order.
+ */
+enum class SortKey {
+    DIRECT,  /**< letters from left to right, as in compareLinesDirect */
+    REVERSE, /**< letters from right to left, as in compareLinesReverse */
+    LENGTH,  /**< number of letters */
+};
+
+/**
+ * Materialized keys of the lines: collation codes of letters of each line (see getAlphaCode) in direct order.
+ * Codes of the line i are codes[codeStarts[i]], ..., codes[codeStarts[i + 1] - 1].
+ * All keys (direct, reverse and length) are compared using the codes only, without scanning the text.
+ */
+struct LineKeys {
+    std::vector<unsigned char> codes; /**< letter codes of all lines */
+    std::vector<size_t> codeStarts;   /**< start of the codes of each line, last element is codes.size() */
+};
+
+/**
+ * Parses the composite order specification: comma-separated keys "direct", "reverse" and "length",
+ * e.g. "reverse,direct" (by rhyme, then from the start).
+ * @param[in]  spec composite order specification
+ * @param[out] keys parsed keys (1 - MAX_SORT_KEYS)
+ * @return true, if the specification is valid, false otherwise.
+ */
+bool parseSortKeys(const char* spec, std::vector<SortKey>& keys);
+
+/**
+ * Builds keys of the lines in one pass over each line.
+ * @param[in]  lines lines to build keys of
+ * @param[out] keys  keys of the lines
+ */
+void buildLineKeys(const std::vector<Line>& lines, LineKeys& keys);
+
+/**
+ * Compares two lines by the given key.
+ * @param[in] keys   keys of the lines
+ * @param[in] index1 index of the first line
+ * @param[in] index2 index of the second line
+ * @param[in] key    key to compare by
+ * @return negative number, if first line is less than second; <br>
+ *         positive number, if first line is greater than second; <br>
+ *         zero,            if both lines are equal by the key.
+ */
+int compareLineKeys(const LineKeys& keys, size_t index1, size_t index2, SortKey key);
+
+#endif //POEM_SORTER_SORT_KEYS_H
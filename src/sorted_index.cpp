@@ -0,0 +1,272 @@
+/**
+ * @file
+ * @brief Source file with binary format of sorted line indices
+ */
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include "hash.h"
+#include "sorted_index.h"
+
+/**
+ * Description of the sort options that affect results, the name of the bound collation is substituted for %s.
+ * Change it whenever comparators or split rules change, so stale indices are not used.
+ */
+static const char* const SORT_OPTIONS_DESCRIPTION = "orders:direct,reverse;collation:%s;split:alpha-lines";
+
+/**
+ * Writes an array of numbers of type T converted from size_t values.
+ * @param[in] file   file to write to
+ * @param[in] values values to write
+ * @return true, if the values were written, false otherwise.
+ */
+template <typename T>
+static bool writeNumbers(FILE* file, const std::vector<size_t>& values) {
+    std::vector<T> numbers(values.begin(), values.end());
+    return fwrite(numbers.data(), sizeof(T), numbers.size(), file) == numbers.size();
+}
+
+/**
+ * Reads an array of numbers of type T and converts them to size_t values.
+ * @param[in]  file   file to read from
+ * @param[in]  count  number of values to read
+ * @param[out] values read values
+ * @return true, if the values were read, false otherwise.
+ */
+template <typename T>
+static bool readNumbers(FILE* file, size_t count, std::vector<size_t>& values) {
+    std::vector<T> numbers(count);
+    if (fread(numbers.data(), sizeof(T), count, file) != count) return false;
+    values.assign(numbers.begin(), numbers.end());
+    return true;
+}
+
+/**
+ * Checks that the given indices are a permutation of [0; count).
+ * @param[in] indices indices to check
+ * @param[in] count   number of lines
+ * @return true, if the indices are a permutation, false otherwise.
+ */
+static bool isPermutation(const std::vector<size_t>& indices, size_t count) {
+    std::vector<bool> seen(count, false);
+    for (size_t index : indices) {
+        if (index >= count || seen[index]) return false;
+        seen[index] = true;
+    }
+    return indices.size() == count;
+}
+
+/**
+ * Key of the current sort options (orders, bound collation, split rules). Indices built with other options are not valid.
+ * @return options key.
+ */
+uint64_t getSortOptionsKey() {
+    return getSortOptionsKey(getCollationTable());
+}
+
+/**
+ * Key of the sort options with the given collation table. Indices built with other options are not valid.
+ * @param[in] table collation table
+ * @return options key.
+ */
+uint64_t getSortOptionsKey(const CollationTable& table) {
+    char description[256] = "";
+    int length = snprintf(description, sizeof(description), SORT_OPTIONS_DESCRIPTION, table.name);
+    assert(length > 0 && static_cast<size_t>(length) < sizeof(description));
+    return hashBytes(description, length);
+}
+
+/**
+ * Checks magic, version and size of the header.
+ * @param[in] header header to check
+ * @return true, if the header is valid, false otherwise.
+ */
+static bool isValidHeader(const SortedIndexHeader& header) {
+    return memcmp(header.magic, SORTED_INDEX_MAGIC, sizeof(header.magic)) == 0
+        && header.version == SORTED_INDEX_VERSION
+        && header.headerSize == sizeof(SortedIndexHeader);
+}
+
+/**
+ * Writes the sorted index of the text to the file. File is written to a temporary file first and then renamed,
+ * so readers never see partially written index.
+ * @param[in] filePath    path to the index file
+ * @param[in] contentHash hash of the text
+ * @param[in] optionsKey  key of the sort options
+ * @param[in] text        pointer to the text start (lines point into it)
+ * @param[in] textSize    size of the text in bytes
+ * @param[in] lines       lines of the text in original order
+ * @param[in] direct      indices of the lines in direct sorted order
+ * @param[in] reverse     indices of the lines in reverse sorted order
+ * @return true, if the index was written, false otherwise.
+ */
+bool writeSortedIndex(
+        const char* filePath,
+        uint64_t contentHash,
+        uint64_t optionsKey,
+        const char* text,
+        size_t textSize,
+        const std::vector<Line>& lines,
+        const std::vector<size_t>& direct,
+        const std::vector<size_t>& reverse
+) {
+    assert(filePath != nullptr);
+    assert(text != nullptr);
+    assert(direct.size() == lines.size() && reverse.size() == lines.size());
+
+    if (lines.size() > UINT32_MAX) return false;
+
+    std::string tmpPath = std::string(filePath) + ".XXXXXX";
+    int fd = mkstemp(tmpPath.data());
+    if (fd < 0) return false;
+    FILE* file = fdopen(fd, "wb");
+    if (file == nullptr) {
+        close(fd);
+        unlink(tmpPath.c_str());
+        return false;
+    }
+
+    SortedIndexHeader header{};
+    memcpy(header.magic, SORTED_INDEX_MAGIC, sizeof(header.magic));
+    header.version = SORTED_INDEX_VERSION;
+    header.headerSize = sizeof(SortedIndexHeader);
+    header.contentHash = contentHash;
+    header.optionsKey = optionsKey;
+    header.textSize = textSize;
+    header.linesNumber = lines.size();
+
+    std::vector<size_t> offsets(lines.size());
+    std::vector<size_t> lengths(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        offsets[i] = lines[i].lineStart - text;
+        lengths[i] = lines[i].lineEnd - lines[i].lineStart + 1;
+    }
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+            && writeNumbers<uint64_t>(file, offsets)
+            && writeNumbers<uint32_t>(file, lengths)
+            && writeNumbers<uint32_t>(file, direct)
+            && writeNumbers<uint32_t>(file, reverse);
+    written = (fclose(file) == 0) && written;
+
+    if (!written || rename(tmpPath.c_str(), filePath) != 0) {
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Reads only the header of the sorted index file. Header is checked for magic, version and size.
+ * @param[in]  filePath path to the index file
+ * @param[out] header   read header
+ * @return true, if the valid header was read, false otherwise.
+ */
+bool readSortedIndexHeader(const char* filePath, SortedIndexHeader& header) {
+    assert(filePath != nullptr);
+
+    FILE* file = fopen(filePath, "rb");
+    if (file == nullptr) return false;
+
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 && isValidHeader(header);
+    fclose(file);
+    return valid;
+}
+
+/**
+ * Parses the sorted index in memory without copying it. Header is checked for magic, version and size,
+ * sizes of the arrays are checked against the memory size and all indices are checked to be less than the number of lines.
+ * @param[in]  data pointer to the index start (must be aligned to 8 bytes, e.g. start of the mapped file)
+ * @param[in]  size size of the index in bytes
+ * @param[out] view parsed index
+ * @return true, if the index is valid, false otherwise.
+ */
+bool parseSortedIndex(const char* data, size_t size, SortedIndexView& view) {
+    assert(data != nullptr || size == 0);
+    assert(reinterpret_cast<uintptr_t>(data) % alignof(uint64_t) == 0);
+
+    if (size < sizeof(SortedIndexHeader)) return false;
+    const auto* header = reinterpret_cast<const SortedIndexHeader*>(data);
+    if (!isValidHeader(*header)) return false;
+
+    // Each line takes 8 bytes of offset and 3 * 4 bytes of length and indices
+    static constexpr size_t LINE_RECORD_SIZE = sizeof(uint64_t) + 3 * sizeof(uint32_t);
+    uint64_t linesNumber = header->linesNumber;
+    if (linesNumber > (size - sizeof(SortedIndexHeader)) / LINE_RECORD_SIZE) return false;
+
+    const char* arrays = data + sizeof(SortedIndexHeader);
+    const auto* offsets = reinterpret_cast<const uint64_t*>(arrays);
+    const auto* lengths = reinterpret_cast<const uint32_t*>(offsets + linesNumber);
+    const uint32_t* direct = lengths + linesNumber;
+    const uint32_t* reverse = direct + linesNumber;
+    for (uint64_t i = 0; i < linesNumber; ++i) {
+        if (direct[i] >= linesNumber || reverse[i] >= linesNumber) return false;
+    }
+
+    view = { header, offsets, lengths, direct, reverse };
+    return true;
+}
+
+/**
+ * Reads the sorted index of the text from the file.
+ * Index is accepted only if its hash, options and text size match the given ones and all lines lie inside the text.
+ * @param[in]  filePath    path to the index file
+ * @param[in]  contentHash expected hash of the text
+ * @param[in]  optionsKey  expected key of the sort options
+ * @param[in]  text        pointer to the text start
+ * @param[in]  textSize    size of the text in bytes
+ * @param[out] lines       lines of the text in original order
+ * @param[out] direct      indices of the lines in direct sorted order
+ * @param[out] reverse     indices of the lines in reverse sorted order
+ * @return true, if the valid index was read, false otherwise.
+ */
+bool readSortedIndex(
+        const char* filePath,
+        uint64_t contentHash,
+        uint64_t optionsKey,
+        const char* text,
+        size_t textSize,
+        std::vector<Line>& lines,
+        std::vector<size_t>& direct,
+        std::vector<size_t>& reverse
+) {
+    assert(filePath != nullptr);
+    assert(text != nullptr);
+
+    FILE* file = fopen(filePath, "rb");
+    if (file == nullptr) return false;
+
+    SortedIndexHeader header{};
+    std::vector<size_t> offsets;
+    std::vector<size_t> lengths;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1
+            && isValidHeader(header)
+            && header.contentHash == contentHash
+            && header.optionsKey == optionsKey
+            && header.textSize == textSize
+            && header.linesNumber <= textSize
+            && readNumbers<uint64_t>(file, header.linesNumber, offsets)
+            && readNumbers<uint32_t>(file, header.linesNumber, lengths)
+            && readNumbers<uint32_t>(file, header.linesNumber, direct)
+            && readNumbers<uint32_t>(file, header.linesNumber, reverse);
+    fclose(file);
+
+    valid = valid && isPermutation(direct, header.linesNumber) && isPermutation(reverse, header.linesNumber);
+    lines.clear();
+    for (size_t i = 0; valid && i < header.linesNumber; ++i) {
+        if (lengths[i] == 0 || offsets[i] >= textSize || lengths[i] > textSize - offsets[i]) {
+            valid = false;
+            break;
+        }
+        lines.emplace_back(text + offsets[i], text + offsets[i] + lengths[i] - 1);
+    }
+
+    if (!valid) {
+        lines.clear();
+        direct.clear();
+        reverse.clear();
+    }
+    return valid;
+}
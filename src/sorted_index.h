@@ -0,0 +1,139 @@
+/**
+ * @file
+ * @brief Header file with binary format of sorted line indices
+ *
+ * Sorted index file stores lines of a text and their direct and reverse sorted permutations:
+ * * SortedIndexHeader;
+ * * uint64_t offsets[linesNumber] - offset of the first character of each line from the text start;
+ * * uint32_t lengths[linesNumber] - length of each line in bytes (without '\\n');
+ * * uint32_t direct[linesNumber]  - indices of the lines in direct sorted order;
+ * * uint32_t reverse[linesNumber] - indices of the lines in reverse sorted order.
+ *
+ * All numbers are little-endian, all arrays are naturally aligned, so the file can be memory-mapped and used
+ * in-place (see parseSortedIndex). Offsets point into the original text, so duplicate lines are told apart
+ * by their positions.
+ */
+#ifndef POEM_SORTER_SORTED_INDEX_H
+#define POEM_SORTER_SORTED_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "text_helpers.h"
+
+/** Magic bytes at the start of the sorted index file. **/
+#define SORTED_INDEX_MAGIC "PSORTIDX"
+/** Current version of the sorted index format. **/
+#define SORTED_INDEX_VERSION 1
+
+/** Name of the file with the exported sorted index of the text (see SortSession::saveSortedIndex). **/
+#define SORTED_INDEX_FILE_NAME "sorted_index.bin"
+
+/** Extension that is appended to the text path to get the path of its saved sort state (see SortSession). **/
+#define SORT_STATE_EXTENSION ".sortstate"
+
+/**
+ * Header of the sorted index file.
+ */
+struct SortedIndexHeader {
+    char magic[8];        /**< SORTED_INDEX_MAGIC without '\\0' */
+    uint32_t version;     /**< SORTED_INDEX_VERSION */
+    uint32_t headerSize;  /**< sizeof(SortedIndexHeader) */
+    uint64_t contentHash; /**< hash of the indexed text */
+    uint64_t optionsKey;  /**< key of the sort options (orders, collation) the index was built with */
+    uint64_t textSize;    /**< size of the indexed text in bytes */
+    uint64_t linesNumber; /**< number of lines */
+};
+
+/**
+ * Sorted index that is used in-place from memory (e.g. from the mapped file).
+ * Arrays point into the parsed memory and are valid as long as it is.
+ */
+struct SortedIndexView {
+    const SortedIndexHeader* header; /**< header of the index */
+    const uint64_t* offsets;         /**< offset of the first character of each line from the text start */
+    const uint32_t* lengths;         /**< length of each line in bytes */
+    const uint32_t* direct;          /**< indices of the lines in direct sorted order */
+    const uint32_t* reverse;         /**< indices of the lines in reverse sorted order */
+};
+
+/**
+ * Key of the current sort options (orders, bound collation, split rules). Indices built with other options are not valid.
+ * @return options key.
+ */
+uint64_t getSortOptionsKey();
+
+/**
+ * Key of the sort options with the given collation table. Indices built with other options are not valid.
+ * @param[in] table collation table
+ * @return options key.
+ */
+uint64_t getSortOptionsKey(const CollationTable& table);
+
+/**
+ * Writes the sorted index of the text to the file. File is written to a temporary file first and then renamed,
+ * so readers never see partially written index.
+ * @param[in] filePath    path to the index file
+ * @param[in] contentHash hash of the text
+ * @param[in] optionsKey  key of the sort options
+ * @param[in] text        pointer to the text start (lines point into it)
+ * @param[in] textSize    size of the text in bytes
+ * @param[in] lines       lines of the text in original order
+ * @param[in] direct      indices of the lines in direct sorted order
+ * @param[in] reverse     indices of the lines in reverse sorted order
+ * @return true, if the index was written, false otherwise.
+ */
+bool writeSortedIndex(
+        const char* filePath,
+        uint64_t contentHash,
+        uint64_t optionsKey,
+        const char* text,
+        size_t textSize,
+        const std::vector<Line>& lines,
+        const std::vector<size_t>& direct,
+        const std::vector<size_t>& reverse
+);
+
+/**
+ * Reads only the header of the sorted index file. Header is checked for magic, version and size.
+ * @param[in]  filePath path to the index file
+ * @param[out] header   read header
+ * @return true, if the valid header was read, false otherwise.
+ */
+bool readSortedIndexHeader(const char* filePath, SortedIndexHeader& header);
+
+/**
+ * Parses the sorted index in memory without copying it. Header is checked for magic, version and size,
+ * sizes of the arrays are checked against the memory size and all indices are checked to be less than the number of lines.
+ * @param[in]  data pointer to the index start (must be aligned to 8 bytes, e.g. start of the mapped file)
+ * @param[in]  size size of the index in bytes
+ * @param[out] view parsed index
+ * @return true, if the index is valid, false otherwise.
+ */
+bool parseSortedIndex(const char* data, size_t size, SortedIndexView& view);
+
+/**
+ * Reads the sorted index of the text from the file.
+ * Index is accepted only if its hash, options and text size match the given ones and all lines lie inside the text.
+ * @param[in]  filePath    path to the index file
+ * @param[in]  contentHash expected hash of the text
+ * @param[in]  optionsKey  expected key of the sort options
+ * @param[in]  text        pointer to the text start
+ * @param[in]  textSize    size of the text in bytes
+ * @param[out] lines       lines of the text in original order
+ * @param[out] direct      indices of the lines in direct sorted order
+ * @param[out] reverse     indices of the lines in reverse sorted order
+ * @return true, if the valid index was read, false otherwise.
+ */
+bool readSortedIndex(
+        const char* filePath,
+        uint64_t contentHash,
+        uint64_t optionsKey,
+        const char* text,
+        size_t textSize,
+        std::vector<Line>& lines,
+        std::vector<size_t>& direct,
+        std::vector<size_t>& reverse
+);
+
+#endif //POEM_SORTER_SORTED_INDEX_H
@@ -2,13 +2,14 @@
  * @file
  * @brief Source file with sorting functions implementation
  */
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include "sortlib.h"
 
 /**
  * Compares two Lines in direct (from left to right) order. Punctuation and space symbols are skipped - only letters are compared.
- * Supports english and russian letters in UTF-8 encoding.
+ * Letters are ordered by the bound collation table (see setCollationTable).
  * @param[in] str1 first Line to compare
  * @param[in] str2 second Line to compare
  * @return negative number, if first Line is less than second; <br>
@@ -16,6 +17,19 @@
  *         zero,            if both Lines are equal.
  */
 int compareLinesDirect(const Line& str1, const Line& str2) {
+    return compareLinesDirect(str1, str2, getCollationTable());
+}
+
+/**
+ * Compares two Lines in direct order like compareLinesDirect, with letters ordered by the given collation table.
+ * @param[in] str1  first Line to compare
+ * @param[in] str2  second Line to compare
+ * @param[in] table collation table
+ * @return negative number, if first Line is less than second; <br>
+ *         positive number, if first Line is greater than second; <br>
+ *         zero,            if both Lines are equal.
+ */
+int compareLinesDirect(const Line& str1, const Line& str2, const CollationTable& table) {
     const char* ptr1 = str1.lineStart;
     const char* ptr2 = str2.lineStart;
 
@@ -23,31 +37,23 @@ int compareLinesDirect(const Line& str1, const Line& str2) {
     unsigned short alphaSize2 = 0;
 
     while (ptr1 <= str1.lineEnd && ptr2 <= str2.lineEnd) {
-        alphaSize1 = seekAlphaDirect(ptr1, str1.lineEnd);
-        alphaSize2 = seekAlphaDirect(ptr2, str2.lineEnd);
+        alphaSize1 = seekAlphaDirect(ptr1, str1.lineEnd, table);
+        alphaSize2 = seekAlphaDirect(ptr2, str2.lineEnd, table);
 
         if (ptr1 > str1.lineEnd && ptr2 > str2.lineEnd) return 0;
         if (ptr1 > str1.lineEnd) return -1;
         if (ptr2 > str2.lineEnd) return +1;
 
-        if (alphaSize1 < alphaSize2) return -1;
-        if (alphaSize1 > alphaSize2) return +1;
-
-        if (alphaSize1 == 1) {
-            int cmpResult = compareEnglishAlphas(*ptr1, *ptr2);
-            if (cmpResult != 0) return cmpResult;
-        } else { // if alphaSize1 == 2
-            int cmpResult = compareRussianAlphas(*ptr1, *(ptr1 + 1), *ptr2, *(ptr2 + 1));
-            if (cmpResult != 0) return cmpResult;
-        }
+        int cmpResult = compareAlphas(ptr1, alphaSize1, ptr2, alphaSize2, table);
+        if (cmpResult != 0) return cmpResult;
 
         ptr1 += alphaSize1;
         ptr2 += alphaSize2;
     }
 
     // To remove trailing punctuation signs
-    seekAlphaDirect(ptr1, str1.lineEnd);
-    seekAlphaDirect(ptr2, str2.lineEnd);
+    seekAlphaDirect(ptr1, str1.lineEnd, table);
+    seekAlphaDirect(ptr2, str2.lineEnd, table);
 
     if (ptr1 > str1.lineEnd && ptr2 <= str2.lineEnd) return -1;
     if (ptr2 > str2.lineEnd && ptr1 <= str1.lineEnd) return +1;
@@ -56,7 +62,7 @@ int compareLinesDirect(const Line& str1, const Line& str2) {
 
 /**
  * Compares two Lines in reverse (from right to left) order. Punctuation and space symbols are skipped - only letters are compared.
- * Supports english and russian letters in UTF-8 encoding.
+ * Letters are ordered by the bound collation table (see setCollationTable).
  * @param[in] str1 first Line to compare
  * @param[in] str2 second Line to compare
  * @return negative number, if first Line is less than second; <br>
@@ -64,6 +70,19 @@ int compareLinesDirect(const Line& str1, const Line& str2) {
  *         zero,            if both Lines are equal.
  */
 int compareLinesReverse(const Line& str1, const Line& str2) {
+    return compareLinesReverse(str1, str2, getCollationTable());
+}
+
+/**
+ * Compares two Lines in reverse order like compareLinesReverse, with letters ordered by the given collation table.
+ * @param[in] str1  first Line to compare
+ * @param[in] str2  second Line to compare
+ * @param[in] table collation table
+ * @return negative number, if first Line is less than second; <br>
+ *         positive number, if first Line is greater than second; <br>
+ *         zero,            if both Lines are equal.
+ */
+int compareLinesReverse(const Line& str1, const Line& str2, const CollationTable& table) {
     const char* ptr1 = str1.lineEnd;
     const char* ptr2 = str2.lineEnd;
 
@@ -71,31 +90,24 @@ int compareLinesReverse(const Line& str1, const Line& str2) {
     unsigned short alphaSize2 = 0;
 
     while (ptr1 >= str1.lineStart && ptr2 >= str2.lineStart) {
-        alphaSize1 = seekAlphaReverse(ptr1, str1.lineStart);
-        alphaSize2 = seekAlphaReverse(ptr2, str2.lineStart);
+        alphaSize1 = seekAlphaReverse(ptr1, str1.lineStart, table);
+        alphaSize2 = seekAlphaReverse(ptr2, str2.lineStart, table);
 
         if (ptr1 < str1.lineStart && ptr2 < str2.lineStart) return 0;
         if (ptr1 < str1.lineStart) return -1;
         if (ptr2 < str2.lineStart) return +1;
 
-        if (alphaSize1 < alphaSize2) return -1;
-        if (alphaSize1 > alphaSize2) return +1;
-
-        if (alphaSize1 == 1) {
-            int cmpResult = compareEnglishAlphas(*ptr1, *ptr2);
-            if (cmpResult != 0) return cmpResult;
-        } else { // if alphaSize1 == 2
-            int cmpResult = compareRussianAlphas(*(ptr1 - 1), *ptr1, *(ptr2 - 1), *ptr2);
-            if (cmpResult != 0) return cmpResult;
-        }
+        // Pointers are at the last bytes of the letters
+        int cmpResult = compareAlphas(ptr1 - alphaSize1 + 1, alphaSize1, ptr2 - alphaSize2 + 1, alphaSize2, table);
+        if (cmpResult != 0) return cmpResult;
 
         ptr1 -= alphaSize1;
         ptr2 -= alphaSize2;
     }
 
     // To remove leading punctuation signs
-    seekAlphaReverse(ptr1, str1.lineStart);
-    seekAlphaReverse(ptr2, str2.lineStart);
+    seekAlphaReverse(ptr1, str1.lineStart, table);
+    seekAlphaReverse(ptr2, str2.lineStart, table);
 
     if (ptr1 < str1.lineStart && ptr2 >= str2.lineStart) return -1;
     if (ptr2 < str2.lineStart && ptr1 >= str1.lineStart) return +1;
@@ -103,23 +115,18 @@ int compareLinesReverse(const Line& str1, const Line& str2) {
 }
 
 /**
- * Sorts vector of Lines with a given comparator.
- * Sort is performed in range [begin; end).
+ * Sorts range [begin; end) partially with a three-way comparator, so [begin; middle) contains the smallest elements
+ * in sorted order and [middle; end) contains the rest in unspecified order. Uses quick sort with random pivot and
+ * three-way partition that doesn't descend into parts lying entirely after middle, so it takes
+ * O(n + k log k) comparisons on average, where k = middle - begin.
  * @param[in] begin   iterator to the start (inclusive) of the sorting range
+ * @param[in] middle  iterator to the end (exclusive) of the range that must be sorted
  * @param[in] end     iterator to the end (exclusive) ot the sorting range
- * @param[in] compare pointer to the comparator. Comparator should return: <br>
- *                      negative value, if a \< b; <br>
- *                      positive value, if a \> b; <br>
- *                      zero,           if a == b.
+ * @param[in] compare three-way comparator of range elements
  */
-void sortLines(
-        std::vector<Line>::iterator begin,
-        std::vector<Line>::iterator end,
-        int (*compare) (const Line&, const Line&)
-) {
-    assert(compare != nullptr);
-
-    if (begin + 1 >= end) return;
+template <typename Iterator, typename Comparator>
+static void partialQuickSort(Iterator begin, Iterator middle, Iterator end, const Comparator& compare) {
+    if (begin + 1 >= end || begin >= middle) return;
 
     auto pivot = *(begin + (rand() % (end - begin)));
     auto i = begin, j = begin;
@@ -139,6 +146,247 @@ void sortLines(
         }
     }
 
-    if (begin + 1 < i) sortLines(begin, i, compare);
-    if (j + 1 < end) sortLines(j, end, compare);
+    if (begin + 1 < i) partialQuickSort(begin, middle, i, compare);
+    if (j + 1 < end) partialQuickSort(j, middle, end, compare);
+}
+
+/**
+ * Sorts range [begin; end) with a three-way comparator using quick sort with random pivot and three-way partition.
+ * @param[in] begin   iterator to the start (inclusive) of the sorting range
+ * @param[in] end     iterator to the end (exclusive) ot the sorting range
+ * @param[in] compare three-way comparator of range elements
+ */
+template <typename Iterator, typename Comparator>
+static void quickSort(Iterator begin, Iterator end, const Comparator& compare) {
+    partialQuickSort(begin, end, end, compare);
+}
+
+/**
+ * Sorts vector of Lines with a given comparator.
+ * Sort is performed in range [begin; end).
+ * @param[in] begin   iterator to the start (inclusive) of the sorting range
+ * @param[in] end     iterator to the end (exclusive) ot the sorting range
+ * @param[in] compare pointer to the comparator. Comparator should return: <br>
+ *                      negative value, if a \< b; <br>
+ *                      positive value, if a \> b; <br>
+ *                      zero,           if a == b.
+ */
+void sortLines(
+        std::vector<Line>::iterator begin,
+        std::vector<Line>::iterator end,
+        int (*compare) (const Line&, const Line&)
+) {
+    assert(compare != nullptr);
+
+    quickSort(begin, end, compare);
+}
+
+/**
+ * Sorts indices of Lines with a given comparator, so lines[*begin], lines[*(begin + 1)], ... are in sorted order.
+ * Sort is performed in range [begin; end).
+ * @param[in] begin   iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] end     iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] lines   lines that are referenced by indices
+ * @param[in] compare pointer to the comparator. Comparator should return: <br>
+ *                      negative value, if a \< b; <br>
+ *                      positive value, if a \> b; <br>
+ *                      zero,           if a == b.
+ */
+void sortLineIndices(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator end,
+        const std::vector<Line>& lines,
+        int (*compare) (const Line&, const Line&)
+) {
+    partialSortLineIndices(begin, end, end, lines, compare);
+}
+
+/**
+ * Sorts indices of Lines with a given comparator partially, so [begin; middle) contains indices of the smallest lines
+ * in sorted order (see sortLineIndices), and [middle; end) contains the rest of indices in unspecified order.
+ * Lines after middle are never sorted, so selecting first k of n lines takes O(n + k log k) comparisons on average.
+ * @param[in] begin   iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] middle  iterator to the end (exclusive) of the range of indices that must be sorted
+ * @param[in] end     iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] lines   lines that are referenced by indices
+ * @param[in] compare pointer to the comparator (see sortLineIndices)
+ */
+void partialSortLineIndices(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator middle,
+        std::vector<size_t>::iterator end,
+        const std::vector<Line>& lines,
+        int (*compare) (const Line&, const Line&)
+) {
+    assert(compare != nullptr);
+
+    partialQuickSort(begin, middle, end, [&lines, compare](size_t index1, size_t index2) {
+        return compare(lines[index1], lines[index2]);
+    });
+}
+
+/**
+ * Sorts indices of Lines by their keys, so keys[*begin], keys[*(begin + 1)], ... are in sorted order.
+ * Lines with equal keys are ordered by the lines themselves.
+ * Sort is performed in range [begin; end).
+ * @param[in] begin   iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] end     iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] keys    keys of the lines (e.g. key fields, see buildKeyFields)
+ * @param[in] lines   lines that are referenced by indices
+ * @param[in] compare pointer to the comparator of keys and lines (see sortLineIndices)
+ */
+void sortLineIndicesByKeys(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator end,
+        const std::vector<Line>& keys,
+        const std::vector<Line>& lines,
+        int (*compare) (const Line&, const Line&)
+) {
+    partialSortLineIndicesByKeys(begin, end, end, keys, lines, compare);
+}
+
+/**
+ * Sorts indices of Lines by their keys partially (see sortLineIndicesByKeys and partialSortLineIndices).
+ * @param[in] begin   iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] middle  iterator to the end (exclusive) of the range of indices that must be sorted
+ * @param[in] end     iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] keys    keys of the lines (e.g. key fields, see buildKeyFields)
+ * @param[in] lines   lines that are referenced by indices
+ * @param[in] compare pointer to the comparator of keys and lines (see sortLineIndices)
+ */
+void partialSortLineIndicesByKeys(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator middle,
+        std::vector<size_t>::iterator end,
+        const std::vector<Line>& keys,
+        const std::vector<Line>& lines,
+        int (*compare) (const Line&, const Line&)
+) {
+    assert(compare != nullptr);
+    assert(keys.size() == lines.size());
+
+    partialQuickSort(begin, middle, end, [&keys, &lines, compare](size_t index1, size_t index2) {
+        int cmpResult = compare(keys[index1], keys[index2]);
+        return cmpResult != 0 ? cmpResult : compare(lines[index1], lines[index2]);
+    });
+}
+
+/**
+ * Sorts indices of Lines in composite order: by the first key, lines with equal first keys by the second key etc.
+ * Lines that are equal by all keys are ordered by their indices.
+ * Sort is performed in range [begin; end).
+ * @param[in] begin iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] end   iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] keys  materialized keys of the lines (see buildLineKeys)
+ * @param[in] order keys of the composite order
+ */
+void sortLineIndicesByCompositeKeys(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator end,
+        const LineKeys& keys,
+        const std::vector<SortKey>& order
+) {
+    partialSortLineIndicesByCompositeKeys(begin, end, end, keys, order);
+}
+
+/**
+ * Sorts indices of Lines in composite order partially (see sortLineIndicesByCompositeKeys and partialSortLineIndices).
+ * @param[in] begin  iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] middle iterator to the end (exclusive) of the range of indices that must be sorted
+ * @param[in] end    iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] keys   materialized keys of the lines (see buildLineKeys)
+ * @param[in] order  keys of the composite order
+ */
+void partialSortLineIndicesByCompositeKeys(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator middle,
+        std::vector<size_t>::iterator end,
+        const LineKeys& keys,
+        const std::vector<SortKey>& order
+) {
+    partialQuickSort(begin, middle, end, [&keys, &order](size_t index1, size_t index2) {
+        for (SortKey key : order) {
+            int cmpResult = compareLineKeys(keys, index1, index2, key);
+            if (cmpResult != 0) return cmpResult;
+        }
+        return index1 < index2 ? -1 : (index1 > index2 ? +1 : 0);
+    });
+}
+
+/**
+ * Sorts indices of the lines of the table by the given key (see compareTableLines), so the comparisons read
+ * the compact key columns instead of the text. Lines that are equal by the key are ordered by their original indices.
+ * Sort is performed in range [begin; end).
+ * @param[in] begin iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] end   iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] table table of the lines (see buildLineTable)
+ * @param[in] key   key to sort by
+ */
+void sortLineIndicesByTable(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator end,
+        const LineTable& table,
+        SortKey key
+) {
+    partialSortLineIndicesByTable(begin, end, end, table, key);
+}
+
+/**
+ * Sorts indices of the lines of the table by the given key partially (see sortLineIndicesByTable and partialSortLineIndices).
+ * @param[in] begin  iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] middle iterator to the end (exclusive) of the range of indices that must be sorted
+ * @param[in] end    iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] table  table of the lines (see buildLineTable)
+ * @param[in] key    key to sort by
+ */
+void partialSortLineIndicesByTable(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator middle,
+        std::vector<size_t>::iterator end,
+        const LineTable& table,
+        SortKey key
+) {
+    assert(table.originalIndices.size() == table.offsets.size());
+
+    // Keys are compared in place, so most comparisons read only one column and don't call compareTableLines.
+    // The pivot is compared with itself too, and equal keys of long lines would make it compare the text
+    const std::vector<uint64_t>& keys = key == SortKey::REVERSE ? table.suffixKeys : table.prefixKeys;
+    bool keysOrder = key != SortKey::LENGTH;
+    partialQuickSort(begin, middle, end, [&table, &keys, keysOrder, key](size_t index1, size_t index2) {
+        if (index1 == index2) return 0;
+        if (keysOrder && keys[index1] != keys[index2]) return keys[index1] < keys[index2] ? -1 : +1;
+        int cmpResult = compareTableLines(table, index1, index2, key);
+        if (cmpResult != 0) return cmpResult;
+
+        uint32_t original1 = table.originalIndices[index1];
+        uint32_t original2 = table.originalIndices[index2];
+        return original1 < original2 ? -1 : (original1 > original2 ? +1 : 0);
+    });
+}
+
+/**
+ * Merges two sorted ranges of indices of Lines into the result in linear time.
+ * If lines are equal, indices from the first range go first.
+ * @param[in]  first   indices sorted with the comparator
+ * @param[in]  second  indices sorted with the comparator
+ * @param[in]  lines   lines that are referenced by indices
+ * @param[in]  compare pointer to the comparator (see sortLines)
+ * @param[out] result  merged indices
+ */
+void mergeLineIndices(
+        const std::vector<size_t>& first,
+        const std::vector<size_t>& second,
+        const std::vector<Line>& lines,
+        int (*compare) (const Line&, const Line&),
+        std::vector<size_t>& result
+) {
+    assert(compare != nullptr);
+
+    result.resize(first.size() + second.size());
+    std::merge(
+            first.begin(), first.end(),
+            second.begin(), second.end(),
+            result.begin(),
+            [&lines, compare](size_t index1, size_t index2) { return compare(lines[index1], lines[index2]) < 0; }
+    );
 }
@@ -6,6 +6,8 @@
 #define POEM_SORTER_SORTLIB_H
 
 #include <vector>
+#include "line_table.h"
+#include "sort_keys.h"
 #include "text_helpers.h"
 
 /**
@@ -18,6 +20,17 @@
  */
 int compareLinesDirect(const Line& str1, const Line& str2);
 
+/**
+ * Compares two Lines in direct order like compareLinesDirect, with letters ordered by the given collation table.
+ * @param[in] str1  first Line to compare
+ * @param[in] str2  second Line to compare
+ * @param[in] table collation table
+ * @return negative number, if first Line is less than second; <br>
+ *         positive number, if first Line is greater than second; <br>
+ *         zero,            if both Lines are equal.
+ */
+int compareLinesDirect(const Line& str1, const Line& str2, const CollationTable& table);
+
 /**
  * Compares two Lines in reverse (from right to left) order. Punctuation and space symbols are skipped - only letters are compared.
  * @param[in] str1 first Line to compare
@@ -28,6 +41,17 @@ int compareLinesDirect(const Line& str1, const Line& str2);
  */
 int compareLinesReverse(const Line& str1, const Line& str2);
 
+/**
+ * Compares two Lines in reverse order like compareLinesReverse, with letters ordered by the given collation table.
+ * @param[in] str1  first Line to compare
+ * @param[in] str2  second Line to compare
+ * @param[in] table collation table
+ * @return negative number, if first Line is less than second; <br>
+ *         positive number, if first Line is greater than second; <br>
+ *         zero,            if both Lines are equal.
+ */
+int compareLinesReverse(const Line& str1, const Line& str2, const CollationTable& table);
+
 /**
  * Sorts vector of Lines with a given comparator.
  * Sort is performed in range [begin; end).
@@ -44,4 +68,157 @@ void sortLines(
         int (*compare) (const Line&, const Line&)
 );
 
+/**
+ * Sorts indices of Lines with a given comparator, so lines[*begin], lines[*(begin + 1)], ... are in sorted order.
+ * Sort is performed in range [begin; end).
+ * @param[in] begin   iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] end     iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] lines   lines that are referenced by indices
+ * @param[in] compare pointer to the comparator. Comparator should return: <br>
+ *                      negative value, if a \< b; <br>
+ *                      positive value, if a \> b; <br>
+ *                      zero,           if a == b.
+ */
+void sortLineIndices(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator end,
+        const std::vector<Line>& lines,
+        int (*compare) (const Line&, const Line&)
+);
+
+/**
+ * Sorts indices of Lines with a given comparator partially, so [begin; middle) contains indices of the smallest lines
+ * in sorted order (see sortLineIndices), and [middle; end) contains the rest of indices in unspecified order.
+ * Lines after middle are never sorted, so selecting first k of n lines takes O(n + k log k) comparisons on average.
+ * @param[in] begin   iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] middle  iterator to the end (exclusive) of the range of indices that must be sorted
+ * @param[in] end     iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] lines   lines that are referenced by indices
+ * @param[in] compare pointer to the comparator (see sortLineIndices)
+ */
+void partialSortLineIndices(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator middle,
+        std::vector<size_t>::iterator end,
+        const std::vector<Line>& lines,
+        int (*compare) (const Line&, const Line&)
+);
+
+/**
+ * Sorts indices of Lines by their keys, so keys[*begin], keys[*(begin + 1)], ... are in sorted order.
+ * Lines with equal keys are ordered by the lines themselves.
+ * Sort is performed in range [begin; end).
+ * @param[in] begin   iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] end     iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] keys    keys of the lines (e.g. key fields, see buildKeyFields)
+ * @param[in] lines   lines that are referenced by indices
+ * @param[in] compare pointer to the comparator of keys and lines (see sortLineIndices)
+ */
+void sortLineIndicesByKeys(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator end,
+        const std::vector<Line>& keys,
+        const std::vector<Line>& lines,
+        int (*compare) (const Line&, const Line&)
+);
+
+/**
+ * Sorts indices of Lines by their keys partially (see sortLineIndicesByKeys and partialSortLineIndices).
+ * @param[in] begin   iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] middle  iterator to the end (exclusive) of the range of indices that must be sorted
+ * @param[in] end     iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] keys    keys of the lines (e.g. key fields, see buildKeyFields)
+ * @param[in] lines   lines that are referenced by indices
+ * @param[in] compare pointer to the comparator of keys and lines (see sortLineIndices)
+ */
+void partialSortLineIndicesByKeys(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator middle,
+        std::vector<size_t>::iterator end,
+        const std::vector<Line>& keys,
+        const std::vector<Line>& lines,
+        int (*compare) (const Line&, const Line&)
+);
+
+/**
+ * Sorts indices of Lines in composite order: by the first key, lines with equal first keys by the second key etc.
+ * Lines that are equal by all keys are ordered by their indices.
+ * Sort is performed in range [begin; end).
+ * @param[in] begin iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] end   iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] keys  materialized keys of the lines (see buildLineKeys)
+ * @param[in] order keys of the composite order
+ */
+void sortLineIndicesByCompositeKeys(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator end,
+        const LineKeys& keys,
+        const std::vector<SortKey>& order
+);
+
+/**
+ * Sorts indices of Lines in composite order partially (see sortLineIndicesByCompositeKeys and partialSortLineIndices).
+ * @param[in] begin  iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] middle iterator to the end (exclusive) of the range of indices that must be sorted
+ * @param[in] end    iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] keys   materialized keys of the lines (see buildLineKeys)
+ * @param[in] order  keys of the composite order
+ */
+void partialSortLineIndicesByCompositeKeys(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator middle,
+        std::vector<size_t>::iterator end,
+        const LineKeys& keys,
+        const std::vector<SortKey>& order
+);
+
+/**
+ * Sorts indices of the lines of the table by the given key (see compareTableLines), so the comparisons read
+ * the compact key columns instead of the text. Lines that are equal by the key are ordered by their original indices.
+ * Sort is performed in range [begin; end).
+ * @param[in] begin iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] end   iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] table table of the lines (see buildLineTable)
+ * @param[in] key   key to sort by
+ */
+void sortLineIndicesByTable(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator end,
+        const LineTable& table,
+        SortKey key
+);
+
+/**
+ * Sorts indices of the lines of the table by the given key partially (see sortLineIndicesByTable and partialSortLineIndices).
+ * @param[in] begin  iterator to the start (inclusive) of the sorting range of indices
+ * @param[in] middle iterator to the end (exclusive) of the range of indices that must be sorted
+ * @param[in] end    iterator to the end (exclusive) ot the sorting range of indices
+ * @param[in] table  table of the lines (see buildLineTable)
+ * @param[in] key    key to sort by
+ */
+void partialSortLineIndicesByTable(
+        std::vector<size_t>::iterator begin,
+        std::vector<size_t>::iterator middle,
+        std::vector<size_t>::iterator end,
+        const LineTable& table,
+        SortKey key
+);
+
+/**
+ * Merges two sorted ranges of indices of Lines into the result in linear time.
+ * If lines are equal, indices from the first range go first.
+ * @param[in]  first   indices sorted with the comparator
+ * @param[in]  second  indices sorted with the comparator
+ * @param[in]  lines   lines that are referenced by indices
+ * @param[in]  compare pointer to the comparator (see sortLines)
+ * @param[out] result  merged indices
+ */
+void mergeLineIndices(
+        const std::vector<size_t>& first,
+        const std::vector<size_t>& second,
+        const std::vector<Line>& lines,
+        int (*compare) (const Line&, const Line&),
+        std::vector<size_t>& result
+);
+
 #endif //POEM_SORTER_SORTLIB_H
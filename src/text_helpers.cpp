@@ -3,7 +3,12 @@
  * @brief Source file with implementation of helper functions for UTF-8 text
  */
 #include <cassert>
+#include "line_filter.h"
 #include "text_helpers.h"
+#include "text_kernels.h"
+
+/** Collation table that is bound for the process (see setCollationTable). **/
+static const CollationTable* collationTable = &DEFAULT_COLLATION_TABLE;
 
 Line::Line(const char* _lineStart, const char* _lineEnd) {
     lineStart = _lineStart;
@@ -40,32 +45,53 @@ bool isRussianAlpha(unsigned char first, unsigned char second) {
 }
 
 /**
- * Gives the size of the letter in bytes. Supports english and russian languages in UTF-8 encoding.
+ * Gives the size of the letter in bytes. Letters are defined by the bound collation table (see setCollationTable).
  * Check is performed in direct order (from left to right).
  * @param[in] first  high byte of the byte pair to check
  * @param[in] second low byte of the byte pair to check
- * @return 2, if the given byte pair form a russian letter in UTF-8; <br>
+ * @return 2, if the given byte pair form a 2-byte letter in UTF-8; <br>
  *         1, if the <b> first </b> byte of the byte pair form an english letter; <br>
  *         0, if the given bytes don't form a letter.
  */
 unsigned short getAlphaSizeDirect(unsigned char first, unsigned char second) {
-    if (isEnglishAlpha(first)) return 1;
-    if (isRussianAlpha(first, second)) return 2;
-    return 0;
+    return getAlphaSizeDirect(first, second, *collationTable);
+}
+
+/**
+ * Gives the size of the letter in bytes like getAlphaSizeDirect, with letters defined by the given collation table.
+ * @param[in] first  high byte of the byte pair to check
+ * @param[in] second low byte of the byte pair to check
+ * @param[in] table  collation table
+ * @return size of the letter (1 or 2) or 0, if the given bytes don't form a letter.
+ */
+unsigned short getAlphaSizeDirect(unsigned char first, unsigned char second, const CollationTable& table) {
+    if (getCollationLetter(table, first, second).code == 0) return 0;
+    return first < 128 ? 1 : 2;
 }
 
 /**
- * Gives the size of the letter in bytes. Supports english and russian languages in UTF-8 encoding.
+ * Gives the size of the letter in bytes. Letters are defined by the bound collation table (see setCollationTable).
  * Check is performed in reverse order (from right to left).
  * @param[in] first  high byte of the byte pair to check
  * @param[in] second low byte of the byte pair to check
- * @return 2, if the given byte pair form a russian letter in UTF-8; <br>
+ * @return 2, if the given byte pair form a 2-byte letter in UTF-8; <br>
  *         1, if the <b> second </b> byte of the byte pair form an english letter; <br>
  *         0, if the given bytes don't form a letter.
  */
 unsigned short getAlphaSizeReverse(unsigned char first, unsigned char second) {
-    if (isRussianAlpha(first, second)) return 2;
-    if (isEnglishAlpha(second)) return 1;
+    return getAlphaSizeReverse(first, second, *collationTable);
+}
+
+/**
+ * Gives the size of the letter in bytes like getAlphaSizeReverse, with letters defined by the given collation table.
+ * @param[in] first  high byte of the byte pair to check
+ * @param[in] second low byte of the byte pair to check
+ * @param[in] table  collation table
+ * @return size of the letter (1 or 2) or 0, if the given bytes don't form a letter.
+ */
+unsigned short getAlphaSizeReverse(unsigned char first, unsigned char second, const CollationTable& table) {
+    if (first >= 128 && getCollationLetter(table, first, second).code != 0) return 2;
+    if (second < 128 && table.asciiLetters[second].code != 0) return 1;
     return 0;
 }
 
@@ -106,6 +132,51 @@ unsigned short getRussianAlphaOrdinal(unsigned char first, unsigned char second)
     return -1;
 }
 
+/**
+ * Binds the collation table that defines letters and their order for all text functions (the default one is bound
+ * at start). Should be called at startup, before texts are processed by other threads.
+ * @param[in] table collation table, it must live until the end of the program (e.g. see findCollationTable)
+ */
+void setCollationTable(const CollationTable& table) {
+    collationTable = &table;
+}
+
+/**
+ * Collation table that is bound for the process (see setCollationTable).
+ * @return bound collation table.
+ */
+const CollationTable& getCollationTable() {
+    return *collationTable;
+}
+
+/**
+ * Gives the collation code of the letter from the bound collation table (see setCollationTable). In the default
+ * collation english letters have codes 1 - 26 (case-insensitive, A - 1, Z - 26), russian letters have codes
+ * 27 - 59 (case-insensitive, А - 27, Я - 59).
+ * Codes are ordered the same way as letters are compared in compareLinesDirect and compareLinesReverse,
+ * so sequences of codes can be compared instead of the letters themselves.
+ * @param[in] letter    pointer to the first byte of the letter
+ * @param[in] alphaSize size of the letter in bytes (1 or 2, see getAlphaSizeDirect)
+ * @return collation code of the letter.
+ */
+unsigned char getAlphaCode(const char* letter, unsigned short alphaSize) {
+    return getAlphaCode(letter, alphaSize, *collationTable);
+}
+
+/**
+ * Gives the collation code of the letter like getAlphaCode, from the given collation table.
+ * @param[in] letter    pointer to the first byte of the letter
+ * @param[in] alphaSize size of the letter in bytes (1 or 2, see getAlphaSizeDirect)
+ * @param[in] table     collation table
+ * @return collation code of the letter.
+ */
+unsigned char getAlphaCode(const char* letter, unsigned short alphaSize, const CollationTable& table) {
+    assert(letter != nullptr);
+    assert(alphaSize == 1 || alphaSize == 2);
+
+    return getCollationLetter(table, *letter, alphaSize == 2 ? *(letter + 1) : '\0').code;
+}
+
 /**
  * Seeks for the next letter between given string pointers.
  * Moves the starting string pointer while seeks for letter.
@@ -115,11 +186,22 @@ unsigned short getRussianAlphaOrdinal(unsigned char first, unsigned char second)
  * @return size of the letter that was found or 0 if there is no letters.
  */
 unsigned short seekAlphaDirect(const char*& strPtr, const char* lineEnd) {
+    return seekAlphaDirect(strPtr, lineEnd, *collationTable);
+}
+
+/**
+ * Seeks for the next letter in direct order like seekAlphaDirect, with letters defined by the given collation table.
+ * @param[in, out] strPtr  pointer to start search from
+ * @param[in]      lineEnd pointer to a last character of the line to search in
+ * @param[in]      table   collation table
+ * @return size of the letter that was found or 0 if there is no letters.
+ */
+unsigned short seekAlphaDirect(const char*& strPtr, const char* lineEnd, const CollationTable& table) {
     assert(strPtr != nullptr);
     assert(lineEnd != nullptr);
 
     unsigned short alphaSize = 0;
-    while (strPtr <= lineEnd && (alphaSize = getAlphaSizeDirect(*strPtr, *(strPtr + 1))) == 0) ++strPtr;
+    while (strPtr <= lineEnd && (alphaSize = getAlphaSizeDirect(*strPtr, *(strPtr + 1), table)) == 0) ++strPtr;
     return alphaSize;
 }
 
@@ -132,14 +214,74 @@ unsigned short seekAlphaDirect(const char*& strPtr, const char* lineEnd) {
  * @return size of the letter that was found or 0 if there is no letters.
  */
 unsigned short seekAlphaReverse(const char*& strPtr, const char* lineStart) {
+    return seekAlphaReverse(strPtr, lineStart, *collationTable);
+}
+
+/**
+ * Seeks for the next letter in reverse order like seekAlphaReverse, with letters defined by the given collation table.
+ * @param[in, out] strPtr    pointer to start search from
+ * @param[in]      lineStart pointer to a first character of the line to search in
+ * @param[in]      table     collation table
+ * @return size of the letter that was found or 0 if there is no letters.
+ */
+unsigned short seekAlphaReverse(const char*& strPtr, const char* lineStart, const CollationTable& table) {
     assert(strPtr != nullptr);
     assert(lineStart != nullptr);
 
     unsigned short alphaSize = 0;
-    while (strPtr >= lineStart && (alphaSize = getAlphaSizeReverse(*(strPtr - 1), *strPtr)) == 0) --strPtr;
+    // Byte before the lineStart doesn't belong to the line (and may not even be readable), so it's never checked
+    while (strPtr >= lineStart
+           && (alphaSize = getAlphaSizeReverse(strPtr > lineStart ? *(strPtr - 1) : '\0', *strPtr, table)) == 0) {
+        --strPtr;
+    }
     return alphaSize;
 }
 
+/**
+ * Seeks for the next letter in reverse order (see seekAlphaReverse) and gives its collation code (see getAlphaCode).
+ * String pointer is moved to the byte before the found letter, so the next call gives the previous letter.
+ * @param[in, out] strPtr    pointer to start search from
+ * @param[in]      lineStart pointer to a first character of the line to search in
+ * @return collation code of the letter that was found or 0 if there is no letters.
+ */
+unsigned char seekAlphaCodeReverse(const char*& strPtr, const char* lineStart) {
+    unsigned short alphaSize = seekAlphaReverse(strPtr, lineStart);
+    if (strPtr < lineStart) return 0;
+
+    strPtr -= alphaSize - 1; // Points to the first byte of the letter
+    unsigned char code = getAlphaCode(strPtr, alphaSize);
+    --strPtr;
+    return code;
+}
+
+/**
+ * Appends collation codes (see getAlphaCode) of all letters of the line in direct order.
+ * @param[in]      line  line to get letters of
+ * @param[in, out] codes vector to append codes to
+ */
+void appendAlphaCodes(const Line& line, std::vector<unsigned char>& codes) {
+    const char* ptr = line.lineStart;
+    unsigned short alphaSize = 0;
+    while ((alphaSize = seekAlphaDirect(ptr, line.lineEnd)) != 0 && ptr <= line.lineEnd) {
+        codes.push_back(getAlphaCode(ptr, alphaSize));
+        ptr += alphaSize;
+    }
+}
+
+/**
+ * Counts '\\n' symbols of the text with the bound vectorized kernel (see getTextKernels), which is much faster
+ * than splitting. The count is an upper bound of the number of lines that splitLines gives, so it's used to size
+ * line tables before splitting.
+ * @param[in] text pointer to a first character of the text
+ * @param[in] size size of the text in bytes
+ * @return number of '\\n' symbols.
+ */
+size_t countNewlines(const char* text, size_t size) {
+    assert(text != nullptr || size == 0);
+
+    return getTextKernels().countNewlines(text, size);
+}
+
 /**
  * Splits the given text by lines (by '\\n' symbols). Empty lines (lines without letters) are removed.
  * Each '\\n' replaced with '\\0'.
@@ -148,31 +290,190 @@ unsigned short seekAlphaReverse(const char*& strPtr, const char* lineStart) {
  * @return vector of Line - pointers to the first and last symbol of the line.
  */
 std::vector<Line> splitLines(char* start, size_t len) {
+    std::vector<Line> lines;
+    splitLines(start, len, lines);
+    return lines;
+}
+
+/**
+ * Checks whether the letter is uppercase.
+ * @param[in] letter    pointer to the first byte of the letter
+ * @param[in] alphaSize size of the letter in bytes (1 or 2, see getAlphaSizeDirect)
+ * @return true, if the letter is uppercase, false otherwise.
+ */
+static bool isUpperAlpha(const char* letter, unsigned short alphaSize) {
+    return getCollationLetter(*collationTable, *letter, alphaSize == 2 ? *(letter + 1) : '\0').upper;
+}
+
+/**
+ * Splits the given text by lines without word boundaries and filtering. Lines are scanned with the bound vectorized
+ * kernels (see getTextKernels): one finds the end of the line, the other one checks that it has letters.
+ * @param[in]  start          pointer to a first character of the text to split
+ * @param[in]  len            length of the text to split
+ * @param[out] lines          vector to store Lines in - pointers to the first and last symbol of the line.
+ * @param[in]  table          collation table that defines letters
+ * @param[in]  terminateLines whether each '\\n' should be replaced with '\\0' (text must be writable then)
+ */
+static void splitLinesVectorized(
+        const char* start,
+        size_t len,
+        std::vector<Line>& lines,
+        const CollationTable& table,
+        bool terminateLines
+) {
+    const TextKernels& kernels = getTextKernels();
+    const char* end = start + len;
+    const char* cur = start;
+    while (cur < end) {
+        const char* lineEnd = cur + kernels.findNewline(cur, end - cur);
+        size_t lineSize = lineEnd - cur;
+        if (kernels.findLetter(cur, lineSize, table) < lineSize) lines.push_back(Line(cur, lineEnd - 1));
+        if (terminateLines) *const_cast<char*>(lineEnd) = '\0';
+        cur = lineEnd + 1;
+    }
+}
+
+/**
+ * Splits the given text by lines, optionally computing word boundaries and filtering lines in the same pass.
+ * Letters and the case of the first letter are found while the line is scanned, so only the substring and the pattern
+ * checks of the filter need to look at the line once more, and only for lines that passed the cheap checks.
+ * @param[in]  start          pointer to a first character of the text to split
+ * @param[in]  len            length of the text to split
+ * @param[out] lines          vector to store Lines in - pointers to the first and last symbol of the line.
+ * @param[out] words          word boundaries of the lines or nullptr if they are not needed
+ * @param[in]  filter         filter of the lines or nullptr if all lines with letters are kept
+ * @param[in]  terminateLines whether each '\\n' should be replaced with '\\0' (text must be writable then)
+ */
+static void splitLinesImpl(
+        const char* start,
+        size_t len,
+        std::vector<Line>& lines,
+        WordTable* words,
+        const LineFilter* filter,
+        bool terminateLines
+) {
     assert(start != nullptr);
 
-    std::vector<Line> lines;
+    lines.clear();
+    if (words != nullptr) {
+        words->lineWordStarts.clear();
+        words->wordBounds.clear();
+    }
+    if (words == nullptr && filter == nullptr) {
+        splitLinesVectorized(start, len, lines, *collationTable, terminateLines);
+        return;
+    }
 
-    char* end = start + len;
-    char* cur = start;
-    bool containsAlpha = false;
+    std::vector<unsigned char> codes;
+    const char* end = start + len;
+    const char* cur = start;
     unsigned short alphaSize = 0;
     while (cur < end) {
-        containsAlpha = false;
+        size_t firstWordBound = words != nullptr ? words->wordBounds.size() : 0;
+        size_t lettersNumber = 0;
+        bool capital = false;
+        bool inWord = false;
         while (cur < end && *cur != '\n') {
             alphaSize = getAlphaSizeDirect(*cur, *(cur + 1));
             if (alphaSize == 0) {
+                if (inWord && words != nullptr) words->wordBounds.push_back(cur - start);
+                inWord = false;
                 ++cur;
             } else {
-                containsAlpha = true;
+                if (lettersNumber == 0) capital = isUpperAlpha(cur, alphaSize);
+                if (!inWord && words != nullptr) words->wordBounds.push_back(cur - start);
+                inWord = true;
+                ++lettersNumber;
                 cur += alphaSize;
             }
         }
-        if (containsAlpha) {
-            lines.emplace_back(start, cur - 1);
+        if (inWord && words != nullptr) words->wordBounds.push_back(cur - start);
+
+        Line line(start, cur - 1);
+        if (lettersNumber > 0 && (filter == nullptr || passesLineFilter(*filter, line, lettersNumber, capital, codes))) {
+            lines.push_back(line);
+            if (words != nullptr) words->lineWordStarts.push_back(firstWordBound / 2);
+        } else if (words != nullptr) {
+            words->wordBounds.resize(firstWordBound);
         }
-        *cur = '\0';
+        if (terminateLines) *const_cast<char*>(cur) = '\0';
         start = ++cur;
     }
+    if (words != nullptr) words->lineWordStarts.push_back(words->wordBounds.size() / 2);
+}
 
-    return lines;
+/**
+ * Splits the given text by lines (by '\\n' symbols) into the given vector. Empty lines (lines without letters) are removed.
+ * Each '\\n' replaced with '\\0'. Vector is cleared before splitting, but its memory is reused.
+ * @param[in]  start pointer to a first character of the text to split
+ * @param[in]  len   length of the text to split
+ * @param[out] lines vector to store Lines in - pointers to the first and last symbol of the line.
+ */
+void splitLines(char* start, size_t len, std::vector<Line>& lines) {
+    splitLinesImpl(start, len, lines, nullptr, nullptr, true);
+}
+
+/**
+ * Splits the given text by lines into the given vector like splitLines, with letters defined by the given
+ * collation table, so lines without its letters are removed.
+ * @param[in]  start pointer to a first character of the text to split
+ * @param[in]  len   length of the text to split
+ * @param[out] lines vector to store Lines in - pointers to the first and last symbol of the line.
+ * @param[in]  table collation table
+ */
+void splitLines(char* start, size_t len, std::vector<Line>& lines, const CollationTable& table) {
+    assert(start != nullptr);
+
+    lines.clear();
+    splitLinesVectorized(start, len, lines, table, true);
+}
+
+/**
+ * Splits the given text by lines like splitLines and computes word boundaries of each line in the same pass.
+ * @param[in]  start pointer to a first character of the text to split
+ * @param[in]  len   length of the text to split
+ * @param[out] lines vector to store Lines in - pointers to the first and last symbol of the line.
+ * @param[out] words word boundaries of the lines
+ */
+void splitLines(char* start, size_t len, std::vector<Line>& lines, WordTable& words) {
+    splitLinesImpl(start, len, lines, &words, nullptr, true);
+}
+
+/**
+ * Splits the given text by lines like splitLines, keeping only lines that pass the filter (see LineFilter).
+ * Filtered out lines are dropped during the same scan, so they never get to the vector.
+ * @param[in]  start  pointer to a first character of the text to split
+ * @param[in]  len    length of the text to split
+ * @param[out] lines  vector to store Lines in - pointers to the first and last symbol of the line.
+ * @param[in]  filter filter of the lines
+ */
+void splitLines(char* start, size_t len, std::vector<Line>& lines, const LineFilter& filter) {
+    splitLinesImpl(start, len, lines, nullptr, &filter, true);
+}
+
+/**
+ * Splits the given text by lines like splitLines, computing word boundaries and keeping only lines that pass
+ * the filter (see LineFilter) in the same pass.
+ * @param[in]  start  pointer to a first character of the text to split
+ * @param[in]  len    length of the text to split
+ * @param[out] lines  vector to store Lines in - pointers to the first and last symbol of the line.
+ * @param[out] words  word boundaries of the kept lines
+ * @param[in]  filter filter of the lines
+ */
+void splitLines(char* start, size_t len, std::vector<Line>& lines, WordTable& words, const LineFilter& filter) {
+    splitLinesImpl(start, len, lines, &words, &filter, true);
+}
+
+/**
+ * Splits the given text by lines like splitLines, but doesn't modify the text: lines are kept as spans only,
+ * so the text may be read-only (e.g. mapped with MappingHints::readOnly) and its pages stay shared with the page cache.
+ * Text must end with '\\n' as well, because letters are checked by byte pairs.
+ * @param[in]  start  pointer to a first character of the text to split
+ * @param[in]  len    length of the text to split
+ * @param[out] lines  vector to store Lines in - pointers to the first and last symbol of the line.
+ * @param[out] words  word boundaries of the kept lines or nullptr if they are not needed
+ * @param[in]  filter filter of the lines or nullptr if all lines with letters are kept
+ */
+void splitLinesReadOnly(const char* start, size_t len, std::vector<Line>& lines, WordTable* words, const LineFilter* filter) {
+    splitLinesImpl(start, len, lines, words, filter, false);
 }
@@ -6,7 +6,12 @@
 #define POEM_SORTER_TEXT_HELPERS_H
 
 #include <cctype>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
+#include "collation.h"
+
+struct LineFilter;
 
 /**
  * Structure that contains a line of text. Line has a pointer to it's first and last characters.
@@ -19,6 +24,16 @@ struct Line {
     Line(const char* _lineStart, const char* _lineEnd);
 };
 
+/**
+ * Word boundaries of the split lines. Word is a maximal sequence of letters (see seekAlphaDirect).
+ * Words of the line i are words lineWordStarts[i], ..., lineWordStarts[i + 1] - 1. Word j starts at byte
+ * wordBounds[2 * j] and ends before byte wordBounds[2 * j + 1] (offsets are from the start of its line).
+ */
+struct WordTable {
+    std::vector<uint32_t> lineWordStarts; /**< index of the first word of each line, last element is number of words */
+    std::vector<uint32_t> wordBounds;     /**< start and end offsets of each word */
+};
+
 /**
  * Checks if the given character is an english letter (lowercase or uppercase).
  * @param[in] c character to check
@@ -35,27 +50,45 @@ bool isEnglishAlpha(unsigned char c);
 bool isRussianAlpha(unsigned char first, unsigned char second);
 
 /**
- * Gives the size of the letter in bytes. Supports english and russian languages in UTF-8 encoding.
+ * Gives the size of the letter in bytes. Letters are defined by the bound collation table (see setCollationTable).
  * Check is performed in direct order (from left to right).
  * @param[in] first  high byte of the byte pair to check
  * @param[in] second low byte of the byte pair to check
- * @return 2, if the given byte pair form a russian letter in UTF-8; <br>
+ * @return 2, if the given byte pair form a 2-byte letter in UTF-8; <br>
  *         1, if the <b> first </b> byte of the byte pair form an english letter; <br>
  *         0, if the given bytes don't form a letter.
  */
 unsigned short getAlphaSizeDirect(unsigned char first, unsigned char second);
 
 /**
- * Gives the size of the letter in bytes. Supports english and russian languages in UTF-8 encoding.
+ * Gives the size of the letter in bytes like getAlphaSizeDirect, with letters defined by the given collation table.
+ * @param[in] first  high byte of the byte pair to check
+ * @param[in] second low byte of the byte pair to check
+ * @param[in] table  collation table
+ * @return size of the letter (1 or 2) or 0, if the given bytes don't form a letter.
+ */
+unsigned short getAlphaSizeDirect(unsigned char first, unsigned char second, const CollationTable& table);
+
+/**
+ * Gives the size of the letter in bytes. Letters are defined by the bound collation table (see setCollationTable).
  * Check is performed in reverse order (from right to left).
  * @param[in] first  high byte of the byte pair to check
  * @param[in] second low byte of the byte pair to check
- * @return 2, if the given byte pair form a russian letter in UTF-8; <br>
+ * @return 2, if the given byte pair form a 2-byte letter in UTF-8; <br>
  *         1, if the <b> second </b> byte of the byte pair form an english letter; <br>
  *         0, if the given bytes don't form a letter.
  */
 unsigned short getAlphaSizeReverse(unsigned char first, unsigned char second);
 
+/**
+ * Gives the size of the letter in bytes like getAlphaSizeReverse, with letters defined by the given collation table.
+ * @param[in] first  high byte of the byte pair to check
+ * @param[in] second low byte of the byte pair to check
+ * @param[in] table  collation table
+ * @return size of the letter (1 or 2) or 0, if the given bytes don't form a letter.
+ */
+unsigned short getAlphaSizeReverse(unsigned char first, unsigned char second, const CollationTable& table);
+
 /**
  * Gives the zero-based ordinal of the russian letter in UTF-8 encoding (e.g. А - 0, Б - 1, Я - 32).
  * @param[in] first  high byte of the byte pair to check
@@ -65,29 +98,68 @@ unsigned short getAlphaSizeReverse(unsigned char first, unsigned char second);
 unsigned short getRussianAlphaOrdinal(unsigned char first, unsigned char second);
 
 /**
- * Compares two english letters.
- * @param[in] c1 first letter to compare
- * @param[in] c2 second letter to compare.
+ * Binds the collation table that defines letters and their order for all text functions (the default one is bound
+ * at start). Should be called at startup, before texts are processed by other threads.
+ * @param[in] table collation table, it must live until the end of the program (e.g. see findCollationTable)
+ */
+void setCollationTable(const CollationTable& table);
+
+/**
+ * Collation table that is bound for the process (see setCollationTable).
+ * @return bound collation table.
+ */
+const CollationTable& getCollationTable();
+
+/**
+ * Gives the collation code of the letter from the bound collation table (see setCollationTable). In the default
+ * collation english letters have codes 1 - 26 (case-insensitive, A - 1, Z - 26), russian letters have codes
+ * 27 - 59 (case-insensitive, А - 27, Я - 59).
+ * Codes are ordered the same way as letters are compared in compareLinesDirect and compareLinesReverse,
+ * so sequences of codes can be compared instead of the letters themselves.
+ * @param[in] letter    pointer to the first byte of the letter
+ * @param[in] alphaSize size of the letter in bytes (1 or 2, see getAlphaSizeDirect)
+ * @return collation code of the letter.
+ */
+unsigned char getAlphaCode(const char* letter, unsigned short alphaSize);
+
+/**
+ * Gives the collation code of the letter like getAlphaCode, from the given collation table.
+ * @param[in] letter    pointer to the first byte of the letter
+ * @param[in] alphaSize size of the letter in bytes (1 or 2, see getAlphaSizeDirect)
+ * @param[in] table     collation table
+ * @return collation code of the letter.
+ */
+unsigned char getAlphaCode(const char* letter, unsigned short alphaSize, const CollationTable& table);
+
+/**
+ * Compares two letters by their collation codes (see getAlphaCode).
+ * @param[in] letter1    pointer to the first byte of the first letter
+ * @param[in] alphaSize1 size of the first letter in bytes
+ * @param[in] letter2    pointer to the first byte of the second letter
+ * @param[in] alphaSize2 size of the second letter in bytes
  * @return negative number, if first letter is less than second; <br>
  *         positive number, if first letter is greater than second; <br>
  *         zero,            if both letters are equal.
  */
-inline int compareEnglishAlphas(unsigned char c1, unsigned char c2) {
-    return tolower(c1) - tolower(c2);
+inline int compareAlphas(const char* letter1, unsigned short alphaSize1, const char* letter2, unsigned short alphaSize2) {
+    return getAlphaCode(letter1, alphaSize1) - getAlphaCode(letter2, alphaSize2);
 }
 
 /**
- * Compares two russian letters in UTF-8 encoding.
- * @param[in] first1  high byte of the first letter
- * @param[in] second1 low byte of the first letter
- * @param[in] first2  high byte of the second letter
- * @param[in] second2 low byte of the second letter
- * @return negative number, if first letter is less than second; <br>
- *         positive number, if first letter is greater than second; <br>
- *         zero,            if both letters are equal.
+ * Compares two letters by their collation codes from the given collation table (see compareAlphas).
+ * @param[in] letter1    pointer to the first byte of the first letter
+ * @param[in] alphaSize1 size of the first letter in bytes
+ * @param[in] letter2    pointer to the first byte of the second letter
+ * @param[in] alphaSize2 size of the second letter in bytes
+ * @param[in] table      collation table
+ * @return negative, positive or zero number, like compareAlphas.
  */
-inline int compareRussianAlphas(unsigned char first1, unsigned char second1, unsigned char first2, unsigned char second2) {
-    return getRussianAlphaOrdinal(first1, second1) - getRussianAlphaOrdinal(first2, second2);
+inline int compareAlphas(
+        const char* letter1, unsigned short alphaSize1,
+        const char* letter2, unsigned short alphaSize2,
+        const CollationTable& table
+) {
+    return getAlphaCode(letter1, alphaSize1, table) - getAlphaCode(letter2, alphaSize2, table);
 }
 
 /**
@@ -100,6 +172,15 @@ inline int compareRussianAlphas(unsigned char first1, unsigned char second1, uns
  */
 unsigned short seekAlphaDirect(const char*& strPtr, const char* lineEnd);
 
+/**
+ * Seeks for the next letter in direct order like seekAlphaDirect, with letters defined by the given collation table.
+ * @param[in, out] strPtr  pointer to start search from
+ * @param[in]      lineEnd pointer to a last character of the line to search in
+ * @param[in]      table   collation table
+ * @return size of the letter that was found or 0 if there is no letters.
+ */
+unsigned short seekAlphaDirect(const char*& strPtr, const char* lineEnd, const CollationTable& table);
+
 /**
  * Seeks for the next letter between given string pointers.
  * Moves the starting string pointer while seeks for letter.
@@ -110,6 +191,41 @@ unsigned short seekAlphaDirect(const char*& strPtr, const char* lineEnd);
  */
 unsigned short seekAlphaReverse(const char*& strPtr, const char* lineStart);
 
+/**
+ * Seeks for the next letter in reverse order like seekAlphaReverse, with letters defined by the given collation table.
+ * @param[in, out] strPtr    pointer to start search from
+ * @param[in]      lineStart pointer to a first character of the line to search in
+ * @param[in]      table     collation table
+ * @return size of the letter that was found or 0 if there is no letters.
+ */
+unsigned short seekAlphaReverse(const char*& strPtr, const char* lineStart, const CollationTable& table);
+
+/**
+ * Seeks for the next letter in reverse order (see seekAlphaReverse) and gives its collation code (see getAlphaCode).
+ * String pointer is moved to the byte before the found letter, so the next call gives the previous letter.
+ * @param[in, out] strPtr    pointer to start search from
+ * @param[in]      lineStart pointer to a first character of the line to search in
+ * @return collation code of the letter that was found or 0 if there is no letters.
+ */
+unsigned char seekAlphaCodeReverse(const char*& strPtr, const char* lineStart);
+
+/**
+ * Appends collation codes (see getAlphaCode) of all letters of the line in direct order.
+ * @param[in]      line  line to get letters of
+ * @param[in, out] codes vector to append codes to
+ */
+void appendAlphaCodes(const Line& line, std::vector<unsigned char>& codes);
+
+/**
+ * Counts '\\n' symbols of the text with the bound vectorized kernel (see getTextKernels), which is much faster
+ * than splitting. The count is an upper bound of the number of lines that splitLines gives, so it's used to size
+ * line tables before splitting.
+ * @param[in] text pointer to a first character of the text
+ * @param[in] size size of the text in bytes
+ * @return number of '\\n' symbols.
+ */
+size_t countNewlines(const char* text, size_t size);
+
 /**
  * Splits the given text by lines (by '\\n' symbols). Empty lines (lines without letters) are removed.
  * Each '\\n' replaced with '\\0'.
@@ -119,4 +235,71 @@ unsigned short seekAlphaReverse(const char*& strPtr, const char* lineStart);
  */
 std::vector<Line> splitLines(char* start, size_t len);
 
+/**
+ * Splits the given text by lines (by '\\n' symbols) into the given vector. Empty lines (lines without letters) are removed.
+ * Each '\\n' replaced with '\\0'. Vector is cleared before splitting, but its memory is reused.
+ * @param[in]  start pointer to a first character of the text to split
+ * @param[in]  len   length of the text to split
+ * @param[out] lines vector to store Lines in - pointers to the first and last symbol of the line.
+ */
+void splitLines(char* start, size_t len, std::vector<Line>& lines);
+
+/**
+ * Splits the given text by lines into the given vector like splitLines, with letters defined by the given
+ * collation table, so lines without its letters are removed.
+ * @param[in]  start pointer to a first character of the text to split
+ * @param[in]  len   length of the text to split
+ * @param[out] lines vector to store Lines in - pointers to the first and last symbol of the line.
+ * @param[in]  table collation table
+ */
+void splitLines(char* start, size_t len, std::vector<Line>& lines, const CollationTable& table);
+
+/**
+ * Splits the given text by lines like splitLines and computes word boundaries of each line in the same pass.
+ * @param[in]  start pointer to a first character of the text to split
+ * @param[in]  len   length of the text to split
+ * @param[out] lines vector to store Lines in - pointers to the first and last symbol of the line.
+ * @param[out] words word boundaries of the lines
+ */
+void splitLines(char* start, size_t len, std::vector<Line>& lines, WordTable& words);
+
+/**
+ * Splits the given text by lines like splitLines, keeping only lines that pass the filter (see LineFilter).
+ * Filtered out lines are dropped during the same scan, so they never get to the vector.
+ * @param[in]  start  pointer to a first character of the text to split
+ * @param[in]  len    length of the text to split
+ * @param[out] lines  vector to store Lines in - pointers to the first and last symbol of the line.
+ * @param[in]  filter filter of the lines
+ */
+void splitLines(char* start, size_t len, std::vector<Line>& lines, const LineFilter& filter);
+
+/**
+ * Splits the given text by lines like splitLines, computing word boundaries and keeping only lines that pass
+ * the filter (see LineFilter) in the same pass.
+ * @param[in]  start  pointer to a first character of the text to split
+ * @param[in]  len    length of the text to split
+ * @param[out] lines  vector to store Lines in - pointers to the first and last symbol of the line.
+ * @param[out] words  word boundaries of the kept lines
+ * @param[in]  filter filter of the lines
+ */
+void splitLines(char* start, size_t len, std::vector<Line>& lines, WordTable& words, const LineFilter& filter);
+
+/**
+ * Splits the given text by lines like splitLines, but doesn't modify the text: lines are kept as spans only,
+ * so the text may be read-only (e.g. mapped with MappingHints::readOnly) and its pages stay shared with the page cache.
+ * Text must end with '\\n' as well, because letters are checked by byte pairs.
+ * @param[in]  start  pointer to a first character of the text to split
+ * @param[in]  len    length of the text to split
+ * @param[out] lines  vector to store Lines in - pointers to the first and last symbol of the line.
+ * @param[out] words  word boundaries of the kept lines or nullptr if they are not needed
+ * @param[in]  filter filter of the lines or nullptr if all lines with letters are kept
+ */
+void splitLinesReadOnly(
+        const char* start,
+        size_t len,
+        std::vector<Line>& lines,
+        WordTable* words = nullptr,
+        const LineFilter* filter = nullptr
+);
+
 #endif //POEM_SORTER_TEXT_HELPERS_H
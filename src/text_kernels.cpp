@@ -0,0 +1,636 @@
+/**
+ * @file
+ * @brief Source file with vectorized text kernels and their runtime dispatch by CPU features
+ *
+ * Variants of the kernels are compiled with target attributes instead of compiler flags, so the rest
+ * of the program stays runnable on any CPU and only the bound variant uses newer instructions.
+ */
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include "text_helpers.h"
+#include "text_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+/** Whether the vectorized x86 variants of the kernels are built. **/
+#define TEXT_KERNELS_X86 1
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+// Scalar kernels (they also process the tails of the vectorized ones)
+//----------------------------------------------------------------------------------------------------------------------
+
+// Kernels are documented in TextKernels, variants of one kernel differ only in the instructions they use
+
+static size_t countNewlinesScalar(const char* text, size_t size) {
+    size_t count = 0;
+    const char* end = text + size;
+    while (text < end && (text = static_cast<const char*>(memchr(text, '\n', end - text))) != nullptr) {
+        ++count;
+        ++text;
+    }
+    return count;
+}
+
+static size_t findNewlineScalar(const char* text, size_t size) {
+    const void* newline = memchr(text, '\n', size);
+    return newline != nullptr ? static_cast<const char*>(newline) - text : size;
+}
+
+static size_t findLetterScalar(const char* text, size_t size, const CollationTable& table) {
+    for (size_t i = 0; i < size; ++i) {
+        if (getAlphaSizeDirect(text[i], i + 1 < size ? text[i + 1] : '\0', table) != 0) return i;
+    }
+    return size;
+}
+
+/**
+ * Size of the valid UTF-8 sequence (RFC 3629: no overlong forms, no surrogates, no code points above U+10FFFF).
+ * @param[in] ptr  pointer to the first byte of the sequence
+ * @param[in] size number of bytes from the pointer to the text end (at least 1)
+ * @return size of the sequence (1 - 4) or 0, if it's invalid or cut by the text end.
+ */
+static inline size_t getUtf8SequenceSize(const char* ptr, size_t size) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(ptr);
+    unsigned char lead = bytes[0];
+    if (lead < 0x80) return 1;
+
+    size_t sequenceSize = 0;
+    unsigned char secondMin = 0x80;
+    unsigned char secondMax = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        sequenceSize = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        sequenceSize = 3;
+        if (lead == 0xE0) secondMin = 0xA0; // Overlong forms
+        if (lead == 0xED) secondMax = 0x9F; // Surrogates
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        sequenceSize = 4;
+        if (lead == 0xF0) secondMin = 0x90; // Overlong forms
+        if (lead == 0xF4) secondMax = 0x8F; // Code points above U+10FFFF
+    } else {
+        return 0;
+    }
+
+    if (size < sequenceSize || bytes[1] < secondMin || bytes[1] > secondMax) return 0;
+    for (size_t i = 2; i < sequenceSize; ++i) {
+        if ((bytes[i] & 0xC0) != 0x80) return 0;
+    }
+    return sequenceSize;
+}
+
+static size_t findInvalidUtf8Scalar(const char* text, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        size_t sequenceSize = getUtf8SequenceSize(text + i, size - i);
+        if (sequenceSize == 0) return i;
+        i += sequenceSize;
+    }
+    return size;
+}
+
+#ifdef TEXT_KERNELS_X86
+
+// Letters are found by the positions of their first bytes: english letters (they are the same in every collation
+// table) are found by byte ranges, 2-byte UTF-8 sequences (lead byte 0xC0 - 0xDF followed by continuation byte
+// 0x80 - 0xBF) are looked up in the bound collation table. Second bytes are loaded with the offset of one byte.
+
+/**
+ * Finds the first letter of the block.
+ * @param[in] ptr     pointer to the block start
+ * @param[in] english mask of the positions of english letters in the block
+ * @param[in] twoByte mask of the positions of 2-byte UTF-8 sequences in the block
+ * @param[in] table   collation table
+ * @return position of the first letter or 64, if the block has no letters.
+ */
+static inline size_t findBlockLetter(const char* ptr, uint64_t english, uint64_t twoByte, const CollationTable& table) {
+    // Only the sequences before the first english letter are looked up
+    uint64_t candidates = twoByte & ((english & -english) - 1);
+    while (candidates != 0) {
+        size_t position = __builtin_ctzll(candidates);
+        if (getCollationLetter(table, ptr[position], ptr[position + 1]).code != 0) return position;
+        candidates &= candidates - 1;
+    }
+    return english != 0 ? __builtin_ctzll(english) : 64;
+}
+
+// UTF-8 is validated by the lookup algorithm of Keiser and Lemire ("Validating UTF-8 In Less Than One Instruction
+// Per Byte"): errors of each byte pair are looked up by the high and low nibbles of the first byte and the high nibble
+// of the second one, and the results are intersected. Vectorized variants only check blocks, the first invalid
+// sequence of the failed block is found by the narrower variant, starting from the sequence that may continue
+// into the block (see findSequenceStart).
+
+/** Lead byte followed by a non-continuation byte, or sequence cut by the text end. **/
+static constexpr uint8_t UTF8_TOO_SHORT = 1 << 0;
+/** ASCII byte followed by a continuation byte. **/
+static constexpr uint8_t UTF8_TOO_LONG = 1 << 1;
+/** Overlong form of a 3-byte sequence (0xE0 followed by 0x80 - 0x9F). **/
+static constexpr uint8_t UTF8_OVERLONG_3 = 1 << 2;
+/** Code point above U+10FFFF (0xF4 followed by 0x90 - 0xBF, or lead byte 0xF5 - 0xFF). **/
+static constexpr uint8_t UTF8_TOO_LARGE = 1 << 3;
+/** Surrogate (0xED followed by 0xA0 - 0xBF). **/
+static constexpr uint8_t UTF8_SURROGATE = 1 << 4;
+/** Overlong form of a 2-byte sequence (lead byte 0xC0 or 0xC1). **/
+static constexpr uint8_t UTF8_OVERLONG_2 = 1 << 5;
+/** Code point above U+10FFFF (lead byte 0xF5 - 0xFF followed by 0x80 - 0x8F), shares the bit with UTF8_OVERLONG_4. **/
+static constexpr uint8_t UTF8_TOO_LARGE_1000 = 1 << 6;
+/** Overlong form of a 4-byte sequence (0xF0 followed by 0x80 - 0x8F). **/
+static constexpr uint8_t UTF8_OVERLONG_4 = 1 << 6;
+/** Two continuation bytes, which is an error unless they belong to a 3- or 4-byte sequence. **/
+static constexpr uint8_t UTF8_TWO_CONTS = 1 << 7;
+/** Errors that any low nibble of the first byte allows. **/
+static constexpr uint8_t UTF8_CARRY = UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS;
+
+/** Errors of the byte pair by the high nibble of the first byte. **/
+alignas(16) static const uint8_t UTF8_FIRST_HIGH_ERRORS[16] = {
+        // 0___ (ASCII)
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        // 10__ (continuation)
+        UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+        // 1100, 1101 (lead of 2 bytes)
+        UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+        UTF8_TOO_SHORT,
+        // 1110 (lead of 3 bytes)
+        UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+        // 1111 (lead of 4 bytes)
+        UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+};
+
+/** Errors of the byte pair by the low nibble of the first byte. **/
+alignas(16) static const uint8_t UTF8_FIRST_LOW_ERRORS[16] = {
+        UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+        UTF8_CARRY | UTF8_OVERLONG_2,
+        UTF8_CARRY,
+        UTF8_CARRY,
+        UTF8_CARRY | UTF8_TOO_LARGE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+};
+
+/** Errors of the byte pair by the high nibble of the second byte. **/
+alignas(16) static const uint8_t UTF8_SECOND_HIGH_ERRORS[16] = {
+        // 0___ (ASCII)
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        // 1000
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+        // 1001
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+        // 101_
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        // 11__ (lead)
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+};
+
+/**
+ * Start of the UTF-8 sequence that may continue at the offset. Bytes before the offset must be validated,
+ * except for the last sequence, which may be cut by the offset.
+ * @param[in] text   pointer to a first character of the text
+ * @param[in] offset offset in the text
+ * @return offset of the lead byte among three bytes before the offset, or the offset, if there is no one.
+ */
+static inline size_t findSequenceStart(const char* text, size_t offset) {
+    for (size_t back = 1; back <= 3 && back <= offset; ++back) {
+        unsigned char byte = text[offset - back];
+        if (byte >= 0xC0) return offset - back;
+        if (byte < 0x80) break;
+    }
+    return offset;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// SSE2 kernels
+//----------------------------------------------------------------------------------------------------------------------
+
+__attribute__((target("sse2")))
+static inline __m128i inRange128(__m128i bytes, char low, char span) {
+    __m128i shifted = _mm_sub_epi8(bytes, _mm_set1_epi8(low));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(span)), shifted);
+}
+
+__attribute__((target("sse2")))
+static inline size_t findBlockLetter128(const char* ptr, const CollationTable& table) {
+    __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 1));
+    __m128i lower = _mm_or_si128(first, _mm_set1_epi8(0x20));
+    __m128i english = _mm_and_si128(
+            _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+            _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1))
+    );
+    __m128i twoByte = _mm_and_si128(inRange128(first, char(0xC0), 0x1F), inRange128(second, char(0x80), 0x3F));
+    return findBlockLetter(ptr, _mm_movemask_epi8(english), _mm_movemask_epi8(twoByte), table);
+}
+
+__attribute__((target("sse2")))
+static unsigned int newlineMask128(const char* ptr) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')));
+}
+
+__attribute__((target("sse2")))
+static size_t countNewlinesSse2(const char* text, size_t size) {
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        count += __builtin_popcount(newlineMask128(text + i));
+    }
+    return count + countNewlinesScalar(text + i, size - i);
+}
+
+__attribute__((target("sse2")))
+static size_t findNewlineSse2(const char* text, size_t size) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        unsigned int mask = newlineMask128(text + i);
+        if (mask != 0) return i + __builtin_ctz(mask);
+    }
+    return i + findNewlineScalar(text + i, size - i);
+}
+
+__attribute__((target("sse2")))
+static size_t findLetterSse2(const char* text, size_t size, const CollationTable& table) {
+    size_t i = 0;
+    for (; i + 16 < size; i += 16) {
+        size_t position = findBlockLetter128(text + i, table);
+        if (position < 16) return i + position;
+    }
+    return i + findLetterScalar(text + i, size - i, table);
+}
+
+__attribute__((target("sse2")))
+static size_t findInvalidUtf8Sse2(const char* text, size_t size) {
+    // SSE2 has no byte shuffles, so only ASCII blocks are skipped, and other sequences are checked one by one
+    size_t i = 0;
+    while (i + 16 <= size) {
+        unsigned int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i)));
+        if (mask == 0) {
+            i += 16;
+            continue;
+        }
+        i += __builtin_ctz(mask);
+        size_t sequenceSize = getUtf8SequenceSize(text + i, size - i);
+        if (sequenceSize == 0) return i;
+        i += sequenceSize;
+    }
+    return i + findInvalidUtf8Scalar(text + i, size - i);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// AVX2 kernels
+//----------------------------------------------------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+static inline __m256i inRange256(__m256i bytes, char low, char span) {
+    __m256i shifted = _mm256_sub_epi8(bytes, _mm256_set1_epi8(low));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(span)), shifted);
+}
+
+__attribute__((target("avx2")))
+static inline size_t findBlockLetter256(const char* ptr, const CollationTable& table) {
+    __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + 1));
+    __m256i lower = _mm256_or_si256(first, _mm256_set1_epi8(0x20));
+    __m256i english = _mm256_and_si256(
+            _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower)
+    );
+    __m256i twoByte = _mm256_and_si256(inRange256(first, char(0xC0), 0x1F), inRange256(second, char(0x80), 0x3F));
+    return findBlockLetter(
+            ptr,
+            static_cast<unsigned int>(_mm256_movemask_epi8(english)),
+            static_cast<unsigned int>(_mm256_movemask_epi8(twoByte)),
+            table
+    );
+}
+
+__attribute__((target("avx2")))
+static unsigned int newlineMask256(const char* ptr) {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')));
+}
+
+__attribute__((target("avx2")))
+static size_t countNewlinesAvx2(const char* text, size_t size) {
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        count += __builtin_popcount(newlineMask256(text + i));
+    }
+    return count + countNewlinesScalar(text + i, size - i);
+}
+
+__attribute__((target("avx2")))
+static size_t findNewlineAvx2(const char* text, size_t size) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        unsigned int mask = newlineMask256(text + i);
+        if (mask != 0) return i + __builtin_ctz(mask);
+    }
+    return i + findNewlineSse2(text + i, size - i);
+}
+
+__attribute__((target("avx2")))
+static size_t findLetterAvx2(const char* text, size_t size, const CollationTable& table) {
+    size_t i = 0;
+    for (; i + 32 < size; i += 32) {
+        size_t position = findBlockLetter256(text + i, table);
+        if (position < 32) return i + position;
+    }
+    return i + findLetterSse2(text + i, size - i, table);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i lookup256(const uint8_t* table, __m256i indices) {
+    return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(table))), indices);
+}
+
+/**
+ * Finds UTF-8 errors of the block.
+ * @param[in] input    block
+ * @param[in] previous previous block (zeros for the first one)
+ * @return non-zero bytes at the positions of errors.
+ */
+__attribute__((target("avx2")))
+static inline __m256i getUtf8Errors256(__m256i input, __m256i previous) {
+    // Last 16 bytes of the previous block and first 16 bytes of the input, so bytes before the input ones are aligned
+    __m256i carried = _mm256_permute2x128_si256(previous, input, 0x21);
+    __m256i prev1 = _mm256_alignr_epi8(input, carried, 15);
+    __m256i prev2 = _mm256_alignr_epi8(input, carried, 14);
+    __m256i prev3 = _mm256_alignr_epi8(input, carried, 13);
+    __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i errors = _mm256_and_si256(
+            _mm256_and_si256(
+                    lookup256(UTF8_FIRST_HIGH_ERRORS, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                    lookup256(UTF8_FIRST_LOW_ERRORS, _mm256_and_si256(prev1, nibble))
+            ),
+            lookup256(UTF8_SECOND_HIGH_ERRORS, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble))
+    );
+    // Two continuation bytes are expected after the second byte of 3-byte sequences and the third byte of 4-byte ones
+    __m256i expectedContinuations = _mm256_or_si256(
+            _mm256_subs_epu8(prev2, _mm256_set1_epi8(char(0xE0 - 0x80))),
+            _mm256_subs_epu8(prev3, _mm256_set1_epi8(char(0xF0 - 0x80)))
+    );
+    return _mm256_xor_si256(errors, _mm256_and_si256(expectedContinuations, _mm256_set1_epi8(char(0x80))));
+}
+
+__attribute__((target("avx2")))
+static size_t findInvalidUtf8Avx2(const char* text, size_t size) {
+    size_t i = 0;
+    __m256i previous = _mm256_setzero_si256();
+    for (; i + 32 <= size; i += 32) {
+        __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+        __m256i errors = getUtf8Errors256(input, previous);
+        if (!_mm256_testz_si256(errors, errors)) break;
+        previous = input;
+    }
+    size_t start = findSequenceStart(text, i);
+    return start + findInvalidUtf8Sse2(text + start, size - start);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// AVX-512 kernels (tails are read with masked loads, which don't touch the masked out bytes)
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Mask of the first bytes of the 64-byte block.
+ * @param[in] size number of bytes
+ * @return mask with the lowest min(size, 64) bits set.
+ */
+static inline uint64_t getBlockMask(size_t size) {
+    return size >= 64 ? ~uint64_t(0) : (uint64_t(1) << size) - 1;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static inline __m512i loadBlock512(const char* ptr, size_t size) {
+    return _mm512_maskz_loadu_epi8(getBlockMask(size), ptr);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static inline size_t findBlockLetter512(const char* ptr, size_t size, const CollationTable& table) {
+    __m512i first = loadBlock512(ptr, size);
+    // Byte after the block is zero, if it's outside of the text, so a letter can't be cut by the text end
+    __m512i second = loadBlock512(ptr + 1, size - 1);
+    __m512i lower = _mm512_or_si512(first, _mm512_set1_epi8(0x20));
+    uint64_t english = _mm512_cmpgt_epi8_mask(lower, _mm512_set1_epi8('a' - 1))
+                     & _mm512_cmplt_epi8_mask(lower, _mm512_set1_epi8('z' + 1));
+    uint64_t twoByte = _mm512_cmple_epu8_mask(_mm512_sub_epi8(first, _mm512_set1_epi8(char(0xC0))), _mm512_set1_epi8(0x1F))
+                     & _mm512_cmple_epu8_mask(_mm512_sub_epi8(second, _mm512_set1_epi8(char(0x80))), _mm512_set1_epi8(0x3F));
+    uint64_t blockMask = getBlockMask(size);
+    return findBlockLetter(ptr, english & blockMask, twoByte & blockMask, table);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static size_t countNewlinesAvx512(const char* text, size_t size) {
+    size_t count = 0;
+    for (size_t i = 0; i < size; i += 64) {
+        count += __builtin_popcountll(_mm512_cmpeq_epi8_mask(loadBlock512(text + i, size - i), _mm512_set1_epi8('\n')));
+    }
+    return count;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static size_t findNewlineAvx512(const char* text, size_t size) {
+    for (size_t i = 0; i < size; i += 64) {
+        // Masked out bytes are zero, so they are never '\n'
+        uint64_t mask = _mm512_cmpeq_epi8_mask(loadBlock512(text + i, size - i), _mm512_set1_epi8('\n'));
+        if (mask != 0) return i + __builtin_ctzll(mask);
+    }
+    return size;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static size_t findLetterAvx512(const char* text, size_t size, const CollationTable& table) {
+    for (size_t i = 0; i < size; i += 64) {
+        size_t position = findBlockLetter512(text + i, size - i, table);
+        if (position < 64) return i + position;
+    }
+    return size;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static inline __m512i lookup512(const uint8_t* table, __m512i indices) {
+    // Zero-masked broadcast, the unmasked one leaves its source undefined and breaks optimized builds with -Werror
+    __m512i lanes = _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_load_si128(reinterpret_cast<const __m128i*>(table)));
+    return _mm512_shuffle_epi8(lanes, indices);
+}
+
+/**
+ * Finds UTF-8 errors of the block (see getUtf8Errors256).
+ * @param[in] input    block
+ * @param[in] previous previous block (zeros for the first one)
+ * @return mask of the positions of errors.
+ */
+__attribute__((target("avx512f,avx512bw")))
+static inline uint64_t getUtf8Errors512(__m512i input, __m512i previous) {
+    // Last 16 bytes of the previous block and first 48 bytes of the input
+    __m512i carried = _mm512_permutex2var_epi64(previous, _mm512_set_epi64(13, 12, 11, 10, 9, 8, 7, 6), input);
+    __m512i prev1 = _mm512_alignr_epi8(input, carried, 15);
+    __m512i prev2 = _mm512_alignr_epi8(input, carried, 14);
+    __m512i prev3 = _mm512_alignr_epi8(input, carried, 13);
+    __m512i nibble = _mm512_set1_epi8(0x0F);
+    __m512i errors = _mm512_and_si512(
+            _mm512_and_si512(
+                    lookup512(UTF8_FIRST_HIGH_ERRORS, _mm512_and_si512(_mm512_srli_epi16(prev1, 4), nibble)),
+                    lookup512(UTF8_FIRST_LOW_ERRORS, _mm512_and_si512(prev1, nibble))
+            ),
+            lookup512(UTF8_SECOND_HIGH_ERRORS, _mm512_and_si512(_mm512_srli_epi16(input, 4), nibble))
+    );
+    __m512i expectedContinuations = _mm512_or_si512(
+            _mm512_subs_epu8(prev2, _mm512_set1_epi8(char(0xE0 - 0x80))),
+            _mm512_subs_epu8(prev3, _mm512_set1_epi8(char(0xF0 - 0x80)))
+    );
+    errors = _mm512_xor_si512(errors, _mm512_and_si512(expectedContinuations, _mm512_set1_epi8(char(0x80))));
+    return _mm512_test_epi8_mask(errors, errors);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static size_t findInvalidUtf8Avx512(const char* text, size_t size) {
+    size_t i = 0;
+    __m512i previous = _mm512_setzero_si512();
+    for (; i < size; i += 64) {
+        // Masked out bytes are zero, so a sequence cut by the text end is an error of the tail block
+        __m512i input = loadBlock512(text + i, size - i);
+        if (getUtf8Errors512(input, previous) != 0) break;
+        previous = input;
+    }
+    // Text that ends with a block can also end with a cut sequence, it's checked from its start
+    size_t start = findSequenceStart(text, i < size ? i : size);
+    return start + findInvalidUtf8Avx2(text + start, size - start);
+}
+
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+// Dispatch
+//----------------------------------------------------------------------------------------------------------------------
+
+/** Kernels of each instruction set, indexed by Isa. Instruction sets that are not built in use the scalar kernels. **/
+static const TextKernels ISA_KERNELS[ISA_NUMBER] = {
+        { Isa::SCALAR, countNewlinesScalar, findNewlineScalar, findLetterScalar, findInvalidUtf8Scalar },
+#ifdef TEXT_KERNELS_X86
+        { Isa::SSE2,   countNewlinesSse2,   findNewlineSse2,   findLetterSse2,   findInvalidUtf8Sse2   },
+        { Isa::AVX2,   countNewlinesAvx2,   findNewlineAvx2,   findLetterAvx2,   findInvalidUtf8Avx2   },
+        { Isa::AVX512, countNewlinesAvx512, findNewlineAvx512, findLetterAvx512, findInvalidUtf8Avx512 },
+#else
+        { Isa::SSE2,   countNewlinesScalar, findNewlineScalar, findLetterScalar, findInvalidUtf8Scalar },
+        { Isa::AVX2,   countNewlinesScalar, findNewlineScalar, findLetterScalar, findInvalidUtf8Scalar },
+        { Isa::AVX512, countNewlinesScalar, findNewlineScalar, findLetterScalar, findInvalidUtf8Scalar },
+#endif
+};
+
+/** Names of the instruction sets, indexed by Isa. **/
+static const char* const ISA_NAMES[ISA_NUMBER] = { "scalar", "sse2", "avx2", "avx512" };
+
+/** Kernels that are bound for the process, nullptr until they are used or forced. **/
+static std::atomic<const TextKernels*> boundKernels = nullptr;
+
+/**
+ * Name of the instruction set, as accepted by parseIsa.
+ * @param[in] isa instruction set
+ * @return name of the instruction set ("scalar", "sse2", "avx2" or "avx512").
+ */
+const char* getIsaName(Isa isa) {
+    return ISA_NAMES[static_cast<size_t>(isa)];
+}
+
+/**
+ * Parses the name of the instruction set ("scalar", "sse2", "avx2" or "avx512").
+ * @param[in]  name name to parse
+ * @param[out] isa  parsed instruction set
+ * @return true, if the name is valid, false otherwise.
+ */
+bool parseIsa(const char* name, Isa& isa) {
+    assert(name != nullptr);
+
+    for (size_t i = 0; i < ISA_NUMBER; ++i) {
+        if (strcmp(name, ISA_NAMES[i]) == 0) {
+            isa = static_cast<Isa>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Detects the best instruction set that the CPU supports.
+ * @return detected instruction set.
+ */
+static Isa detectIsa() {
+#ifdef TEXT_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) return Isa::AVX512;
+    if (__builtin_cpu_supports("avx2")) return Isa::AVX2;
+    if (__builtin_cpu_supports("sse2")) return Isa::SSE2;
+#endif
+    return Isa::SCALAR;
+}
+
+/**
+ * Best instruction set that the CPU supports. CPU features are detected only once.
+ * @return detected instruction set.
+ */
+Isa getDetectedIsa() {
+    static const Isa detectedIsa = detectIsa();
+    return detectedIsa;
+}
+
+/**
+ * Checks if kernels of the instruction set are built in and the CPU supports it.
+ * @param[in] isa instruction set to check
+ * @return true, if kernels of the instruction set can be used, false otherwise.
+ */
+bool isIsaSupported(Isa isa) {
+    // Every newer instruction set in Isa implies the older ones
+    return isa <= getDetectedIsa();
+}
+
+/**
+ * Kernels of the given instruction set (e.g. to check them against the scalar ones).
+ * @param[in] isa instruction set, it must be supported (see isIsaSupported)
+ * @return kernels of the instruction set.
+ */
+const TextKernels& getIsaKernels(Isa isa) {
+    assert(isIsaSupported(isa));
+
+    return ISA_KERNELS[static_cast<size_t>(isa)];
+}
+
+/**
+ * Kernels that are bound for the process: the ones of the detected instruction set or of the forced one.
+ * @return bound kernels.
+ */
+const TextKernels& getTextKernels() {
+    const TextKernels* kernels = boundKernels.load(std::memory_order_acquire);
+    if (kernels == nullptr) {
+        // Concurrent first calls bind the same kernels
+        kernels = &getIsaKernels(getDetectedIsa());
+        boundKernels.store(kernels, std::memory_order_release);
+    }
+    return *kernels;
+}
+
+/**
+ * Binds kernels of the given instruction set instead of the detected one.
+ * Should be called at startup, before the kernels are used by other threads.
+ * @param[in] isa instruction set to use
+ * @return true, if the kernels were bound, false if the instruction set is not supported.
+ */
+bool forceIsa(Isa isa) {
+    if (!isIsaSupported(isa)) return false;
+
+    boundKernels.store(&getIsaKernels(isa), std::memory_order_release);
+    return true;
+}
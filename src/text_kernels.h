@@ -0,0 +1,120 @@
+/**
+ * @file
+ * @brief Header file with vectorized text kernels and their runtime dispatch by CPU features
+ *
+ * Each kernel has a variant for every supported instruction set, and all variants give the same results.
+ * The best variant that the CPU supports is detected once (on the first use) and bound for the whole process,
+ * so the same binary runs on CPUs without AVX2 and uses AVX-512 where it's available.
+ * The choice can be overridden with forceIsa (e.g. to compare performance or to work around a faulty variant).
+ */
+#ifndef POEM_SORTER_TEXT_KERNELS_H
+#define POEM_SORTER_TEXT_KERNELS_H
+
+#include <cstddef>
+#include "collation.h"
+
+/**
+ * Instruction set of the kernel variants. Instruction sets are ordered from the oldest to the newest.
+ */
+enum class Isa {
+    SCALAR, /**< plain C++, runs everywhere */
+    SSE2,   /**< 16 bytes at a time, any x86-64 CPU */
+    AVX2,   /**< 32 bytes at a time */
+    AVX512, /**< 64 bytes at a time (AVX-512F and AVX-512BW) */
+};
+
+/** Number of instruction sets in Isa. **/
+#define ISA_NUMBER 4
+
+/**
+ * Text kernels of one instruction set. Kernels never read outside of the given range.
+ */
+struct TextKernels {
+    Isa isa; /**< instruction set of the kernels */
+
+    /**
+     * Counts '\\n' symbols of the text.
+     * @param[in] text pointer to a first character of the text
+     * @param[in] size size of the text in bytes
+     * @return number of '\\n' symbols.
+     */
+    size_t (*countNewlines)(const char* text, size_t size);
+
+    /**
+     * Finds the first '\\n' symbol of the text.
+     * @param[in] text pointer to a first character of the text
+     * @param[in] size size of the text in bytes
+     * @return offset of the first '\\n' symbol or size, if there is no one.
+     */
+    size_t (*findNewline)(const char* text, size_t size);
+
+    /**
+     * Finds the first letter of the text (see getAlphaSizeDirect). Only letters that lie entirely inside the text
+     * are found.
+     * @param[in] text  pointer to a first character of the text
+     * @param[in] size  size of the text in bytes
+     * @param[in] table collation table that defines letters
+     * @return offset of the first byte of the first letter or size, if there is no one.
+     */
+    size_t (*findLetter)(const char* text, size_t size, const CollationTable& table);
+
+    /**
+     * Finds the first invalid UTF-8 sequence of the text (RFC 3629): stray continuation bytes, overlong forms,
+     * surrogates, code points above U+10FFFF and sequences cut by a non-continuation byte or by the text end.
+     * @param[in] text pointer to a first character of the text
+     * @param[in] size size of the text in bytes
+     * @return offset of the first byte of the invalid sequence or size, if the text is valid UTF-8.
+     */
+    size_t (*findInvalidUtf8)(const char* text, size_t size);
+};
+
+/**
+ * Name of the instruction set, as accepted by parseIsa.
+ * @param[in] isa instruction set
+ * @return name of the instruction set ("scalar", "sse2", "avx2" or "avx512").
+ */
+const char* getIsaName(Isa isa);
+
+/**
+ * Parses the name of the instruction set ("scalar", "sse2", "avx2" or "avx512").
+ * @param[in]  name name to parse
+ * @param[out] isa  parsed instruction set
+ * @return true, if the name is valid, false otherwise.
+ */
+bool parseIsa(const char* name, Isa& isa);
+
+/**
+ * Checks if kernels of the instruction set are built in and the CPU supports it.
+ * @param[in] isa instruction set to check
+ * @return true, if kernels of the instruction set can be used, false otherwise.
+ */
+bool isIsaSupported(Isa isa);
+
+/**
+ * Best instruction set that the CPU supports. CPU features are detected only once.
+ * @return detected instruction set.
+ */
+Isa getDetectedIsa();
+
+/**
+ * Kernels of the given instruction set (e.g. to check them against the scalar ones).
+ * @param[in] isa instruction set, it must be supported (see isIsaSupported)
+ * @return kernels of the instruction set.
+ */
+const TextKernels& getIsaKernels(Isa isa);
+
+/**
+ * Kernels that are bound for the process: the ones of the detected instruction set or of the forced one.
+ * @return bound kernels.
+ */
+const TextKernels& getTextKernels();
+
+/**
+ * Binds kernels of the given instruction set instead of the detected one.
+ * Should be called at startup, before the kernels are used by other threads.
+ * @param[in] isa instruction set to use
+ * @return true, if the kernels were bound, false if the instruction set is not supported.
+ */
+bool forceIsa(Isa isa);
+
+#endif //POEM_SORTER_TEXT_KERNELS_H
@@ -0,0 +1,62 @@
+/**
+ * @file
+ * @brief Source file with the normalization pass that cleans the text before it's split
+ */
+#include <cassert>
+#include <cstring>
+#include "text_kernels.h"
+#include "text_normalization.h"
+
+/**
+ * Finds the next '\\r' symbol of the text.
+ * @param[in] text pointer to a first character of the text
+ * @param[in] from offset to start search from
+ * @param[in] size size of the text in bytes
+ * @return offset of the '\\r' symbol or size, if there is no one.
+ */
+static size_t findCarriageReturn(const char* text, size_t from, size_t size) {
+    const void* carriageReturn = memchr(text + from, '\r', size - from);
+    return carriageReturn != nullptr ? static_cast<const char*>(carriageReturn) - text : size;
+}
+
+/**
+ * Normalizes the text in place: each byte of invalid UTF-8 sequences (see TextKernels::findInvalidUtf8) is replaced
+ * with INVALID_UTF8_REPLACEMENT, '\\r' symbols before '\\n' are dropped, and the rest of the text is moved back.
+ * Valid runs are found with the bound vectorized kernel (see getTextKernels), so clean text is only read once.
+ * @param[in, out] text  pointer to a first character of the text
+ * @param[in]      size  size of the text in bytes
+ * @param[out]     stats statistics of the normalization
+ * @return size of the normalized text in bytes.
+ */
+size_t normalizeText(char* text, size_t size, NormalizationStats& stats) {
+    assert(text != nullptr || size == 0);
+
+    const TextKernels& kernels = getTextKernels();
+    stats = {};
+    // Bytes before the kept offset are already in place, bytes of the text before the moved offset are moved to it
+    size_t kept = 0;
+    size_t moved = 0;
+    size_t invalid = kernels.findInvalidUtf8(text, size);
+    size_t carriageReturn = findCarriageReturn(text, 0, size);
+    while (invalid < size || carriageReturn < size) {
+        if (invalid < carriageReturn) {
+            if (stats.invalidBytes == 0) stats.firstInvalidOffset = invalid;
+            ++stats.invalidBytes;
+            // Rest of the invalid sequence is checked again, so each of its bytes is replaced
+            text[invalid] = INVALID_UTF8_REPLACEMENT;
+            ++invalid;
+            invalid += kernels.findInvalidUtf8(text + invalid, size - invalid);
+            continue;
+        }
+
+        if (carriageReturn + 1 < size && text[carriageReturn + 1] == '\n') {
+            if (kept != moved) memmove(text + kept, text + moved, carriageReturn - moved);
+            kept += carriageReturn - moved;
+            moved = carriageReturn + 1;
+            ++stats.crlfLineEndings;
+        }
+        carriageReturn = findCarriageReturn(text, carriageReturn + 1, size);
+    }
+    if (kept != moved) memmove(text + kept, text + moved, size - moved);
+    return kept + size - moved;
+}
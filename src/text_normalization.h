@@ -0,0 +1,36 @@
+/**
+ * @file
+ * @brief Header file with the normalization pass that cleans the text before it's split
+ *
+ * Scraped texts can contain malformed UTF-8 and CRLF line endings. Normalization replaces invalid UTF-8 bytes
+ * and drops '\\r' before '\\n' in place, so lines contain only valid UTF-8 and don't end with '\\r'.
+ */
+#ifndef POEM_SORTER_TEXT_NORMALIZATION_H
+#define POEM_SORTER_TEXT_NORMALIZATION_H
+
+#include <cstddef>
+
+/** Byte that replaces each byte of invalid UTF-8 sequences (U+FFFD doesn't fit in place of a single byte). **/
+#define INVALID_UTF8_REPLACEMENT '?'
+
+/**
+ * Statistics of the text normalization.
+ */
+struct NormalizationStats {
+    size_t invalidBytes = 0;       /**< number of replaced bytes of invalid UTF-8 sequences */
+    size_t firstInvalidOffset = 0; /**< offset of the first replaced byte in the original text, if there are any */
+    size_t crlfLineEndings = 0;    /**< number of '\\r' symbols dropped before '\\n' */
+};
+
+/**
+ * Normalizes the text in place: each byte of invalid UTF-8 sequences (see TextKernels::findInvalidUtf8) is replaced
+ * with INVALID_UTF8_REPLACEMENT, '\\r' symbols before '\\n' are dropped, and the rest of the text is moved back.
+ * Valid runs are found with the bound vectorized kernel (see getTextKernels), so clean text is only read once.
+ * @param[in, out] text  pointer to a first character of the text
+ * @param[in]      size  size of the text in bytes
+ * @param[out]     stats statistics of the normalization
+ * @return size of the normalized text in bytes.
+ */
+size_t normalizeText(char* text, size_t size, NormalizationStats& stats);
+
+#endif //POEM_SORTER_TEXT_NORMALIZATION_H
@@ -0,0 +1,53 @@
+/**
+ * @file
+ */
+#include <cstdint>
+#include "testlib.h"
+#include "../src/Arena.h"
+
+TEST(Arena, allocate_alignedAndDisjointArrays) {
+    Arena arena;
+
+    char* bytes = arena.allocate<char>(3);
+    uint64_t* numbers = arena.allocate<uint64_t>(10);
+    char* moreBytes = arena.allocate<char>(1);
+
+    ASSERT_EQUALS(reinterpret_cast<uintptr_t>(numbers) % alignof(uint64_t), 0);
+    ASSERT_TRUE(reinterpret_cast<char*>(numbers) >= bytes + 3);
+    ASSERT_TRUE(moreBytes >= reinterpret_cast<char*>(numbers + 10));
+    ASSERT_EQUALS(arena.getBlocksAllocated(), 1);
+}
+
+TEST(Arena, reset_blocksMergedAndReused) {
+    Arena arena(1024);
+    for (size_t i = 0; i < 4; ++i) {
+        arena.allocate<uint64_t>(100 * 1024);
+    }
+    size_t capacity = arena.getCapacity();
+    size_t blocksAllocated = arena.getBlocksAllocated();
+    ASSERT_TRUE(blocksAllocated > 2);
+
+    // Blocks are merged into one on the first reset, so the same run doesn't allocate anymore
+    arena.reset();
+    ASSERT_EQUALS(arena.getUsedSize(), 0);
+    ASSERT_EQUALS(arena.getCapacity(), capacity);
+    ASSERT_EQUALS(arena.getBlocksAllocated(), blocksAllocated + 1);
+    for (size_t run = 0; run < 3; ++run) {
+        for (size_t i = 0; i < 4; ++i) {
+            arena.allocate<uint64_t>(100 * 1024);
+        }
+        arena.reset();
+    }
+    ASSERT_EQUALS(arena.getBlocksAllocated(), blocksAllocated + 1);
+}
+
+TEST(Arena, reserve_allocationsFitInOneBlock) {
+    Arena arena(16);
+    arena.reserve(1000 * sizeof(uint64_t));
+    arena.allocate<uint64_t>(600);
+    arena.allocate<uint64_t>(400);
+
+    ASSERT_EQUALS(arena.getBlocksAllocated(), 2);
+    ASSERT_EQUALS(arena.getCapacity(), 1000 * sizeof(uint64_t));
+    ASSERT_EQUALS(arena.getUsedSize(), 1000 * sizeof(uint64_t));
+}
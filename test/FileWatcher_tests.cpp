@@ -0,0 +1,118 @@
+/**
+ * @file
+ */
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include "testlib.h"
+#include "../src/FileWatcher.h"
+
+namespace fs = std::filesystem;
+
+/** Timeout of waiting for changes in tests, so broken watcher doesn't hang the tests. **/
+static constexpr int TEST_WATCH_TIMEOUT_MS = 1000;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(FileWatcher, watchedFileChanged_reportedOnce) {
+    fs::path root = fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_watchFile");
+    fs::create_directories(root);
+    fs::path filePath = root / "poem.txt";
+    std::ofstream(filePath) << "aaa\n";
+
+    FileWatcher watcher;
+    bool watched = watcher.watchFile(filePath.c_str());
+
+    std::ofstream(filePath) << "bbb\n";
+    std::ofstream(filePath, std::ios::app) << "ccc\n";
+    std::ofstream(root / "other.txt") << "ddd\n";
+
+    std::vector<std::string> changedPaths;
+    bool waited = watcher.waitForChanges(changedPaths, 10, TEST_WATCH_TIMEOUT_MS);
+    fs::remove_all(root);
+
+    ASSERT_TRUE(watched && waited);
+    ASSERT_EQUALS(changedPaths.size(), 1);
+    ASSERT_TRUE(changedPaths[0] == filePath.string());
+}
+
+TEST(FileWatcher, fileRenamedOverWatchedFile_reported) {
+    fs::path root = fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_watchRename");
+    fs::create_directories(root);
+    fs::path filePath = root / "poem.txt";
+    std::ofstream(filePath) << "aaa\n";
+
+    FileWatcher watcher;
+    watcher.watchFile(filePath.c_str());
+
+    std::ofstream(root / "poem.txt.tmp") << "bbb\n";
+    fs::rename(root / "poem.txt.tmp", filePath);
+
+    std::vector<std::string> changedPaths;
+    watcher.waitForChanges(changedPaths, 10, TEST_WATCH_TIMEOUT_MS);
+    fs::remove_all(root);
+
+    ASSERT_EQUALS(changedPaths.size(), 1);
+    ASSERT_TRUE(changedPaths[0] == filePath.string());
+}
+
+TEST(FileWatcher, fileInNewSubdirectory_reported) {
+    fs::path root = fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_watchDirectory");
+    fs::create_directories(root);
+
+    FileWatcher watcher;
+    bool watched = watcher.watchDirectory(root.c_str());
+
+    fs::create_directories(root / "new");
+    std::ofstream(root / "new" / "poem.txt") << "aaa\n";
+
+    std::vector<std::string> changedPaths;
+    watcher.waitForChanges(changedPaths, 10, TEST_WATCH_TIMEOUT_MS);
+    fs::remove_all(root);
+
+    ASSERT_TRUE(watched);
+    ASSERT_EQUALS(changedPaths.size(), 1);
+    ASSERT_TRUE(changedPaths[0] == (root / "new" / "poem.txt").string());
+}
+
+TEST(FileWatcher, noChanges_emptyResultOnTimeout) {
+    fs::path root = fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_watchTimeout");
+    fs::create_directories(root);
+
+    FileWatcher watcher;
+    watcher.watchDirectory(root.c_str());
+
+    std::vector<std::string> changedPaths;
+    bool waited = watcher.waitForChanges(changedPaths, 10, 10);
+    fs::remove_all(root);
+
+    ASSERT_TRUE(waited);
+    ASSERT_EQUALS(changedPaths.size(), 0);
+}
+
+TEST(isWatchInput, defaultOutputDirectory_onlyResultsExcluded) {
+    // Output directory "." contains the watched one, so inputs are in the output directory too
+    ASSERT_TRUE(isWatchInput("poems/first.txt", "poems", ".", nullptr));
+    ASSERT_TRUE(isWatchInput("poems/nested/second.txt", "poems", ".", nullptr));
+    ASSERT_TRUE(isWatchInput("poem.txt", "poem.txt", ".", nullptr));
+    ASSERT_TRUE(!isWatchInput("poems/first.txt/direct_sorted.txt", "poems", ".", nullptr));
+    ASSERT_TRUE(!isWatchInput("original.txt", "poem.txt", ".", nullptr));
+    ASSERT_TRUE(!isWatchInput("poems/first.txt.sortstate", "poems", ".", nullptr));
+    ASSERT_TRUE(!isWatchInput("poems/first.txt.rhymeidx.tmp", "poems", ".", nullptr));
+}
+
+TEST(isWatchInput, separateOutputDirectory_allOutputExcluded) {
+    ASSERT_TRUE(isWatchInput("poems/original.txt", "poems", "results", nullptr));
+    ASSERT_TRUE(!isWatchInput("results/first.txt/direct_sorted.txt", "poems", "results", nullptr));
+    ASSERT_TRUE(!isWatchInput("results/notes.txt", ".", "results", nullptr));
+    ASSERT_TRUE(isWatchInput("notes.txt", ".", "results", nullptr));
+}
+
+TEST(isWatchInput, cacheDirectoryInWatchedOne_cacheExcluded) {
+    ASSERT_TRUE(isWatchInput("w/p.txt", "w", "out", "w/cache"));
+    ASSERT_TRUE(isWatchInput("w/cache.txt", "w", "out", "w/cache"));
+    ASSERT_TRUE(!isWatchInput("w/cache/0123456789abcdef.idx", "w", "out", "w/cache"));
+    ASSERT_TRUE(!isWatchInput("w/cache/0123456789abcdef.idx.Xa1b2C", "w", "out", "w/cache"));
+    ASSERT_TRUE(!isWatchInput("./w/cache/nested/file", "w", ".", "w/cache/"));
+}
@@ -2,8 +2,13 @@
  * @file
  */
 #include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <unistd.h>
 #include "testlib.h"
 #include "../src/MappedFile.h"
+#include "../src/text_helpers.h"
 
 void compareText(char* actual, char* expected) {
     ASSERT_EQUALS(strlen(actual), strlen(expected));
@@ -36,3 +41,169 @@ TEST(MappedFileConstructor, mappingForNonExistingFile) {
     ASSERT_EQUALS(mappedFile.getTextSize(), 0);
     ASSERT_TRUE(mappedFile.getTextPtr() == nullptr);
 }
+
+TEST(MappedFileConstructor, readingFromPipe) {
+    int pipeFds[2];
+    ASSERT_EQUALS(pipe(pipeFds), 0);
+
+    // Text is larger than the initial mapping, so the mapping is grown while it's read
+    std::string text;
+    while (text.size() < 3 * 1024 * 1024) text += "Ночь, улица, фонарь, аптека\n";
+    std::thread writer([&text, &pipeFds]() {
+        size_t written = 0;
+        while (written < text.size()) {
+            ssize_t writeSize = write(pipeFds[1], text.data() + written, text.size() - written);
+            if (writeSize <= 0) break;
+            written += writeSize;
+        }
+        close(pipeFds[1]);
+    });
+
+    std::string pipePath = "/dev/fd/" + std::to_string(pipeFds[0]);
+    MappedFile mappedFile(pipePath.c_str());
+    writer.join();
+    close(pipeFds[0]);
+
+    ASSERT_EQUALS(mappedFile.getTextSize(), text.size() + 1);
+    ASSERT_EQUALS(memcmp(mappedFile.getTextPtr(), text.data(), text.size()), 0);
+    ASSERT_EQUALS(mappedFile.getTextPtr()[text.size()], '\n');
+}
+
+/**
+ * Maps the file of the given size filled with 'a' and checks that '\\n' is added after its content.
+ * @param[in] size     size of the file
+ * @param[in] readOnly whether the file is mapped read-only
+ */
+static void checkMappingOfSize(size_t size, bool readOnly) {
+    // Name is unique per call, so tests that run in parallel don't overwrite each other's file
+    std::string fileName = "TESTFILE_SIZE_" + std::to_string(size) + (readOnly ? "_RO" : "") + ".txt";
+    std::string text(size, 'a');
+    FILE* file = fopen(fileName.c_str(), "w");
+    fwrite(text.data(), 1, text.size(), file);
+    fclose(file);
+
+    MappingHints hints;
+    hints.readOnly = readOnly;
+    MappedFile mappedFile(fileName.c_str(), hints);
+    remove(fileName.c_str());
+
+    ASSERT_EQUALS(mappedFile.getTextSize(), size + 1);
+    ASSERT_EQUALS(memcmp(mappedFile.getTextPtr(), text.data(), size), 0);
+    ASSERT_EQUALS(mappedFile.getTextPtr()[size], '\n');
+}
+
+TEST(MappedFileConstructor, fileSizeIsPageSize_newlineAddedWithoutSigbus) {
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    checkMappingOfSize(pageSize, false);
+    checkMappingOfSize(2 * pageSize, true);
+}
+
+TEST(MappedFileConstructor, readOnlyMapping_newlineAddedToLastPage) {
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    checkMappingOfSize(pageSize + 10, true);
+    checkMappingOfSize(7, true);
+}
+
+TEST(parseMappingHints, validAndInvalidLists) {
+    MappingHints hints;
+
+    ASSERT_TRUE(parseMappingHints("populate,huge", hints) && hints.populate && !hints.adviseAccess && hints.hugePages);
+    ASSERT_TRUE(parseMappingHints("advise", hints) && !hints.populate && hints.adviseAccess && !hints.hugePages);
+    ASSERT_TRUE(parseMappingHints("readonly", hints) && hints.readOnly && !hints.populate);
+    ASSERT_TRUE(!parseMappingHints("populate,", hints));
+    ASSERT_TRUE(!parseMappingHints("random", hints));
+}
+
+TEST(MappedFileConstructor, mappingWithHints) {
+    char text[] = "asdada\nasdasd   !!dasd\n";
+    const char* fileName = "TESTFILE_HINTS.txt";
+    FILE* file = fopen(fileName, "w");
+    fprintf(file, "%s", text);
+    fclose(file);
+
+    MappingHints hints;
+    hints.populate = true;
+    hints.adviseAccess = true;
+    hints.hugePages = true;
+    MappedFile mappedFile(fileName, hints);
+    mappedFile.adviseSequentialAccess();
+    mappedFile.adviseRandomAccess();
+    remove(fileName);
+
+    strcat(text, "\n");
+    ASSERT_EQUALS(mappedFile.getTextSize(), strlen(text));
+    ASSERT_EQUALS(memcmp(mappedFile.getTextPtr(), text, strlen(text)), 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Text file that is generated once for the mapping benchmarks and removed at exit.
+ */
+struct BenchmarkFile {
+    std::string path;
+
+    /**
+     * Generates the file of the given size with random english lines.
+     * @param[in] size size of the file in bytes
+     */
+    explicit BenchmarkFile(size_t size) {
+        path = (std::filesystem::temp_directory_path() / ("mapped_file_bench_" + std::to_string(getpid()))).string();
+        std::string text;
+        unsigned int seed = 42;
+        while (text.size() < size) {
+            size_t lineLength = 10 + rand_r(&seed) % 40;
+            for (size_t j = 0; j < lineLength; ++j) {
+                text.push_back(j % 6 == 5 ? ' ' : static_cast<char>('a' + rand_r(&seed) % 26));
+            }
+            text.push_back('\n');
+        }
+        FILE* file = fopen(path.c_str(), "w");
+        fwrite(text.data(), 1, text.size(), file);
+        fclose(file);
+    }
+
+    ~BenchmarkFile() {
+        remove(path.c_str());
+    }
+};
+
+/**
+ * Maps the benchmark file with the given hints and splits it by lines, as SortSession does.
+ * Read-only mappings are split without modification, so no page of the file gets copied.
+ * @param[in] hints mapping hints
+ */
+static void mapAndSplitBenchmarkFile(const MappingHints& hints) {
+    static const BenchmarkFile benchmarkFile(4 * 1024 * 1024);
+
+    MappedFile mappedFile(benchmarkFile.path.c_str(), hints);
+    std::vector<Line> lines;
+    mappedFile.adviseSequentialAccess();
+    if (hints.readOnly) {
+        splitLinesReadOnly(mappedFile.getTextPtr(), mappedFile.getTextSize(), lines);
+    } else {
+        splitLines(mappedFile.getTextPtr(), mappedFile.getTextSize(), lines);
+    }
+    mappedFile.adviseRandomAccess();
+    benchDoNotOptimize(lines.data());
+}
+
+BENCH(MappedFile, split_4MB_noHints) {
+    mapAndSplitBenchmarkFile({});
+}
+
+BENCH(MappedFile, split_4MB_populate) {
+    mapAndSplitBenchmarkFile({ .populate = true });
+}
+
+BENCH(MappedFile, split_4MB_advise) {
+    mapAndSplitBenchmarkFile({ .adviseAccess = true });
+}
+
+BENCH(MappedFile, split_4MB_hugePages) {
+    mapAndSplitBenchmarkFile({ .hugePages = true });
+}
+
+BENCH(MappedFile, split_4MB_readOnly) {
+    mapAndSplitBenchmarkFile({ .readOnly = true });
+}
@@ -0,0 +1,77 @@
+/**
+ * @file
+ */
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+#include "testlib.h"
+#include "../src/SortSession.h"
+
+namespace fs = std::filesystem;
+
+/**
+ * Copies sorted lines of the session to strings.
+ * @param[in, out] session session with loaded text
+ * @param[in]      order   sort order
+ * @return sorted lines.
+ */
+std::vector<std::string> sortedLinesToStrings(SortSession& session, SortOrder order) {
+    std::vector<std::string> result;
+    for (auto [start, end] : session.getSortedLines(order)) {
+        result.emplace_back(start, end + 1);
+    }
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(ResultCache, secondLoad_cacheHitWithSameResults) {
+    fs::path root = fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_cacheHit");
+    fs::create_directories(root);
+    fs::path filePath = root / "poem.txt";
+    std::ofstream(filePath) << "bca\nabc\n,,\ncab\n";
+
+    ResultCache cache((root / "cache").c_str());
+    SortSession session;
+
+    bool firstLoaded = session.loadFile(filePath.c_str(), &cache);
+    bool firstFromCache = session.isLoadedFromCache();
+    std::vector<std::string> firstDirect = sortedLinesToStrings(session, SortOrder::DIRECT);
+    std::vector<std::string> firstReverse = sortedLinesToStrings(session, SortOrder::REVERSE);
+
+    bool secondLoaded = session.loadFile(filePath.c_str(), &cache);
+    bool secondFromCache = session.isLoadedFromCache();
+    std::vector<std::string> secondDirect = sortedLinesToStrings(session, SortOrder::DIRECT);
+    std::vector<std::string> secondReverse = sortedLinesToStrings(session, SortOrder::REVERSE);
+    session.clear();
+    fs::remove_all(root);
+
+    ASSERT_TRUE(firstLoaded && secondLoaded);
+    ASSERT_TRUE(!firstFromCache);
+    ASSERT_TRUE(secondFromCache);
+    ASSERT_TRUE(firstDirect == std::vector<std::string>({ "abc", "bca", "cab" }));
+    ASSERT_TRUE(firstReverse == std::vector<std::string>({ "bca", "cab", "abc" }));
+    ASSERT_TRUE(secondDirect == firstDirect);
+    ASSERT_TRUE(secondReverse == firstReverse);
+}
+
+TEST(ResultCache, changedFile_cacheMiss) {
+    fs::path root = fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_cacheMiss");
+    fs::create_directories(root);
+    fs::path filePath = root / "poem.txt";
+    std::ofstream(filePath) << "bbb\naaa\n";
+
+    ResultCache cache((root / "cache").c_str());
+    SortSession session;
+    session.loadFile(filePath.c_str(), &cache);
+
+    std::ofstream(filePath) << "bbb\naab\n";
+    session.loadFile(filePath.c_str(), &cache);
+    bool fromCache = session.isLoadedFromCache();
+    std::vector<std::string> direct = sortedLinesToStrings(session, SortOrder::DIRECT);
+    session.clear();
+    fs::remove_all(root);
+
+    ASSERT_TRUE(!fromCache);
+    ASSERT_TRUE(direct == std::vector<std::string>({ "aab", "bbb" }));
+}
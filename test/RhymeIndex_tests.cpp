@@ -0,0 +1,102 @@
+/**
+ * @file
+ */
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include "testlib.h"
+#include "../src/RhymeIndex.h"
+
+namespace fs = std::filesystem;
+
+/**
+ * Finds lines by ending and copies them to strings.
+ * @param[in] index  opened rhyme index
+ * @param[in] ending ending of the lines
+ * @return found lines.
+ */
+std::vector<std::string> queryToStrings(const RhymeIndex& index, const char* ending) {
+    std::vector<Line> lines;
+    index.query(ending, lines);
+
+    std::vector<std::string> result;
+    for (auto [start, end] : lines) {
+        result.emplace_back(start, end + 1);
+    }
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(RhymeIndex, query_linesWithEndingExpected) {
+    fs::path filePath = fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_rhymeIndex.txt");
+    std::ofstream(filePath) << "Образование,\nмолчание\nрисование!\nкак\nЗимой? Зимование\n";
+
+    RhymeIndex index;
+    bool opened = index.open(filePath.c_str());
+    bool indexCreated = fs::exists(RhymeIndex::getIndexPath(filePath.c_str()));
+
+    std::vector<std::string> ovanie = queryToStrings(index, "ование");
+    std::vector<std::string> anie = queryToStrings(index, "-ание");
+    std::vector<std::string> missing = queryToStrings(index, "xyz");
+    std::vector<std::string> all = queryToStrings(index, "");
+    size_t linesNumber = index.size();
+
+    fs::remove(RhymeIndex::getIndexPath(filePath.c_str()));
+    fs::remove(filePath);
+
+    ASSERT_TRUE(opened);
+    ASSERT_TRUE(indexCreated);
+    ASSERT_EQUALS(linesNumber, 5);
+    ASSERT_EQUALS(ovanie.size(), 3);
+    ASSERT_TRUE(ovanie == std::vector<std::string>({ "Образование,", "Зимой? Зимование", "рисование!" }));
+    ASSERT_EQUALS(anie.size(), 4);
+    ASSERT_EQUALS(missing.size(), 0);
+    ASSERT_EQUALS(all.size(), 5);
+}
+
+TEST(RhymeIndex, changedText_indexIsRebuilt) {
+    fs::path filePath = fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_rhymeRebuild.txt");
+    std::ofstream(filePath) << "night\n";
+
+    RhymeIndex index;
+    bool firstOpened = index.open(filePath.c_str());
+    std::vector<std::string> firstResult = queryToStrings(index, "ight");
+
+    std::ofstream(filePath) << "night\nlight\nday\n";
+    bool secondOpened = index.open(filePath.c_str());
+    std::vector<std::string> secondResult = queryToStrings(index, "ight");
+
+    fs::remove(RhymeIndex::getIndexPath(filePath.c_str()));
+    fs::remove(filePath);
+
+    ASSERT_TRUE(firstOpened && secondOpened);
+    ASSERT_EQUALS(firstResult.size(), 1);
+    ASSERT_TRUE(secondResult == std::vector<std::string>({ "light", "night" }));
+}
+
+TEST(RhymeIndex, lineOutsideOfText_indexIsRebuilt) {
+    fs::path filePath = fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_rhymeCorrupt.txt");
+    std::ofstream(filePath) << "night\nlight\n";
+    std::string indexPath = RhymeIndex::getIndexPath(filePath.c_str());
+
+    RhymeIndex index;
+    bool firstOpened = index.open(filePath.c_str());
+
+    // Offset of the first line points far after the text end
+    uint64_t badOffset = 1ull << 40;
+    std::fstream indexFile(indexPath, std::ios::in | std::ios::out | std::ios::binary);
+    indexFile.seekp(sizeof(RhymeIndexHeader));
+    indexFile.write(reinterpret_cast<const char*>(&badOffset), sizeof(badOffset));
+    indexFile.close();
+
+    bool secondOpened = index.open(filePath.c_str());
+    std::vector<std::string> result = queryToStrings(index, "ight");
+
+    fs::remove(indexPath);
+    fs::remove(filePath);
+
+    ASSERT_TRUE(firstOpened && secondOpened);
+    ASSERT_TRUE(result == std::vector<std::string>({ "light", "night" }));
+}
@@ -0,0 +1,139 @@
+/**
+ * @file
+ */
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "testlib.h"
+#include "../src/SortServer.h"
+
+/**
+ * Unique socket path for the test, so tests can be run in parallel.
+ * @param[in] name name of the test
+ * @return path of the socket in /tmp.
+ */
+std::string testSocketPath(const char* name) {
+    return "/tmp/poem_sorter_" + std::to_string(getpid()) + "_" + name + ".sock";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(SortServer, sortBuffer_sortedLinesExpected) {
+    std::string socketPath = testSocketPath("sortBuffer");
+    SortServer server;
+    ASSERT_TRUE(server.start(socketPath.c_str(), 2));
+
+    SortClient client;
+    ASSERT_TRUE(client.connect(socketPath.c_str()));
+
+    const char* text = "bca\nabc\n,,\ncab";
+    std::vector<char> result;
+
+    ASSERT_TRUE(client.sortBuffer(text, strlen(text), SortOrder::DIRECT, result));
+    ASSERT_EQUALS(std::string(result.begin(), result.end()), "abc\nbca\ncab\n");
+
+    ASSERT_TRUE(client.sortBuffer(text, strlen(text), SortOrder::REVERSE, result));
+    ASSERT_EQUALS(std::string(result.begin(), result.end()), "bca\ncab\nabc\n");
+}
+
+TEST(SortServer, sortFile_sortedLinesExpected) {
+    std::string socketPath = testSocketPath("sortFile");
+    std::string fileName = "/tmp/poem_sorter_" + std::to_string(getpid()) + "_sortFile.txt";
+    FILE* file = fopen(fileName.c_str(), "w");
+    fprintf(file, "zzz\nyyy\n");
+    fclose(file);
+
+    SortServer server;
+    ASSERT_TRUE(server.start(socketPath.c_str(), 1));
+
+    SortClient client;
+    ASSERT_TRUE(client.connect(socketPath.c_str()));
+
+    std::vector<char> result;
+    bool sorted = client.sortFile(fileName.c_str(), SortOrder::DIRECT, result);
+    remove(fileName.c_str());
+
+    ASSERT_TRUE(sorted);
+    ASSERT_EQUALS(std::string(result.begin(), result.end()), "yyy\nzzz\n");
+}
+
+TEST(SortServer, sortNonExistingFile_errorExpected) {
+    std::string socketPath = testSocketPath("sortNonExistingFile");
+    SortServer server;
+    ASSERT_TRUE(server.start(socketPath.c_str(), 1));
+
+    SortClient client;
+    ASSERT_TRUE(client.connect(socketPath.c_str()));
+
+    std::vector<char> result;
+    ASSERT_TRUE(!client.sortFile("NON_EXISTING_FILE.NON_EXISTING_EXTENSION", SortOrder::DIRECT, result));
+}
+
+TEST(SortServer, stats_requestsAreCounted) {
+    std::string socketPath = testSocketPath("stats");
+    SortServer server;
+    ASSERT_TRUE(server.start(socketPath.c_str(), 1));
+
+    SortClient client;
+    ASSERT_TRUE(client.connect(socketPath.c_str()));
+
+    std::vector<char> result;
+    ASSERT_TRUE(client.sortBuffer("a\n", 2, SortOrder::DIRECT, result));
+    ASSERT_TRUE(client.sortBuffer("b\n", 2, SortOrder::DIRECT, result));
+    ASSERT_TRUE(client.getStats(result));
+
+    std::string stats(result.begin(), result.end());
+    ASSERT_TRUE(stats.find("requests 2\n") != std::string::npos);
+    ASSERT_TRUE(stats.find("p99_us") != std::string::npos);
+}
+
+TEST(SortServer, tooLargePayload_rejectedBeforeReading) {
+    std::string socketPath = testSocketPath("tooLargePayload");
+    SortServer server;
+    ASSERT_TRUE(server.start(socketPath.c_str(), 1, 16));
+
+    SortClient client;
+    ASSERT_TRUE(client.connect(socketPath.c_str()));
+    const char* smallText = "bb\naa\n";
+    std::vector<char> result;
+    ASSERT_TRUE(client.sortBuffer(smallText, strlen(smallText), SortOrder::DIRECT, result));
+    ASSERT_EQUALS(std::string(result.begin(), result.end()), "aa\nbb\n");
+
+    // Server may close the connection before the payload is sent, so only the failure is checked
+    std::string largeText(17, 'a');
+    ASSERT_TRUE(!client.sortBuffer(largeText.data(), largeText.size(), SortOrder::DIRECT, result));
+
+    SortClient nextClient;
+    ASSERT_TRUE(nextClient.connect(socketPath.c_str()));
+    ASSERT_TRUE(nextClient.sortBuffer(smallText, strlen(smallText), SortOrder::REVERSE, result));
+    ASSERT_EQUALS(std::string(result.begin(), result.end()), "aa\nbb\n");
+}
+
+TEST(SortServer, idleClient_disconnectedAfterTimeout) {
+    std::string socketPath = testSocketPath("idleClient");
+    SortServer server;
+    ASSERT_TRUE(server.start(socketPath.c_str(), 1, DEFAULT_MAX_PAYLOAD_SIZE, 100));
+
+    // The only worker is taken by the idle client until the timeout expires
+    SortClient idleClient;
+    ASSERT_TRUE(idleClient.connect(socketPath.c_str()));
+    SortClient client;
+    ASSERT_TRUE(client.connect(socketPath.c_str()));
+
+    const char* text = "bb\naa\n";
+    std::vector<char> result;
+    ASSERT_TRUE(client.sortBuffer(text, strlen(text), SortOrder::DIRECT, result));
+    ASSERT_EQUALS(std::string(result.begin(), result.end()), "aa\nbb\n");
+    ASSERT_TRUE(!idleClient.sortBuffer(text, strlen(text), SortOrder::DIRECT, result));
+}
+
+TEST(SortServer, socket_accessibleOnlyByOwner) {
+    std::string socketPath = testSocketPath("socketMode");
+    SortServer server;
+    ASSERT_TRUE(server.start(socketPath.c_str(), 1));
+
+    struct stat socketStat{};
+    ASSERT_TRUE(stat(socketPath.c_str(), &socketStat) == 0);
+    ASSERT_EQUALS(socketStat.st_mode & 0777, 0600);
+}
@@ -0,0 +1,227 @@
+/**
+ * @file
+ */
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include "testlib.h"
+#include "../src/hash.h"
+#include "../src/MappedFile.h"
+#include "../src/SortSession.h"
+#include "../src/sorted_index.h"
+
+namespace fs = std::filesystem;
+
+void compareSortedLines(const std::vector<Line>& actual, const std::vector<const char*>& expected) {
+    ASSERT_EQUALS(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        ASSERT_EQUALS(strcmp(actual[i].lineStart, expected[i]), 0);
+    }
+}
+
+/**
+ * Compares sorted lines by their spans, so lines don't have to be null-terminated.
+ * @param[in] actual   sorted lines
+ * @param[in] expected expected lines
+ */
+void compareSortedSpans(const std::vector<Line>& actual, const std::vector<std::string>& expected) {
+    ASSERT_EQUALS(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        ASSERT_TRUE(std::string(actual[i].lineStart, actual[i].lineEnd + 1) == expected[i]);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(SortSession, loadBufferWithTrailingNewline_sortedInBothOrders) {
+    char text[] = "bca\nabc\n,,\ncab\n";
+    SortSession session;
+    session.loadBuffer(text, strlen(text));
+
+    compareSortedLines(session.getLines(), { "bca", "abc", "cab" });
+    compareSortedLines(session.getSortedLines(SortOrder::DIRECT), { "abc", "bca", "cab" });
+    compareSortedLines(session.getSortedLines(SortOrder::REVERSE), { "bca", "cab", "abc" });
+}
+
+TEST(SortSession, loadBufferWithoutTrailingNewline_bufferIsNotModified) {
+    const char text[] = "bca\nabc";
+    char buffer[sizeof(text)];
+    memcpy(buffer, text, sizeof(text));
+
+    SortSession session;
+    session.loadBuffer(buffer, strlen(buffer));
+
+    ASSERT_EQUALS(memcmp(buffer, text, sizeof(text)), 0);
+    compareSortedLines(session.getSortedLines(SortOrder::DIRECT), { "abc", "bca" });
+}
+
+TEST(SortSession, sortedPermutation_pointsToOriginalLines) {
+    char text[] = "ccc\naaa\nbbb\n";
+    SortSession session;
+    session.loadBuffer(text, strlen(text));
+
+    const std::vector<size_t>& permutation = session.getSortedPermutation(SortOrder::DIRECT);
+
+    ASSERT_EQUALS(permutation.size(), 3);
+    ASSERT_EQUALS(permutation[0], 1);
+    ASSERT_EQUALS(permutation[1], 2);
+    ASSERT_EQUALS(permutation[2], 0);
+}
+
+TEST(SortSession, reloadBuffer_previousResultsAreReset) {
+    char text1[] = "bbb\naaa\n";
+    char text2[] = "zzz\nyyy\nxxx\n";
+    SortSession session;
+
+    session.loadBuffer(text1, strlen(text1));
+    compareSortedLines(session.getSortedLines(SortOrder::DIRECT), { "aaa", "bbb" });
+
+    session.loadBuffer(text2, strlen(text2));
+    compareSortedLines(session.getSortedLines(SortOrder::DIRECT), { "xxx", "yyy", "zzz" });
+}
+
+TEST(SortSession, headLines_onlyFirstLinesSorted) {
+    char text[] = "ddd\nbbb\neee\naaa\nccc\n";
+    SortSession session;
+    session.setHeadLines(2);
+    session.loadBuffer(text, strlen(text));
+
+    compareSortedLines(session.getSortedLines(SortOrder::DIRECT), { "aaa", "bbb" });
+    compareSortedLines(session.getSortedLines(SortOrder::REVERSE), { "aaa", "bbb" });
+    ASSERT_EQUALS(session.getLines().size(), 5);
+}
+
+TEST(SortSession, savedSortedIndex_mappedInPlace) {
+    const std::string text = "bca\nabc\n,,\nabc\n";
+    std::string buffer = text;
+    SortSession session;
+    session.setContentHashing(true);
+    session.loadBuffer(buffer.data(), buffer.size());
+
+    std::string indexPath = (fs::temp_directory_path() / ("sorted_index_test_" + std::to_string(getpid()))).string();
+    ASSERT_TRUE(session.saveSortedIndex(indexPath.c_str()));
+
+    MappedFile indexFile(indexPath.c_str());
+    SortedIndexView view = {};
+    ASSERT_TRUE(parseSortedIndex(indexFile.getTextPtr(), indexFile.getTextSize() - 1, view));
+    ASSERT_EQUALS(view.header->linesNumber, 3);
+    ASSERT_EQUALS(view.header->textSize, text.size());
+    ASSERT_EQUALS(view.header->contentHash, hashBytes(text.data(), text.size()));
+
+    // Duplicate lines are told apart by their offsets in the original text (order of equal lines is not specified)
+    uint64_t firstOffset = view.offsets[view.direct[0]];
+    uint64_t secondOffset = view.offsets[view.direct[1]];
+    ASSERT_TRUE((firstOffset == 4 && secondOffset == 11) || (firstOffset == 11 && secondOffset == 4));
+    ASSERT_EQUALS(view.offsets[view.direct[2]], 0);
+    ASSERT_EQUALS(view.lengths[view.direct[2]], 3);
+    ASSERT_TRUE(!parseSortedIndex(indexFile.getTextPtr(), sizeof(SortedIndexHeader) + 8, view));
+
+    fs::remove(indexPath);
+}
+
+TEST(SortSession, readOnlyMapping_sortedBySpans) {
+    fs::path filePath = fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_readonly.txt");
+    std::ofstream(filePath) << "bca, x\nabc\n,,\ncab";
+
+    SortSession session;
+    session.setMappingHints({ .readOnly = true });
+    ASSERT_TRUE(session.loadFile(filePath.c_str()));
+
+    // Writing to the read-only mapping would crash, so the lines are kept as spans only
+    compareSortedSpans(session.getSortedLines(SortOrder::DIRECT), { "abc", "bca, x", "cab" });
+    compareSortedSpans(session.getSortedLines(SortOrder::REVERSE), { "cab", "abc", "bca, x" });
+    fs::remove(filePath);
+}
+
+TEST(SortSession, textNormalization_cleanLinesSorted) {
+    char text[] = "bc\xD0\r\nab\r\n,,\r\nca\r\n";
+    SortSession session;
+    session.setTextNormalization(true);
+    session.loadBuffer(text, strlen(text));
+
+    compareSortedLines(session.getSortedLines(SortOrder::DIRECT), { "ab", "bc?", "ca" });
+    compareSortedLines(session.getSortedLines(SortOrder::REVERSE), { "ca", "ab", "bc?" });
+    ASSERT_EQUALS(session.getNormalizationStats().invalidBytes, 1);
+    ASSERT_EQUALS(session.getNormalizationStats().firstInvalidOffset, 2);
+    ASSERT_EQUALS(session.getNormalizationStats().crlfLineEndings, 4);
+
+    fs::path filePath = fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_crlf.txt");
+    std::ofstream(filePath) << "bc\r\nab\r\nca\r";
+    ASSERT_TRUE(session.loadFile(filePath.c_str()));
+    // '\r' at the end of the file is followed by '\n' added by MappedFile
+    compareSortedLines(session.getSortedLines(SortOrder::DIRECT), { "ab", "bc", "ca" });
+    ASSERT_EQUALS(session.getNormalizationStats().invalidBytes, 0);
+    ASSERT_EQUALS(session.getNormalizationStats().crlfLineEndings, 3);
+    fs::remove(filePath);
+}
+
+TEST(SortSession, loadNonExistingFile_failureExpected) {
+    SortSession session;
+
+    ASSERT_TRUE(!session.loadFile("NON_EXISTING_FILE.NON_EXISTING_EXTENSION"));
+    ASSERT_EQUALS(session.getLines().size(), 0);
+}
+
+TEST(SortSession, appendedLines_mergedIntoSavedState) {
+    fs::path filePath = fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_incremental.txt");
+    std::ofstream(filePath) << "bca\nabc\n,,\n";
+
+    SortSession session;
+    bool firstLoaded = session.loadFileIncremental(filePath.c_str());
+    bool firstIncremental = session.isLoadedIncrementally();
+
+    std::ofstream(filePath, std::ios::app) << "cab\naaa\nzzb";
+    bool secondLoaded = session.loadFileIncremental(filePath.c_str());
+    bool secondIncremental = session.isLoadedIncrementally();
+
+    ASSERT_TRUE(firstLoaded && secondLoaded);
+    ASSERT_TRUE(!firstIncremental);
+    ASSERT_TRUE(secondIncremental);
+    ASSERT_EQUALS(session.getLines().size(), 5);
+    compareSortedSpans(session.getSortedLines(SortOrder::DIRECT), { "aaa", "abc", "bca", "cab", "zzb" });
+    compareSortedSpans(session.getSortedLines(SortOrder::REVERSE), { "aaa", "bca", "cab", "zzb", "abc" });
+
+    session.clear();
+    fs::remove(filePath);
+    fs::remove(filePath.string() + SORT_STATE_EXTENSION);
+}
+
+TEST(SortSession, incompleteLastLineAppended_fullSortExpected) {
+    fs::path filePath = fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_incomplete.txt");
+    std::ofstream(filePath) << "bbb\nab";
+
+    SortSession session;
+    session.loadFileIncremental(filePath.c_str());
+
+    std::ofstream(filePath, std::ios::app) << "z\naaa\n";
+    session.loadFileIncremental(filePath.c_str());
+    bool incremental = session.isLoadedIncrementally();
+
+    ASSERT_TRUE(!incremental);
+    compareSortedSpans(session.getSortedLines(SortOrder::DIRECT), { "aaa", "abz", "bbb" });
+
+    session.clear();
+    fs::remove(filePath);
+    fs::remove(filePath.string() + SORT_STATE_EXTENSION);
+}
+
+TEST(SortSession, rewrittenFile_fullSortExpected) {
+    fs::path filePath = fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_rewritten.txt");
+    std::ofstream(filePath) << "bbb\naaa\n";
+
+    SortSession session;
+    session.loadFileIncremental(filePath.c_str());
+
+    std::ofstream(filePath) << "bbc\naaa\nccc\n";
+    session.loadFileIncremental(filePath.c_str());
+    bool incremental = session.isLoadedIncrementally();
+
+    ASSERT_TRUE(!incremental);
+    compareSortedSpans(session.getSortedLines(SortOrder::DIRECT), { "aaa", "bbc", "ccc" });
+
+    session.clear();
+    fs::remove(filePath);
+    fs::remove(filePath.string() + SORT_STATE_EXTENSION);
+}
@@ -0,0 +1,31 @@
+/**
+ * @file
+ */
+#include <atomic>
+#include "testlib.h"
+#include "../src/ThreadPool.h"
+
+TEST(ThreadPool, run_allTasksAreRunOnce) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> runs(100);
+
+    pool.run(runs.size(), [&runs, &pool](size_t workerIndex, size_t taskIndex) {
+        assert(workerIndex < pool.size());
+        ++runs[taskIndex];
+    });
+
+    for (const std::atomic<int>& taskRuns : runs) {
+        ASSERT_EQUALS(taskRuns.load(), 1);
+    }
+}
+
+TEST(ThreadPool, severalRuns_poolIsReused) {
+    ThreadPool pool(3);
+    std::atomic<size_t> tasksNumber = 0;
+
+    for (size_t i = 0; i < 10; ++i) {
+        pool.run(i, [&tasksNumber](size_t, size_t) { ++tasksNumber; });
+    }
+
+    ASSERT_EQUALS(tasksNumber.load(), 45);
+}
@@ -0,0 +1,108 @@
+/**
+ * @file
+ */
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include "testlib.h"
+#include "../src/batch.h"
+
+namespace fs = std::filesystem;
+
+/**
+ * Creates a file with the given content (and all its parent directories).
+ * @param[in] path    path to the file
+ * @param[in] content content of the file
+ */
+void createTestFile(const fs::path& path, const char* content) {
+    fs::create_directories(path.parent_path());
+    std::ofstream(path) << content;
+}
+
+/**
+ * Reads the whole file.
+ * @param[in] path path to the file
+ * @return content of the file.
+ */
+std::string readTestFile(const fs::path& path) {
+    std::stringstream content;
+    content << std::ifstream(path).rdbuf();
+    return content.str();
+}
+
+/**
+ * Unique temporary directory for the test, so tests can be run in parallel.
+ * @param[in] name name of the test
+ * @return path to the directory.
+ */
+fs::path testDirectory(const char* name) {
+    return fs::temp_directory_path() / ("poem_sorter_" + std::to_string(getpid()) + "_" + name);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(batch, sortDirectory_resultsInPerFileDirectories) {
+    fs::path root = testDirectory("sortDirectory");
+    createTestFile(root / "input" / "first.txt", "bb\naa\n");
+    createTestFile(root / "input" / "nested" / "second.txt", "zz\nyy\n");
+    createTestFile(root / "input" / "empty.txt", "");
+
+    std::vector<BatchFile> files;
+    ASSERT_TRUE(collectBatchFiles((root / "input").c_str(), files));
+    ASSERT_EQUALS(files.size(), 3);
+
+    ThreadPool pool(2);
+    BatchStats stats = sortBatch(files, (root / "output").c_str(), false, nullptr, pool);
+
+    std::string firstDirect = readTestFile(root / "output" / "first.txt" / "direct_sorted.txt");
+    std::string secondReverse = readTestFile(root / "output" / "nested" / "second.txt" / "reverse_sorted.txt");
+    fs::remove_all(root);
+
+    ASSERT_EQUALS(stats.sortedFilesNumber, 2);
+    ASSERT_EQUALS(stats.skippedFilesNumber, 1);
+    ASSERT_EQUALS(stats.failedFilesNumber, 0);
+    ASSERT_EQUALS(firstDirect, "aa\nbb\n");
+    ASSERT_EQUALS(secondReverse, "yy\nzz\n");
+}
+
+TEST(batch, emptyFile_skippedMissingFileFailed) {
+    fs::path root = testDirectory("emptyFile");
+    createTestFile(root / "empty.txt", "");
+    std::string list = (root / "empty.txt").string() + "\n" + (root / "missing.txt").string() + "\n";
+    createTestFile(root / "list.txt", list.c_str());
+
+    std::vector<BatchFile> files;
+    ASSERT_TRUE(collectBatchFiles((root / "list.txt").c_str(), files));
+    ASSERT_EQUALS(files.size(), 2);
+
+    ThreadPool pool(2);
+    BatchStats stats = sortBatch(files, (root / "output").c_str(), false, nullptr, pool);
+    bool emptyWritten = fs::exists(root / "output" / files[0].outputName);
+    fs::remove_all(root);
+
+    ASSERT_EQUALS(stats.sortedFilesNumber, 0);
+    ASSERT_EQUALS(stats.skippedFilesNumber, 1);
+    ASSERT_EQUALS(stats.failedFilesNumber, 1);
+    ASSERT_TRUE(!emptyWritten);
+}
+
+TEST(batch, sortList_combinedOutputWithMarkers) {
+    fs::path root = testDirectory("sortList");
+    createTestFile(root / "first.txt", "bb\naa\n");
+    std::string list = (root / "first.txt").string() + "\n";
+    createTestFile(root / "list.txt", list.c_str());
+
+    std::vector<BatchFile> files;
+    ASSERT_TRUE(collectBatchFiles((root / "list.txt").c_str(), files));
+    ASSERT_EQUALS(files.size(), 1);
+
+    ThreadPool pool(1);
+    BatchStats stats = sortBatch(files, (root / "output").c_str(), true, nullptr, pool);
+
+    std::string direct = readTestFile(root / "output" / "direct_sorted.txt");
+    fs::remove_all(root);
+
+    ASSERT_EQUALS(stats.sortedFilesNumber, 1);
+    ASSERT_EQUALS(direct, "==> " + (root / "first.txt").string() + " <==\naa\nbb\n");
+}
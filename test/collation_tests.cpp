@@ -0,0 +1,99 @@
+/**
+ * @file
+ */
+#include <cstring>
+#include <string>
+#include "testlib.h"
+#include "../src/collation.h"
+#include "../src/sorted_index.h"
+#include "../src/sortlib.h"
+#include "../src/text_kernels.h"
+
+/**
+ * Compares two lines (C strings) in direct order with the given collation table.
+ * @param[in] str1  first line
+ * @param[in] str2  second line
+ * @param[in] table collation table
+ * @return result of compareLinesDirect.
+ */
+static int compareStringsDirect(const char* str1, const char* str2, const CollationTable& table) {
+    return compareLinesDirect(Line(str1, str1 + strlen(str1) - 1), Line(str2, str2 + strlen(str2) - 1), table);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(findCollationTable, builtInCollations) {
+    ASSERT_TRUE(findCollationTable(DEFAULT_COLLATION_NAME) == &DEFAULT_COLLATION_TABLE);
+    for (const char* name : { "en-uk", "en-be", "multi" }) {
+        const CollationTable* table = findCollationTable(name);
+        ASSERT_TRUE(table != nullptr);
+        ASSERT_TRUE(strcmp(table->name, name) == 0);
+    }
+    ASSERT_TRUE(findCollationTable("") == nullptr);
+    ASSERT_TRUE(findCollationTable("ru") == nullptr);
+}
+
+TEST(defaultCollation, sameAsHardCodedLetters) {
+    ASSERT_TRUE(&getCollationTable() == &DEFAULT_COLLATION_TABLE);
+
+    for (unsigned int first = 0; first < 256; ++first) {
+        for (unsigned int second = 0; second < 256; ++second) {
+            unsigned short expectedSize = isEnglishAlpha(first) ? 1 : (isRussianAlpha(first, second) ? 2 : 0);
+            ASSERT_EQUALS(getAlphaSizeDirect(first, second), expectedSize);
+            if (expectedSize == 0) continue;
+
+            char letter[] = { char(first), char(second) };
+            unsigned char expectedCode = expectedSize == 1
+                    ? tolower(first) - 'a' + 1
+                    : getRussianAlphaOrdinal(first, second) + 27;
+            ASSERT_EQUALS(getAlphaCode(letter, expectedSize), expectedCode);
+        }
+    }
+}
+
+TEST(multiCollation, moreLettersOrdered) {
+    const CollationTable& multi = *findCollationTable("multi");
+
+    ASSERT_EQUALS(getAlphaSizeDirect(*"ї", *("ї" + 1), multi), 2);
+    ASSERT_EQUALS(getAlphaSizeDirect(*"ї", *("ї" + 1), DEFAULT_COLLATION_TABLE), 0);
+    ASSERT_EQUALS(compareStringsDirect("Café", "cafe", multi), 0);
+    ASSERT_TRUE(compareStringsDirect("éa", "f", multi) < 0);
+    ASSERT_TRUE(compareStringsDirect("гарно", "ґанок", multi) < 0);
+    ASSERT_TRUE(compareStringsDirect("ґанок", "дім", multi) < 0);
+    ASSERT_TRUE(compareStringsDirect("Ірпінь", "їжак", multi) < 0);
+    ASSERT_TRUE(compareStringsDirect("ірис", "Ира", multi) > 0);
+    ASSERT_TRUE(compareStringsDirect("ува", "ўва", multi) < 0);
+    ASSERT_TRUE(compareStringsDirect("ўва", "фа", multi) < 0);
+    ASSERT_TRUE(compareLinesReverse(Line("Ґ", "Ґ" + 1), Line("Г", "Г" + 1), multi) > 0);
+    ASSERT_TRUE(getSortOptionsKey(multi) != getSortOptionsKey(DEFAULT_COLLATION_TABLE));
+    ASSERT_TRUE(getSortOptionsKey() == getSortOptionsKey(getCollationTable()));
+
+    std::string text = "її\nêé\n";
+    std::vector<Line> lines;
+    splitLines(text.data(), text.size(), lines, multi);
+    ASSERT_EQUALS(lines.size(), 2);
+
+    std::string defaultText = "її\nêé\n";
+    splitLines(defaultText.data(), defaultText.size(), lines, DEFAULT_COLLATION_TABLE);
+    ASSERT_EQUALS(lines.size(), 0);
+}
+
+TEST(multiCollation, allIsasFindSameLetters) {
+    const CollationTable& multi = *findCollationTable("multi");
+    std::string text;
+    for (int i = 0; i < 20; ++i) {
+        text += "Ґрунт, ўсё — café! Їжак\xD0\n";
+    }
+
+    const TextKernels& scalar = getIsaKernels(Isa::SCALAR);
+    ASSERT_EQUALS(scalar.findLetter(text.data() + 19, text.size() - 19, multi), 4);
+    // Lead byte followed by '\n' is not a letter, "Ґ" of the next line is
+    ASSERT_EQUALS(scalar.findLetter(text.data() + 38, text.size() - 38, multi), 2);
+    for (Isa isa : { Isa::SSE2, Isa::AVX2, Isa::AVX512 }) {
+        if (!isIsaSupported(isa)) continue;
+        for (size_t offset = 0; offset <= text.size(); ++offset) {
+            ASSERT_EQUALS(getIsaKernels(isa).findLetter(text.data() + offset, text.size() - offset, multi),
+                          scalar.findLetter(text.data() + offset, text.size() - offset, multi));
+        }
+    }
+}
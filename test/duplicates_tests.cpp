@@ -0,0 +1,83 @@
+/**
+ * @file
+ */
+#include <cstring>
+#include <string>
+#include <vector>
+#include "testlib.h"
+#include "../src/duplicates.h"
+#include "../src/line_output.h"
+#include "../src/SortSession.h"
+
+TEST(hashLineLetters, punctuationAndCaseAreIgnored) {
+    const char* text1 = "Ночь, улица, фонарь!";
+    const char* text2 = "ночь улица ФОНАРЬ";
+    std::vector<unsigned char> codes;
+
+    uint64_t hash1 = hashLineLetters(Line(text1, text1 + strlen(text1) - 1), codes);
+    uint64_t hash2 = hashLineLetters(Line(text2, text2 + strlen(text2) - 1), codes);
+
+    ASSERT_EQUALS(hash1, hash2);
+}
+
+TEST(collapseDuplicates, firstOccurrencesAndCountsExpected) {
+    char text[] = "Refrain!\nabc\nrefrain\nxyz\n- REFRAIN -\nabc\n";
+    std::vector<Line> lines = splitLines(text, strlen(text));
+
+    DistinctLines distinct;
+    collapseDuplicates(lines, distinct);
+
+    ASSERT_TRUE(distinct.lineIndices == std::vector<size_t>({ 0, 1, 3 }));
+    ASSERT_TRUE(distinct.counts == std::vector<size_t>({ 3, 2, 1 }));
+}
+
+TEST(collapseDuplicates, arenaReusedForManyTexts) {
+    char text[] = "Refrain!\nabc\nrefrain\nxyz\n- REFRAIN -\nabc\n";
+    std::vector<Line> lines = splitLines(text, strlen(text));
+
+    Arena scratch;
+    DistinctLines distinct;
+    for (size_t i = 0; i < 3; ++i) {
+        scratch.reset();
+        collapseDuplicates(lines, distinct, scratch);
+        ASSERT_TRUE(distinct.lineIndices == std::vector<size_t>({ 0, 1, 3 }));
+        ASSERT_TRUE(distinct.counts == std::vector<size_t>({ 3, 2, 1 }));
+    }
+    ASSERT_EQUALS(scratch.getBlocksAllocated(), 1);
+}
+
+TEST(SortSession, collapseDuplicateLines_distinctLinesSortedWithCounts) {
+    char text[] = "bbb\naaa\n\nBbb.\nccc\naaa\nbbb\n";
+    SortSession session;
+    session.setLineNumbering(true);
+    session.loadBuffer(text, strlen(text));
+    session.collapseDuplicateLines();
+
+    std::vector<char> buffer;
+    appendCountedLines(
+            buffer, session.getLines(), session.getLineCounts(), session.getLineNumbers(),
+            session.getSortedPermutation(SortOrder::DIRECT)
+    );
+
+    ASSERT_EQUALS(session.getLines().size(), 3);
+    // Empty line has no letters, so it's not kept, but it's counted in the line numbers
+    ASSERT_TRUE(std::string(buffer.begin(), buffer.end()) == "2\t2\taaa\n3\t1\tbbb\n1\t5\tccc\n");
+}
+
+TEST(SortSession, collapseDuplicateLines_literalNulsDontShiftLineNumbers) {
+    std::string original("bbb\naa\0a\n\0\nccc\nbbb\n", 19);
+    for (bool readOnly : { false, true }) {
+        std::vector<char> text(original.begin(), original.end());
+        MappingHints hints;
+        hints.readOnly = readOnly;
+        SortSession session;
+        session.setMappingHints(hints);
+        session.setLineNumbering(true);
+        session.loadBuffer(text.data(), text.size());
+        session.collapseDuplicateLines();
+
+        ASSERT_EQUALS(session.getLines().size(), 3);
+        ASSERT_TRUE(session.getLineNumbers() == std::vector<size_t>({ 1, 2, 4 }));
+        ASSERT_TRUE(std::string(text.begin(), text.end()) == original);
+    }
+}
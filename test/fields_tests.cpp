@@ -0,0 +1,72 @@
+/**
+ * @file
+ */
+#include <cstring>
+#include <string>
+#include "testlib.h"
+#include "../src/fields.h"
+#include "../src/SortSession.h"
+
+/**
+ * Copies lines to strings.
+ * @param[in] lines lines to copy
+ * @return copied lines.
+ */
+static std::vector<std::string> linesToStrings(const std::vector<Line>& lines) {
+    std::vector<std::string> result;
+    for (auto [start, end] : lines) {
+        result.emplace_back(start, end + 1);
+    }
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(parseKeyField, validAndInvalidSpecifications) {
+    KeyField field;
+
+    ASSERT_TRUE(parseKeyField("2", field) && field.firstWord == 2 && field.lastWord == -1);
+    ASSERT_TRUE(parseKeyField("-1", field) && field.firstWord == -1 && field.lastWord == -1);
+    ASSERT_TRUE(parseKeyField("2,3", field) && field.firstWord == 2 && field.lastWord == 3);
+    ASSERT_TRUE(!parseKeyField("0", field));
+    ASSERT_TRUE(!parseKeyField("1,", field));
+    ASSERT_TRUE(!parseKeyField("1x", field));
+}
+
+TEST(splitLines, wordBoundsExpected) {
+    char text[] = "Ночь, улица!\n...\n- abc -\n";
+    std::vector<Line> lines;
+    WordTable words;
+    splitLines(text, strlen(text), lines, words);
+
+    ASSERT_EQUALS(lines.size(), 2);
+    ASSERT_TRUE(words.lineWordStarts == std::vector<uint32_t>({ 0, 2, 3 }));
+    ASSERT_TRUE(words.wordBounds == std::vector<uint32_t>({ 0, 8, 10, 20, 2, 5 }));
+}
+
+TEST(buildKeyFields, fieldsAndMissingFieldsExpected) {
+    char text[] = "one two, three\nfour\n";
+    std::vector<Line> lines;
+    WordTable words;
+    splitLines(text, strlen(text), lines, words);
+
+    std::vector<Line> keys;
+    buildKeyFields(lines, words, { 2, 2 }, keys);
+    ASSERT_TRUE(linesToStrings(keys) == std::vector<std::string>({ "two", "" }));
+
+    buildKeyFields(lines, words, { -1, -1 }, keys);
+    ASSERT_TRUE(linesToStrings(keys) == std::vector<std::string>({ "three", "four" }));
+
+    buildKeyFields(lines, words, { 2, -1 }, keys);
+    ASSERT_TRUE(linesToStrings(keys) == std::vector<std::string>({ "two, three", "" }));
+}
+
+TEST(SortSession, keyField_sortedByLastWordThenByLine) {
+    char text[] = "b zzz\nc aaa\na zzz\nd mmm!\n";
+    SortSession session;
+    session.setKeyField({ -1, -1 });
+    session.loadBuffer(text, strlen(text));
+
+    ASSERT_TRUE(linesToStrings(session.getSortedLines(SortOrder::DIRECT))
+                == std::vector<std::string>({ "c aaa", "d mmm!", "a zzz", "b zzz" }));
+}
@@ -0,0 +1,19 @@
+/**
+ * @file
+ */
+#include <cstring>
+#include "testlib.h"
+#include "../src/hash.h"
+
+TEST(hashBytes, emptyInput_referenceValueExpected) {
+    ASSERT_EQUALS(hashBytes("", 0), 0xEF46DB3751D8E999ull);
+}
+
+TEST(hashBytes, shortInput_referenceValueExpected) {
+    ASSERT_EQUALS(hashBytes("abc", 3), 0x44BC2CF5AD770999ull);
+}
+
+TEST(hashBytes, longInputWithSeed_referenceValueExpected) {
+    const char* text = "0123456789abcdefghijklmnopqrstuvwxyz0123456789";
+    ASSERT_EQUALS(hashBytes(text, strlen(text), 7), 0x12163B10950CE955ull);
+}
@@ -0,0 +1,79 @@
+/**
+ * @file
+ */
+#include <cstring>
+#include <string>
+#include "testlib.h"
+#include "../src/line_filter.h"
+#include "../src/SortSession.h"
+
+/**
+ * Copies lines to strings.
+ * @param[in] lines lines to copy
+ * @return copied lines.
+ */
+static std::vector<std::string> linesToStrings(const std::vector<Line>& lines) {
+    std::vector<std::string> result;
+    for (auto [start, end] : lines) {
+        result.emplace_back(start, end + 1);
+    }
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(parseLetterPattern, matchesExpected) {
+    std::vector<unsigned char> pattern;
+    std::vector<unsigned char> codes;
+    char text[] = "Ночь, улица, фонарь";
+    appendAlphaCodes(Line(text, text + strlen(text) - 1), codes);
+
+    ASSERT_TRUE(parseLetterPattern("улица", pattern) && matchesLetterPattern(pattern, codes));
+    ASSERT_TRUE(parseLetterPattern("^НОЧЬ", pattern) && matchesLetterPattern(pattern, codes));
+    ASSERT_TRUE(parseLetterPattern("ф.нарь$", pattern) && matchesLetterPattern(pattern, codes));
+    ASSERT_TRUE(parseLetterPattern("^ночь*фонарь$", pattern) && matchesLetterPattern(pattern, codes));
+    ASSERT_TRUE(parseLetterPattern("ночь$", pattern) && !matchesLetterPattern(pattern, codes));
+    ASSERT_TRUE(parseLetterPattern("^улица", pattern) && !matchesLetterPattern(pattern, codes));
+    ASSERT_TRUE(!parseLetterPattern("^$", pattern));
+    ASSERT_TRUE(!parseLetterPattern("a b", pattern));
+}
+
+TEST(splitLines, filteredLinesDropped) {
+    const std::string text = "Ночь, улица, фонарь, аптека,\nbessmyslenny i tusklyi svet.\nZhivi eshche\n...\nVsyo budet tak.\n";
+    std::string textCopy;
+    std::vector<Line> lines;
+    LineFilter filter;
+
+    // Splitting replaces '\n' with '\0', so each split gets a fresh copy of the text
+    textCopy = text;
+    filter.capital = true;
+    filter.minLetters = 12;
+    splitLines(textCopy.data(), textCopy.size(), lines, filter);
+    ASSERT_TRUE(linesToStrings(lines) == std::vector<std::string>({ "Ночь, улица, фонарь, аптека,", "Vsyo budet tak." }));
+
+    textCopy = text;
+    filter = LineFilter();
+    filter.maxLetters = 11;
+    splitLines(textCopy.data(), textCopy.size(), lines, filter);
+    ASSERT_TRUE(linesToStrings(lines) == std::vector<std::string>({ "Zhivi eshche" }));
+
+    textCopy = text;
+    filter = LineFilter();
+    filter.substring = "tak";
+    ASSERT_TRUE(parseLetterPattern("budet", filter.pattern));
+    splitLines(textCopy.data(), textCopy.size(), lines, filter);
+    ASSERT_TRUE(linesToStrings(lines) == std::vector<std::string>({ "Vsyo budet tak." }));
+}
+
+TEST(splitLines, filteredWordBoundsExpected) {
+    char text[] = "one two\nthree\nfour five\n";
+    std::vector<Line> lines;
+    WordTable words;
+    LineFilter filter;
+    filter.substring = "o";
+    splitLines(text, strlen(text), lines, words, filter);
+
+    ASSERT_EQUALS(lines.size(), 2);
+    ASSERT_TRUE(words.lineWordStarts == std::vector<uint32_t>({ 0, 2, 4 }));
+    ASSERT_TRUE(words.wordBounds == std::vector<uint32_t>({ 0, 3, 4, 7, 0, 4, 5, 9 }));
+}
@@ -0,0 +1,74 @@
+/**
+ * @file
+ */
+#include <cstring>
+#include <string>
+#include "testlib.h"
+#include "../src/line_table.h"
+#include "../src/rhymes.h"
+#include "../src/sortlib.h"
+
+/**
+ * Sign of the comparison result.
+ * @param[in] cmpResult result of the three-way comparison
+ * @return -1, 0 or +1.
+ */
+static int sign(int cmpResult) {
+    return (cmpResult > 0) - (cmpResult < 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(buildLineTable, columnsExpected) {
+    char text[] = "Ab, c!\n\nодин два три четыре\n";
+    std::vector<Line> lines = splitLines(text, strlen(text));
+    LineTable table;
+    ASSERT_TRUE(buildLineTable(text, lines, table));
+
+    ASSERT_EQUALS(table.offsets.size(), 2);
+    ASSERT_EQUALS(table.offsets[0], 0);
+    ASSERT_EQUALS(table.offsets[1], 8);
+    ASSERT_EQUALS(table.lengths[0], 6);
+    ASSERT_EQUALS(table.letterCounts[0], 3);
+    ASSERT_EQUALS(table.letterCounts[1], 16);
+    ASSERT_EQUALS(table.prefixKeys[0], (1ull << 56) | (2ull << 48) | (3ull << 40));
+    ASSERT_TRUE(table.originalIndices == std::vector<uint32_t>({ 0, 1 }));
+    for (size_t i = 0; i < lines.size(); ++i) {
+        ASSERT_EQUALS(table.suffixKeys[i], getRhymeKey(lines[i], LINE_TABLE_KEY_LETTERS));
+        Line line = getTableLine(table, i);
+        ASSERT_TRUE(line.lineStart == lines[i].lineStart && line.lineEnd == lines[i].lineEnd);
+    }
+}
+
+TEST(compareTableLines, matchesLineComparators) {
+    // Lines share long prefixes and suffixes, so both the keys and the fallback to the text are checked
+    std::string text =
+            "abcdefgh\nabcdefghi\nAbcdefgh!\nabcdefgz\nab\nabcdefghij klm\nabcdefghij kln\nxbcdefghij klm\n"
+            "Ёлка ёлка ёлка\nелка ёлка ёлка\nжили-были ёлка\nЯ\nя.\nz ёлка ёлка ёлка\n";
+    std::vector<Line> lines = splitLines(text.data(), text.size());
+    LineTable table;
+    ASSERT_TRUE(buildLineTable(text.data(), lines, table));
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        for (size_t j = 0; j < lines.size(); ++j) {
+            ASSERT_EQUALS(
+                    sign(compareTableLines(table, i, j, SortKey::DIRECT)), sign(compareLinesDirect(lines[i], lines[j]))
+            );
+            ASSERT_EQUALS(
+                    sign(compareTableLines(table, i, j, SortKey::REVERSE)), sign(compareLinesReverse(lines[i], lines[j]))
+            );
+        }
+    }
+}
+
+TEST(sortLineIndicesByTable, equalLinesKeepOriginalOrder) {
+    char text[] = "b\nA.\na\nc\n- a -\n";
+    std::vector<Line> lines = splitLines(text, strlen(text));
+    LineTable table;
+    ASSERT_TRUE(buildLineTable(text, lines, table));
+
+    std::vector<size_t> indices = { 4, 3, 2, 1, 0 };
+    sortLineIndicesByTable(indices.begin(), indices.end(), table, SortKey::DIRECT);
+
+    ASSERT_TRUE(indices == std::vector<size_t>({ 1, 2, 4, 0, 3 }));
+}
@@ -1,8 +1,35 @@
 /**
  * @file
+ *
+ * Usage: tests [-j threads_number] [--bench]
+ *
+ * Without arguments runs all tests one by one.
+ * -j runs tests on the given number of threads.
+ * --bench runs benchmarks after the tests.
  */
+#include <cstdlib>
+#include <cstring>
 #include "testlib.h"
 
-int main() {
-    return TestRunner::getInstance()->runAllTests() ? 0 : -1;
+int main(int argc, char* argv[]) {
+    unsigned int threadsNumber = 1;
+    bool runBenchmarks = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threadsNumber = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            runBenchmarks = true;
+        } else {
+            fprintf(stderr, "Usage: %s [-j threads_number] [--bench]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    TestRunner* runner = TestRunner::getInstance();
+    bool testsPassed = runner->runAllTests(threadsNumber);
+    if (runBenchmarks) {
+        runner->runAllBenchmarks();
+    }
+    return testsPassed ? 0 : -1;
 }
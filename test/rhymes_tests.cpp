@@ -0,0 +1,92 @@
+/**
+ * @file
+ */
+#include <cstring>
+#include "testlib.h"
+#include "../src/rhymes.h"
+#include "../src/sortlib.h"
+
+/**
+ * Creates Line from the C-string.
+ * @param[in] str string to create Line from
+ * @return Line that contains the string without '\\0'.
+ */
+static Line rhymeTestLine(const char* str) {
+    return { str, str + strlen(str) - 1 };
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(getRhymeKey, punctuationIsSkipped_equalKeysExpected) {
+    ASSERT_EQUALS(getRhymeKey(rhymeTestLine("The night,"), 3), getRhymeKey(rhymeTestLine("a LIGHT!"), 3));
+    ASSERT_EQUALS(getRhymeKey(rhymeTestLine("мороз и солнце;"), 3), getRhymeKey(rhymeTestLine("оконце"), 3));
+}
+
+TEST(getRhymeKey, differentEndings_differentKeysExpected) {
+    ASSERT_TRUE(getRhymeKey(rhymeTestLine("night"), 3) != getRhymeKey(rhymeTestLine("nights"), 3));
+}
+
+TEST(getRhymeKey, keysAreOrderedAsReverseComparison) {
+    std::vector<const char*> endings = { "ab", "b", "cb", "a b", "ва", "ба", "я" };
+    for (const char* first : endings) {
+        for (const char* second : endings) {
+            Line line1 = rhymeTestLine(first);
+            Line line2 = rhymeTestLine(second);
+            int cmpResult = compareLinesReverse(line1, line2);
+            uint64_t key1 = getRhymeKey(line1, 2);
+            uint64_t key2 = getRhymeKey(line2, 2);
+            ASSERT_EQUALS(cmpResult < 0, key1 < key2);
+            ASSERT_EQUALS(cmpResult > 0, key1 > key2);
+        }
+    }
+}
+
+TEST(groupByRhyme, linesAreGroupedAndGroupsAreOrdered) {
+    std::vector<Line> lines = {
+            rhymeTestLine("I see the light"),
+            rhymeTestLine("a day"),
+            rhymeTestLine("in the night"),
+            rhymeTestLine("we play,"),
+            rhymeTestLine("what a sight!"),
+    };
+
+    RhymeGroups groups;
+    groupByRhyme(lines, 2, groups);
+
+    ASSERT_EQUALS(groups.keys.size(), 2);
+    ASSERT_TRUE(groups.keys[0] < groups.keys[1]);
+    ASSERT_TRUE(groups.groupStarts == std::vector<size_t>({ 0, 3, 5 }));
+    ASSERT_TRUE(groups.lineIndices == std::vector<size_t>({ 0, 2, 4, 1, 3 }));
+}
+
+TEST(detectRhymeSchemes, stanzasSeparatedByLinesWithoutLetters) {
+    char text[] = "I see the light\na day\nin the night,\nwe play\n\nMy cat\nsits on a mat;\nthe sun\nis fun\n"
+                  "  * * *\nМороз и солнце;\nдень чудесный!\nЕще ты дремлешь,\nдруг прелестный\n";
+    std::vector<Line> lines = splitLines(text, strlen(text));
+
+    std::string schemes;
+    detectRhymeSchemes(lines, 2, schemes);
+
+    ASSERT_TRUE(!isStanzaBreak(lines[0], lines[1]));
+    ASSERT_TRUE(isStanzaBreak(lines[3], lines[4]));
+    ASSERT_TRUE(schemes == "ABAB AABB ABCB");
+}
+
+TEST(detectRhymeSchemes, tooManyRhymes_overflowMarked) {
+    std::string text;
+    for (char first = 'a'; first <= 'c'; ++first) {
+        for (char second = 'a'; second <= 'z'; ++second) {
+            text += std::string("x") + first + second + "\n";
+        }
+    }
+    text += "xaa\n";
+    std::vector<Line> lines = splitLines(text.data(), text.size());
+
+    std::string schemes;
+    detectRhymeSchemes(lines, 2, schemes);
+
+    ASSERT_EQUALS(schemes.size(), 3 * 26 + 1);
+    ASSERT_TRUE(schemes.substr(0, 3) == "ABC");
+    ASSERT_TRUE(schemes.substr(50, 3) == "yz*");
+    ASSERT_EQUALS(schemes.back(), 'A');
+}
@@ -0,0 +1,53 @@
+/**
+ * @file
+ */
+#include <cstring>
+#include <string>
+#include "testlib.h"
+#include "../src/sort_keys.h"
+#include "../src/sortlib.h"
+#include "../src/SortSession.h"
+
+TEST(parseSortKeys, validAndInvalidSpecifications) {
+    std::vector<SortKey> keys;
+
+    ASSERT_TRUE(parseSortKeys("reverse,direct", keys));
+    ASSERT_TRUE(keys == std::vector<SortKey>({ SortKey::REVERSE, SortKey::DIRECT }));
+    ASSERT_TRUE(parseSortKeys("length", keys));
+    ASSERT_TRUE(keys == std::vector<SortKey>({ SortKey::LENGTH }));
+    ASSERT_TRUE(!parseSortKeys("", keys));
+    ASSERT_TRUE(!parseSortKeys("direct,", keys));
+    ASSERT_TRUE(!parseSortKeys("directly", keys));
+}
+
+TEST(compareLineKeys, sameResultsAsLineComparators) {
+    char text[] = "Abc, de\nabcd!\nЁж\nеж\nab\nZ\nzz\n";
+    std::vector<Line> lines = splitLines(text, strlen(text));
+    LineKeys keys;
+    buildLineKeys(lines, keys);
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        for (size_t j = 0; j < lines.size(); ++j) {
+            int direct = compareLinesDirect(lines[i], lines[j]);
+            int reverse = compareLinesReverse(lines[i], lines[j]);
+            ASSERT_EQUALS(compareLineKeys(keys, i, j, SortKey::DIRECT) < 0, direct < 0);
+            ASSERT_EQUALS(compareLineKeys(keys, i, j, SortKey::DIRECT) == 0, direct == 0);
+            ASSERT_EQUALS(compareLineKeys(keys, i, j, SortKey::REVERSE) < 0, reverse < 0);
+            ASSERT_EQUALS(compareLineKeys(keys, i, j, SortKey::REVERSE) == 0, reverse == 0);
+        }
+    }
+}
+
+TEST(SortSession, compositeOrder_byRhymeThenDirect) {
+    char text[] = "zz day\nplay\naa day\nbb night\n";
+    SortSession session;
+    session.setSortKeys({ SortKey::LENGTH, SortKey::REVERSE, SortKey::DIRECT });
+    session.loadBuffer(text, strlen(text));
+
+    std::vector<std::string> sorted;
+    for (auto [start, end] : session.getSortedLines(SortOrder::COMPOSITE)) {
+        sorted.emplace_back(start, end + 1);
+    }
+
+    ASSERT_TRUE(sorted == std::vector<std::string>({ "play", "aa day", "zz day", "bb night" }));
+}
@@ -428,3 +428,120 @@ TEST(sortLinesReverse, randomUnsortedLines_russian) {
 
     compareLines(lines, expectedResult);
 }
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Generates text of random english lines for benchmarks.
+ * @param[in] linesNumber number of lines to generate
+ * @return generated text. Each line ends with '\\0'.
+ */
+static std::vector<char> generateBenchmarkText(size_t linesNumber) {
+    std::vector<char> text;
+    unsigned int seed = 42;
+    for (size_t i = 0; i < linesNumber; ++i) {
+        size_t lineLength = 10 + rand_r(&seed) % 40;
+        for (size_t j = 0; j < lineLength; ++j) {
+            text.push_back(j % 6 == 5 ? ' ' : static_cast<char>('a' + rand_r(&seed) % 26));
+        }
+        text.push_back('\0');
+    }
+    return text;
+}
+
+/**
+ * Splits text generated by generateBenchmarkText into Lines.
+ * @param[in] text text to split
+ * @return lines of the text.
+ */
+static std::vector<Line> benchmarkTextToLines(const std::vector<char>& text) {
+    std::vector<Line> lines;
+    const char* lineStart = text.data();
+    for (const char* cur = text.data(); cur < text.data() + text.size(); ++cur) {
+        if (*cur == '\0') {
+            lines.emplace_back(lineStart, cur - 1);
+            lineStart = cur + 1;
+        }
+    }
+    return lines;
+}
+
+static const std::vector<char> benchmarkText = generateBenchmarkText(2000);
+static const std::vector<Line> benchmarkLines = benchmarkTextToLines(benchmarkText);
+
+BENCH(sortLines, direct_2000Lines) {
+    std::vector<Line> lines = benchmarkLines;
+    sortLines(lines.begin(), lines.end(), compareLinesDirect);
+    benchDoNotOptimize(lines.data());
+}
+
+BENCH(sortLines, reverse_2000Lines) {
+    std::vector<Line> lines = benchmarkLines;
+    sortLines(lines.begin(), lines.end(), compareLinesReverse);
+    benchDoNotOptimize(lines.data());
+}
+
+TEST(partialSortLineIndices, headMatchesFullSort) {
+    std::vector<size_t> full(benchmarkLines.size());
+    for (size_t i = 0; i < full.size(); ++i) full[i] = i;
+    std::vector<size_t> partial = full;
+
+    sortLineIndices(full.begin(), full.end(), benchmarkLines, compareLinesReverse);
+    partialSortLineIndices(partial.begin(), partial.begin() + 100, partial.end(), benchmarkLines, compareLinesReverse);
+
+    // Random lines are distinct, so the first lines of both sorts are the same
+    for (size_t i = 0; i < 100; ++i) {
+        ASSERT_EQUALS(partial[i], full[i]);
+    }
+}
+
+BENCH(partialSortLineIndices, direct_100Of2000Lines) {
+    std::vector<size_t> indices(benchmarkLines.size());
+    for (size_t i = 0; i < indices.size(); ++i) indices[i] = i;
+    partialSortLineIndices(indices.begin(), indices.begin() + 100, indices.end(), benchmarkLines, compareLinesDirect);
+    benchDoNotOptimize(indices.data());
+}
+
+TEST(sortLineIndicesByTable, matchesSortLineIndices) {
+    LineTable table;
+    ASSERT_TRUE(buildLineTable(benchmarkText.data(), benchmarkLines, table));
+
+    for (SortKey key : { SortKey::DIRECT, SortKey::REVERSE }) {
+        int (*compare)(const Line&, const Line&) = compareLinesReverse;
+        if (key == SortKey::DIRECT) compare = compareLinesDirect;
+        std::vector<size_t> expected(benchmarkLines.size());
+        for (size_t i = 0; i < expected.size(); ++i) expected[i] = i;
+        std::vector<size_t> actual = expected;
+
+        sortLineIndices(expected.begin(), expected.end(), benchmarkLines, compare);
+        sortLineIndicesByTable(actual.begin(), actual.end(), table, key);
+
+        // Random lines are distinct, so both sorts give the same order
+        ASSERT_TRUE(actual == expected);
+    }
+}
+
+BENCH(sortLineIndices, direct_2000Lines) {
+    std::vector<size_t> indices(benchmarkLines.size());
+    for (size_t i = 0; i < indices.size(); ++i) indices[i] = i;
+    sortLineIndices(indices.begin(), indices.end(), benchmarkLines, compareLinesDirect);
+    benchDoNotOptimize(indices.data());
+}
+
+BENCH(sortLineIndicesByTable, direct_2000Lines) {
+    LineTable table;
+    buildLineTable(benchmarkText.data(), benchmarkLines, table);
+    std::vector<size_t> indices(benchmarkLines.size());
+    for (size_t i = 0; i < indices.size(); ++i) indices[i] = i;
+    sortLineIndicesByTable(indices.begin(), indices.end(), table, SortKey::DIRECT);
+    benchDoNotOptimize(indices.data());
+}
+
+BENCH(sortLineIndicesByTable, reverse_2000Lines) {
+    LineTable table;
+    buildLineTable(benchmarkText.data(), benchmarkLines, table);
+    std::vector<size_t> indices(benchmarkLines.size());
+    for (size_t i = 0; i < indices.size(); ++i) indices[i] = i;
+    sortLineIndicesByTable(indices.begin(), indices.end(), table, SortKey::REVERSE);
+    benchDoNotOptimize(indices.data());
+}
@@ -2,8 +2,14 @@
  * @file
  * @brief Source file with testlib implementation
  */
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include "testlib.h"
 
+/** Test that is currently executed on this thread. Separate for each thread, so tests can be run in parallel. **/
+static thread_local Test* currentThreadTest = nullptr;
+
 Test::Test(const TestPtr& function_ptr, const char* fileName, unsigned int line) {
     assert(function_ptr != nullptr);
     assert(fileName != nullptr);
@@ -39,12 +45,70 @@ unsigned int Test::line() const {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+Benchmark::Benchmark(const BenchmarkPtr& function_ptr, const char* group, const char* name, const char* fileName, unsigned int line) {
+    assert(function_ptr != nullptr);
+    assert(group != nullptr);
+    assert(name != nullptr);
+    assert(fileName != nullptr);
+    assert(line != 0);
+
+    _function_ptr = function_ptr;
+    _group = group;
+    _name = name;
+    _fileName = fileName;
+    _line = line;
+}
+
+/**
+ * Runs one operation of this benchmark.
+ */
+void Benchmark::run() const {
+    _function_ptr();
+}
+
+/**
+ * Group of this benchmark.
+ * @return group name.
+ */
+const char* Benchmark::group() const {
+    return _group;
+}
+
+/**
+ * Name of this benchmark.
+ * @return benchmark name.
+ */
+const char* Benchmark::name() const {
+    return _name;
+}
+
+/**
+ * Name of the file this benchmark was created in.
+ * @return name of the file.
+ */
+const char* Benchmark::fileName() const {
+    return _fileName;
+}
+
+/**
+ * Line of the file this benchmark was created on.
+ * @return line number of the file.
+ */
+unsigned int Benchmark::line() const {
+    return _line;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 TestRunner::TestRunner() = default;
 
 TestRunner::~TestRunner() {
     for (Test* test : allTests) {
         delete test;
     }
+    for (Benchmark* benchmark : allBenchmarks) {
+        delete benchmark;
+    }
 }
 
 /**
@@ -62,25 +126,60 @@ Test* TestRunner::addTest(TestPtr testPtr, const char* fileName, unsigned int li
 }
 
 /**
- * Removes all tests from the container.
+ * Registers new benchmark in this runner.
+ * @param[in] benchmarkPtr pointer to a benchmark function
+ * @param[in] group        group of the benchmark
+ * @param[in] name         name of the benchmark
+ * @param[in] fileName     name of the file benchmark declared in
+ * @param[in] line         line number of the file benchmark declared on
+ * @return pointer to a created Benchmark object.
+ */
+Benchmark* TestRunner::addBenchmark(BenchmarkPtr benchmarkPtr, const char* group, const char* name, const char* fileName, unsigned int line) {
+    Benchmark* benchmark = new Benchmark(benchmarkPtr, group, name, fileName, line);
+    allBenchmarks.push_back(benchmark);
+    return benchmark;
+}
+
+/**
+ * Removes all tests and benchmarks from the container.
  */
 void TestRunner::clear() {
     allTests.clear();
+    allBenchmarks.clear();
 }
 
 /**
  * Runs all tests that exist in this runner. Use in the main() method to run every written test.
+ * If threadsNumber is greater than 1, tests are distributed between a pool of threads.
+ * @param[in] threadsNumber number of threads to run tests on
  * @return true, if all tests succeeded, false otherwise.
  */
-bool TestRunner::runAllTests() {
-    unsigned int passedTestsNumber = 0;
-    unsigned int failedTestsNumber = 0;
+bool TestRunner::runAllTests(unsigned int threadsNumber) {
+    std::atomic<unsigned int> passedTestsNumber = 0;
+    std::atomic<unsigned int> failedTestsNumber = 0;
+    std::atomic<size_t> nextTestIndex = 0;
 
-    for (Test* test : allTests) {
-        if (runTest(test)) {
-            ++passedTestsNumber;
-        } else {
-            ++failedTestsNumber;
+    auto worker = [&]() {
+        for (size_t i = nextTestIndex++; i < allTests.size(); i = nextTestIndex++) {
+            if (runTest(allTests[i])) {
+                ++passedTestsNumber;
+            } else {
+                ++failedTestsNumber;
+            }
+        }
+    };
+
+    if (threadsNumber > allTests.size()) threadsNumber = allTests.size();
+    if (threadsNumber <= 1) {
+        worker();
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(threadsNumber);
+        for (unsigned int i = 0; i < threadsNumber; ++i) {
+            threads.emplace_back(worker);
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
         }
     }
 
@@ -98,22 +197,41 @@ bool TestRunner::runAllTests() {
 }
 
 /**
- * Run the given test.
+ * Runs all benchmarks that exist in this runner one by one.
+ * Each benchmark is warmed up first, then it's measured in a few samples of fixed number of operations.
+ * @param[in] warmupIterations number of operations that are run before measurements
+ * @param[in] iterations       number of operations in one sample
+ * @param[in] samples          number of measured samples
+ */
+void TestRunner::runAllBenchmarks(unsigned int warmupIterations, unsigned int iterations, unsigned int samples) {
+    assert(iterations > 0);
+    assert(samples > 0);
+
+    for (Benchmark* benchmark : allBenchmarks) {
+        runBenchmark(benchmark, warmupIterations, iterations, samples);
+    }
+}
+
+/**
+ * Run the given test. Prints the test result and its duration.
  * @param[in] test pointer to a test to run
  * @return true, if the test succeeded, false otherwise.
  */
 bool TestRunner::runTest(Test* test) {
     assert(test != nullptr);
 
-    _currentTest = test;
+    currentThreadTest = test;
 
+    auto startTime = std::chrono::steady_clock::now();
     test->run();
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - startTime;
 
-    if (_currentTest != nullptr) {
-        _currentTest = nullptr;
+    if (currentThreadTest != nullptr) {
+        currentThreadTest = nullptr;
 
+        std::lock_guard<std::mutex> outputLock(_outputMutex);
         std::cerr << TESTLIB_ANSI_COLOR_GREEN;
-        std::cerr << "[TEST PASSED] " << test->fileName() << ':' << test->line() << '\n';
+        std::cerr << "[TEST PASSED] " << test->fileName() << ':' << test->line() << " (" << duration.count() << " ms)\n";
         std::cerr << TESTLIB_ANSI_COLOR_RESET;
 
         return true;
@@ -123,18 +241,70 @@ bool TestRunner::runTest(Test* test) {
 }
 
 /**
- * Fails current test. Use in assertions to show that the current test is failed.
+ * Runs the given benchmark and prints mean time per operation and its standard deviation.
+ * @param[in] benchmark         pointer to a benchmark to run
+ * @param[in] warmupIterations  number of operations that are run before measurements
+ * @param[in] iterations        number of operations in one sample
+ * @param[in] samples           number of measured samples
+ */
+void TestRunner::runBenchmark(Benchmark* benchmark, unsigned int warmupIterations, unsigned int iterations, unsigned int samples) {
+    assert(benchmark != nullptr);
+
+    for (unsigned int i = 0; i < warmupIterations; ++i) {
+        benchmark->run();
+    }
+
+    std::vector<double> sampleTimes(samples);
+    for (unsigned int sample = 0; sample < samples; ++sample) {
+        auto startTime = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < iterations; ++i) {
+            benchmark->run();
+        }
+        std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - startTime;
+        sampleTimes[sample] = duration.count() / iterations;
+    }
+
+    double mean = 0;
+    for (double time : sampleTimes) mean += time;
+    mean /= samples;
+
+    double variance = 0;
+    for (double time : sampleTimes) variance += (time - mean) * (time - mean);
+    variance /= samples;
+
+    std::lock_guard<std::mutex> outputLock(_outputMutex);
+    std::ios_base::fmtflags oldFlags = std::cerr.flags();
+    std::streamsize oldPrecision = std::cerr.precision(1);
+    std::cerr << std::fixed;
+    std::cerr << "[BENCH] " << benchmark->group() << '.' << benchmark->name() << " : "
+              << mean << " ns/op +- " << sqrt(variance) << " ns/op"
+              << " (" << samples << " x " << iterations << " ops) "
+              << benchmark->fileName() << ':' << benchmark->line() << '\n';
+    std::cerr.flags(oldFlags);
+    std::cerr.precision(oldPrecision);
+}
+
+/**
+ * Fails current test of the calling thread. Use in assertions to show that the current test is failed.
  */
 void TestRunner::failCurrentTest() {
-    _currentTest = nullptr;
+    currentThreadTest = nullptr;
 }
 
 /**
- * Pointer to a current test executed by this runner.
+ * Pointer to a current test executed by this runner on the calling thread.
  * @return pointer to a current running test
  */
 const Test* TestRunner::currentTest() const {
-    return _currentTest;
+    return currentThreadTest;
+}
+
+/**
+ * Mutex that should be locked while printing something to std::cerr from tests.
+ * @return output mutex.
+ */
+std::mutex& TestRunner::outputMutex() {
+    return _outputMutex;
 }
 
 /**
@@ -9,6 +9,12 @@
  * You can use assertions in test functions to check some condition
  * (for example, ASSERT_TRUE(condition) or ASSERT_EQUALS(actual, expected)).
  *
+ * Tests can be run in parallel by passing the number of threads to TestRunner.runAllTests(threadsNumber).
+ * Assertions are thread-safe, but tests that are run in parallel must not share files or other global state.
+ *
+ * Micro-benchmarks can be created with BENCH(group, name) macro.
+ * Benchmark body is a single operation that is measured. Use TestRunner.runAllBenchmarks() to run them.
+ *
  */
 #ifndef QUADRATIC_EQUATION_TESTLIB_H
 #define QUADRATIC_EQUATION_TESTLIB_H
@@ -18,12 +24,18 @@
 #include <vector>
 #include <cmath>
 #include <functional>
+#include <mutex>
 
 /**
  * Pointer to a function created by TEST(group, name) macro.
  */
 using TestPtr = std::function<void()>;
 
+/**
+ * Pointer to a function created by BENCH(group, name) macro.
+ */
+using BenchmarkPtr = std::function<void()>;
+
 /**
  * Represents a runnable test with all the info about it (file and line where it was described).
  *
@@ -62,6 +74,71 @@ public:
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Represents a runnable micro-benchmark with all the info about it (group, name, file and line where it was described).
+ *
+ * @note Benchmarks are created by BENCH(group, name) macro.
+ *       This class is used only for internal representation in TestRunner.
+ *
+ * @see BENCH(group, name)
+ * @see TestRunner
+ */
+class Benchmark {
+private:
+    const char* _group;
+    const char* _name;
+    const char* _fileName;
+    unsigned int _line;
+    BenchmarkPtr _function_ptr;
+
+public:
+    Benchmark(const BenchmarkPtr& function_ptr, const char* group, const char* name, const char* fileName, unsigned int line);
+
+    /**
+     * Runs one operation of this benchmark.
+     */
+    void run() const;
+
+    /**
+     * Group of this benchmark.
+     * @return group name.
+     */
+    const char* group() const;
+
+    /**
+     * Name of this benchmark.
+     * @return benchmark name.
+     */
+    const char* name() const;
+
+    /**
+     * Name of the file this benchmark was created in.
+     * @return name of the file.
+     */
+    const char* fileName() const;
+
+    /**
+     * Line of the file this benchmark was created on.
+     * @return line number of the file.
+     */
+    unsigned int line() const;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/** Default number of operations that are run before benchmark measurements. **/
+#ifndef TESTLIB_BENCH_WARMUP_ITERATIONS
+#define TESTLIB_BENCH_WARMUP_ITERATIONS 3
+#endif
+/** Default number of operations in one benchmark sample. **/
+#ifndef TESTLIB_BENCH_ITERATIONS
+#define TESTLIB_BENCH_ITERATIONS 10
+#endif
+/** Default number of measured benchmark samples. **/
+#ifndef TESTLIB_BENCH_SAMPLES
+#define TESTLIB_BENCH_SAMPLES 10
+#endif
+
 /**
  * Represents a test runner - container for tests that is able to manage (run and stop) them.
  *
@@ -74,19 +151,31 @@ public:
 class TestRunner {
 private:
 
-    /** Pointer to a current running test **/
-    Test* _currentTest = nullptr;
-
     /** Container for all tests. **/
     std::vector<Test*> allTests;
 
+    /** Container for all benchmarks. **/
+    std::vector<Benchmark*> allBenchmarks;
+
+    /** Mutex that guards std::cerr when tests are run in parallel. **/
+    std::mutex _outputMutex;
+
     /**
-     * Run the given test.
+     * Run the given test. Prints the test result and its duration.
      * @param[in] test pointer to a test to run
      * @return true, if the test succeeded, false otherwise.
      */
     bool runTest(Test* test);
 
+    /**
+     * Runs the given benchmark and prints mean time per operation and its standard deviation.
+     * @param[in] benchmark         pointer to a benchmark to run
+     * @param[in] warmupIterations  number of operations that are run before measurements
+     * @param[in] iterations        number of operations in one sample
+     * @param[in] samples           number of measured samples
+     */
+    void runBenchmark(Benchmark* benchmark, unsigned int warmupIterations, unsigned int iterations, unsigned int samples);
+
 public:
     TestRunner();
 
@@ -103,27 +192,59 @@ public:
     Test* addTest(TestPtr testPtr, const char* fileName, unsigned int line);
 
     /**
-     * Removes all tests from the container.
+     * Registers new benchmark in this runner.
+     * @param[in] benchmarkPtr pointer to a benchmark function
+     * @param[in] group        group of the benchmark
+     * @param[in] name         name of the benchmark
+     * @param[in] fileName     name of the file benchmark declared in
+     * @param[in] line         line number of the file benchmark declared on
+     * @return pointer to a created Benchmark object.
+     */
+    Benchmark* addBenchmark(BenchmarkPtr benchmarkPtr, const char* group, const char* name, const char* fileName, unsigned int line);
+
+    /**
+     * Removes all tests and benchmarks from the container.
      */
     void clear();
 
     /**
      * Runs all tests that exist in this runner. Use in the main() method to run every written test.
+     * If threadsNumber is greater than 1, tests are distributed between a pool of threads.
+     * @param[in] threadsNumber number of threads to run tests on
      * @return true, if all tests succeeded, false otherwise.
      */
-    bool runAllTests();
+    bool runAllTests(unsigned int threadsNumber = 1);
 
     /**
-     * Fails current test. Use in assertions to show that the current test is failed.
+     * Runs all benchmarks that exist in this runner one by one.
+     * Each benchmark is warmed up first, then it's measured in a few samples of fixed number of operations.
+     * @param[in] warmupIterations number of operations that are run before measurements
+     * @param[in] iterations       number of operations in one sample
+     * @param[in] samples          number of measured samples
+     */
+    void runAllBenchmarks(
+            unsigned int warmupIterations = TESTLIB_BENCH_WARMUP_ITERATIONS,
+            unsigned int iterations = TESTLIB_BENCH_ITERATIONS,
+            unsigned int samples = TESTLIB_BENCH_SAMPLES
+    );
+
+    /**
+     * Fails current test of the calling thread. Use in assertions to show that the current test is failed.
      */
     void failCurrentTest();
 
     /**
-     * Pointer to a current test executed by this runner.
+     * Pointer to a current test executed by this runner on the calling thread.
      * @return pointer to a current running test
      */
     const Test* currentTest() const;
 
+    /**
+     * Mutex that should be locked while printing something to std::cerr from tests.
+     * @return output mutex.
+     */
+    std::mutex& outputMutex();
+
     /**
      * Returns a singleton instance of the runner.
      * @return singleton runner.
@@ -157,6 +278,36 @@ public:
         TestRunner::getInstance()->addTest(&TEST_NAME(group, name), __FILE__, __LINE__);                               \
     void TEST_NAME(group, name)()
 
+/** Name that is given to a benchmark function created by BENCH(group, name) macro. **/
+#define BENCH_NAME(group, name) group##_##name##_bench
+/** Name that is given to a global variable that contains pointer to a Benchmark object created by BENCH(group, name) macro. **/
+#define BENCH_INFO(group, name) group##_##name##_benchinfo
+
+/**
+ * Creates a micro-benchmark with a given group and name and registers it in a TestRunner.
+ * Body of the benchmark is one measured operation - it is invoked many times, so it should not depend on previous runs.
+ * Benchmarks created by this macro are launched by TestRunner.runAllBenchmarks().
+ *
+ * @see benchDoNotOptimize(value)
+ */
+#define BENCH(group, name)                                                                                             \
+    static_assert(sizeof(#group) > 1, "benchmark group must not be empty");                                            \
+    static_assert(sizeof(#name)  > 1, "benchmark name must not be empty" );                                            \
+                                                                                                                       \
+    void BENCH_NAME(group, name)();                                                                                    \
+    const Benchmark* BENCH_INFO(group, name) =                                                                         \
+        TestRunner::getInstance()->addBenchmark(&BENCH_NAME(group, name), #group, #name, __FILE__, __LINE__);          \
+    void BENCH_NAME(group, name)()
+
+/**
+ * Prevents compiler from optimizing out the computation of the given value in benchmarks.
+ * @param[in] value value to keep
+ */
+template <typename T>
+inline void benchDoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 #define TESTLIB_ANSI_COLOR_RED   "\x1b[31m"
@@ -173,6 +324,7 @@ public:
 #define TESTLIB_ASSERT_FAILED(onFailure) do {                                                                          \
     TestRunner* runner = TestRunner::getInstance();                                                                    \
     const Test* currentTest = runner->currentTest();                                                                   \
+    std::lock_guard<std::mutex> outputLock(runner->outputMutex());                                                     \
     std::cerr << TESTLIB_ANSI_COLOR_RED;                                                                               \
     std::cerr << "[ASSERTION FAILED] " << currentTest->fileName() << ':' << currentTest->line() << '\n';               \
     onFailure;                                                                                                         \
@@ -3,6 +3,7 @@
  */
 #include <vector>
 #include <cstring>
+#include <string>
 #include "testlib.h"
 #include "../src/text_helpers.h"
 
@@ -299,3 +300,51 @@ TEST(splitLines, sampleTextWithEmptyLines_emptyLinesRemovedExpected) {
         ASSERT_EQUALS(strcmp(result[i].lineStart, expectedLines[i]), 0);
     }
 }
+
+TEST(countNewlines, newlinesCounted) {
+    const char* text = "abc\n\n de\nf";
+
+    ASSERT_EQUALS(countNewlines(text, strlen(text)), 3);
+    ASSERT_EQUALS(countNewlines(text, 4), 1);
+    ASSERT_EQUALS(countNewlines(text, 0), 0);
+}
+
+TEST(splitLinesReadOnly, sampleTextWithEmptyLines_textIsNotModified) {
+    const char text[] = "abaca \n daba, jaba \n  \n ,,123%!%,, \n haba \n\n--\n";
+    char buffer[sizeof(text)];
+    memcpy(buffer, text, sizeof(text));
+
+    std::vector<std::string> expectedLines = {
+            "abaca ",
+            " daba, jaba ",
+            " haba ",
+    };
+
+    std::vector<Line> result;
+    splitLinesReadOnly(buffer, strlen(buffer), result);
+
+    ASSERT_EQUALS(memcmp(buffer, text, sizeof(text)), 0);
+    ASSERT_EQUALS(result.size(), expectedLines.size());
+    for (size_t i = 0; i < result.size(); ++i) {
+        ASSERT_TRUE(std::string(result[i].lineStart, result[i].lineEnd + 1) == expectedLines[i]);
+    }
+}
+
+TEST(seekAlphaReverse, byteBeforeLineStartIsNotChecked) {
+    const char* text = "Я";
+    const char* lineStart = text + 1; // Low byte of the russian letter
+    const char* strPtr = lineStart;
+
+    ASSERT_EQUALS(seekAlphaReverse(strPtr, lineStart), 0);
+    ASSERT_TRUE(strPtr < lineStart);
+}
+
+TEST(getAlphaCode, codesAreOrderedAsLetters) {
+    ASSERT_EQUALS(getAlphaCode("a", 1), 1);
+    ASSERT_EQUALS(getAlphaCode("Z", 1), 26);
+    ASSERT_EQUALS(getAlphaCode("А", 2), 27);
+    ASSERT_EQUALS(getAlphaCode("ё", 2), getAlphaCode("Ё", 2));
+    ASSERT_TRUE(getAlphaCode("е", 2) < getAlphaCode("ё", 2));
+    ASSERT_TRUE(getAlphaCode("ё", 2) < getAlphaCode("ж", 2));
+    ASSERT_EQUALS(getAlphaCode("я", 2), 59);
+}
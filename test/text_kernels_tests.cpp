@@ -0,0 +1,233 @@
+/**
+ * @file
+ */
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "testlib.h"
+#include "../src/text_helpers.h"
+#include "../src/text_kernels.h"
+
+/**
+ * Generates the text of random pieces: english and russian letters, UTF-8 bytes that are not letters,
+ * punctuation and '\\n' symbols.
+ * @param[in] size size of the text in bytes
+ * @param[in] seed seed of the generator
+ * @return generated text.
+ */
+static std::string generateKernelsText(size_t size, unsigned int seed) {
+    static const char* const PIECES[] = {
+            "a", "Z", "q", "@", "[", "`", "{", " ", ",", "\n", "\n\n", "\xD0\x81", "\xD0\x90", "\xD0\xBF", "\xD1\x80",
+            "\xD1\x8F", "\xD1\x91", "\xD0\x80", "\xD0\x8F", "\xD1\x90", "\xD1\x92", "\xD1\xC0", "\xD0", "\xD1", "\xBF",
+            "\xE2\x80\x94", "\x7F", "\xFF",
+    };
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<size_t> pieceDistribution(0, sizeof(PIECES) / sizeof(PIECES[0]) - 1);
+
+    std::string text;
+    while (text.size() < size) {
+        text += PIECES[pieceDistribution(generator)];
+    }
+    text.resize(size);
+    return text;
+}
+
+/**
+ * Generates the valid UTF-8 text of random pieces: ASCII symbols and 2-, 3- and 4-byte sequences,
+ * including the ones at the bounds of the valid ranges.
+ * @param[in] size minimal size of the text in bytes
+ * @param[in] seed seed of the generator
+ * @return generated text.
+ */
+static std::string generateUtf8Text(size_t size, unsigned int seed) {
+    static const char* const PIECES[] = {
+            "a", " ", "\n", "\x7F", "\xC2\x80", "\xD0\x90", "\xDF\xBF", "\xE0\xA0\x80", "\xE2\x80\x94",
+            "\xED\x9F\xBF", "\xEE\x80\x80", "\xEF\xBF\xBF", "\xF0\x90\x80\x80", "\xF0\x9F\x98\x80", "\xF4\x8F\xBF\xBF",
+    };
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<size_t> pieceDistribution(0, sizeof(PIECES) / sizeof(PIECES[0]) - 1);
+
+    std::string text;
+    while (text.size() < size) {
+        text += PIECES[pieceDistribution(generator)];
+    }
+    return text;
+}
+
+/**
+ * Checks that kernels of the instruction set give the same results as the scalar kernels
+ * on every range of the text that starts in its first 64 bytes.
+ * @param[in] isa  instruction set to check
+ * @param[in] text text to check on
+ * @return true, if all results match, false otherwise.
+ */
+static bool kernelsMatchScalar(Isa isa, const std::string& text) {
+    const TextKernels& scalar = getIsaKernels(Isa::SCALAR);
+    const TextKernels& kernels = getIsaKernels(isa);
+    // Text is copied, so reading after its end is noticed by sanitizers
+    std::vector<char> buffer(text.begin(), text.end());
+    for (size_t offset = 0; offset < 64 && offset <= buffer.size(); ++offset) {
+        for (size_t size = 0; offset + size <= buffer.size(); ++size) {
+            const char* ptr = buffer.data() + offset;
+            if (kernels.countNewlines(ptr, size) != scalar.countNewlines(ptr, size)
+                || kernels.findNewline(ptr, size) != scalar.findNewline(ptr, size)
+                || kernels.findLetter(ptr, size, DEFAULT_COLLATION_TABLE)
+                   != scalar.findLetter(ptr, size, DEFAULT_COLLATION_TABLE)
+                || kernels.findInvalidUtf8(ptr, size) != scalar.findInvalidUtf8(ptr, size)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(parseIsa, namesParsedBack) {
+    for (Isa isa : { Isa::SCALAR, Isa::SSE2, Isa::AVX2, Isa::AVX512 }) {
+        Isa parsedIsa = Isa::SCALAR;
+        ASSERT_TRUE(parseIsa(getIsaName(isa), parsedIsa));
+        ASSERT_TRUE(parsedIsa == isa);
+    }
+
+    Isa isa = Isa::SCALAR;
+    ASSERT_TRUE(!parseIsa("", isa));
+    ASSERT_TRUE(!parseIsa("AVX2", isa));
+    ASSERT_TRUE(!parseIsa("neon", isa));
+}
+
+TEST(scalarKernels, resultsExpected) {
+    const TextKernels& kernels = getIsaKernels(Isa::SCALAR);
+    std::string text = "Ab, ёж!\n\n\xE2\x80\x94 \xD0";
+
+    ASSERT_TRUE(isIsaSupported(Isa::SCALAR));
+    ASSERT_EQUALS(kernels.countNewlines(text.data(), text.size()), 2);
+    ASSERT_EQUALS(kernels.findNewline(text.data(), text.size()), 9);
+    ASSERT_EQUALS(kernels.findNewline(text.data(), 9), 9);
+    ASSERT_EQUALS(kernels.findLetter(text.data(), text.size(), DEFAULT_COLLATION_TABLE), 0);
+    ASSERT_EQUALS(kernels.findLetter(text.data() + 2, text.size() - 2, DEFAULT_COLLATION_TABLE), 2);
+    // Lead byte at the end of the range is not a letter
+    ASSERT_EQUALS(kernels.findLetter(text.data() + 2, 3, DEFAULT_COLLATION_TABLE), 3);
+    ASSERT_EQUALS(kernels.findLetter(text.data() + 9, text.size() - 9, DEFAULT_COLLATION_TABLE), text.size() - 9);
+}
+
+TEST(scalarKernels, invalidUtf8Found) {
+    const TextKernels& kernels = getIsaKernels(Isa::SCALAR);
+    std::string valid = generateUtf8Text(200, 5);
+
+    ASSERT_EQUALS(kernels.findInvalidUtf8(valid.data(), valid.size()), valid.size());
+    for (const char* invalid : {
+            "\x80", "\xBF", "\xC0\xAF", "\xC1\xBF", "\xD0", "\xD0\xC0", "\xE0\x9F\xBF", "\xE2\x80", "\xED\xA0\x80",
+            "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xFF",
+    }) {
+        std::string text = "ab" + std::string(invalid) + "a";
+        ASSERT_EQUALS(kernels.findInvalidUtf8(text.data(), text.size()), 2);
+    }
+    // Sequence cut by the text end is invalid
+    ASSERT_EQUALS(kernels.findInvalidUtf8("a\xF0\x9F\x98\x80", 4), 1);
+}
+
+TEST(textKernels, allIsasMatchScalar) {
+    ASSERT_TRUE(isIsaSupported(getDetectedIsa()));
+
+    std::vector<std::string> texts = {
+            generateKernelsText(300, 1),
+            generateKernelsText(300, 2),
+            std::string(200, 'a'),
+            std::string(200, '\n'),
+            std::string(200, '\xD0'),
+            std::string(130, '.') + "\xD0\x90",
+    };
+    for (Isa isa : { Isa::SSE2, Isa::AVX2, Isa::AVX512 }) {
+        if (!isIsaSupported(isa)) continue;
+        for (const std::string& text : texts) {
+            ASSERT_TRUE(kernelsMatchScalar(isa, text));
+        }
+    }
+}
+
+TEST(textKernels, allIsasFindSameInvalidUtf8) {
+    static const char* const INVALID_PIECES[] = { "\xBF", "\xD0" "a", "\xE0\x80\x80", "\xED\xBF\xBF", "\xF4\x90\x80\x80" };
+    std::string valid = generateUtf8Text(300, 6);
+    std::vector<std::string> texts = { valid };
+    // Invalid sequences are put at the block bounds of all variants
+    for (const char* invalid : INVALID_PIECES) {
+        for (size_t position : { 0, 14, 15, 31, 32, 62, 63, 64, 127, 200 }) {
+            texts.push_back(valid.substr(0, position) + invalid + valid.substr(position));
+        }
+    }
+
+    const TextKernels& scalar = getIsaKernels(Isa::SCALAR);
+    for (Isa isa : { Isa::SSE2, Isa::AVX2, Isa::AVX512 }) {
+        if (!isIsaSupported(isa)) continue;
+        const TextKernels& kernels = getIsaKernels(isa);
+        bool sameResults = true;
+        for (const std::string& text : texts) {
+            std::vector<char> buffer(text.begin(), text.end());
+            for (size_t offset = 0; offset < 4; ++offset) {
+                for (size_t size = 0; offset + size <= buffer.size(); ++size) {
+                    const char* ptr = buffer.data() + offset;
+                    sameResults = sameResults && kernels.findInvalidUtf8(ptr, size) == scalar.findInvalidUtf8(ptr, size);
+                }
+            }
+        }
+        ASSERT_TRUE(sameResults);
+    }
+}
+
+TEST(forceIsa, splitLinesSameForAllIsas) {
+    std::string text = generateKernelsText(4096, 3);
+    std::string scalarText = text;
+    ASSERT_TRUE(forceIsa(Isa::SCALAR));
+    ASSERT_TRUE(getTextKernels().isa == Isa::SCALAR);
+    std::vector<Line> scalarLines = splitLines(scalarText.data(), scalarText.size());
+
+    for (Isa isa : { Isa::SSE2, Isa::AVX2, Isa::AVX512 }) {
+        if (!forceIsa(isa)) {
+            ASSERT_TRUE(!isIsaSupported(isa));
+            continue;
+        }
+        std::string isaText = text;
+        std::vector<Line> lines = splitLines(isaText.data(), isaText.size());
+        ASSERT_TRUE(isaText == scalarText);
+        ASSERT_EQUALS(lines.size(), scalarLines.size());
+        for (size_t i = 0; i < lines.size(); ++i) {
+            ASSERT_EQUALS(lines[i].lineStart - isaText.data(), scalarLines[i].lineStart - scalarText.data());
+            ASSERT_EQUALS(lines[i].lineEnd - isaText.data(), scalarLines[i].lineEnd - scalarText.data());
+        }
+    }
+    ASSERT_TRUE(forceIsa(getDetectedIsa()));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Splits a 4 MB text by lines with the kernels of the given instruction set (or the scalar ones, if it's not supported).
+ * @param[in] isa instruction set
+ */
+static void splitBenchmarkText(Isa isa) {
+    static const std::string benchmarkText = generateKernelsText(4 * 1024 * 1024, 4);
+
+    std::string text = benchmarkText;
+    forceIsa(isIsaSupported(isa) ? isa : Isa::SCALAR);
+    std::vector<Line> lines = splitLines(text.data(), text.size());
+    forceIsa(getDetectedIsa());
+    benchDoNotOptimize(lines.data());
+}
+
+BENCH(splitLines, 4MB_scalar) {
+    splitBenchmarkText(Isa::SCALAR);
+}
+
+BENCH(splitLines, 4MB_sse2) {
+    splitBenchmarkText(Isa::SSE2);
+}
+
+BENCH(splitLines, 4MB_avx2) {
+    splitBenchmarkText(Isa::AVX2);
+}
+
+BENCH(splitLines, 4MB_avx512) {
+    splitBenchmarkText(Isa::AVX512);
+}
@@ -0,0 +1,104 @@
+/**
+ * @file
+ */
+#include <string>
+#include "testlib.h"
+#include "../src/text_kernels.h"
+#include "../src/text_normalization.h"
+
+/**
+ * Normalizes the copy of the text.
+ * @param[in]  text  text to normalize
+ * @param[out] stats statistics of the normalization
+ * @return normalized text.
+ */
+static std::string normalizeCopy(const std::string& text, NormalizationStats& stats) {
+    std::string copy = text;
+    copy.resize(normalizeText(copy.data(), copy.size(), stats));
+    return copy;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TEST(normalizeText, validTextUnchanged) {
+    std::string text = "Мой дядя самых честных правил,\nWhen not in jest — “he” said\n\xF0\x9F\x98\x80\n";
+    NormalizationStats stats;
+
+    ASSERT_TRUE(normalizeCopy(text, stats) == text);
+    ASSERT_EQUALS(stats.invalidBytes, 0);
+    ASSERT_EQUALS(stats.crlfLineEndings, 0);
+    ASSERT_TRUE(normalizeCopy("", stats).empty());
+}
+
+TEST(normalizeText, crlfLineEndingsDropped) {
+    NormalizationStats stats;
+    std::string normalized = normalizeCopy("abc\r\n\r\nдом\r\r\na\rb\r", stats);
+
+    // Only '\r' before '\n' is a line ending, other '\r' symbols are kept
+    ASSERT_TRUE(normalized == "abc\n\nдом\r\na\rb\r");
+    ASSERT_EQUALS(stats.crlfLineEndings, 3);
+    ASSERT_EQUALS(stats.invalidBytes, 0);
+}
+
+TEST(normalizeText, invalidBytesReplaced) {
+    NormalizationStats stats;
+    std::string normalized = normalizeCopy("ok\r\nд\xD0\r\n\xE2\x80z\xBF\xC0\xAF\xED\xA0\x80\xF0\x9F\x98", stats);
+
+    ASSERT_TRUE(normalized == "ok\nд?\n??z?????????");
+    ASSERT_EQUALS(stats.invalidBytes, 12);
+    ASSERT_EQUALS(stats.firstInvalidOffset, 6);
+    ASSERT_EQUALS(stats.crlfLineEndings, 2);
+}
+
+TEST(normalizeText, sameForAllIsas) {
+    std::string text;
+    for (int i = 0; i < 50; ++i) {
+        text += "Строка\r\n" + std::string(i, 'x') + "\xD0\xE2\x82\xAC\xF0\x9F\x98\x80\r\xED\xBF\xBF\n";
+    }
+    NormalizationStats scalarStats;
+    ASSERT_TRUE(forceIsa(Isa::SCALAR));
+    std::string scalarNormalized = normalizeCopy(text, scalarStats);
+
+    for (Isa isa : { Isa::SSE2, Isa::AVX2, Isa::AVX512 }) {
+        if (!forceIsa(isa)) continue;
+        NormalizationStats stats;
+        bool sameText = normalizeCopy(text, stats) == scalarNormalized;
+        ASSERT_TRUE(forceIsa(getDetectedIsa()));
+        ASSERT_TRUE(sameText);
+        ASSERT_EQUALS(stats.invalidBytes, scalarStats.invalidBytes);
+        ASSERT_EQUALS(stats.firstInvalidOffset, scalarStats.firstInvalidOffset);
+        ASSERT_EQUALS(stats.crlfLineEndings, scalarStats.crlfLineEndings);
+    }
+    ASSERT_TRUE(forceIsa(getDetectedIsa()));
+    ASSERT_EQUALS(scalarStats.invalidBytes, 50 * 4);
+    ASSERT_EQUALS(scalarStats.crlfLineEndings, 50);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Normalizes a clean 4 MB text of russian and english lines with CRLF line endings.
+ */
+static void normalizeBenchmarkText() {
+    static const std::string benchmarkText = [] {
+        std::string text;
+        while (text.size() < 4 * 1024 * 1024) {
+            text += "Мой дядя самых честных правил,\r\nWhen not in jest he said\r\n";
+        }
+        return text;
+    }();
+
+    std::string text = benchmarkText;
+    NormalizationStats stats;
+    benchDoNotOptimize(normalizeText(text.data(), text.size(), stats));
+}
+
+BENCH(normalizeText, 4MB_scalar) {
+    forceIsa(Isa::SCALAR);
+    normalizeBenchmarkText();
+    forceIsa(getDetectedIsa());
+}
+
+BENCH(normalizeText, 4MB_detected) {
+    normalizeBenchmarkText();
+}